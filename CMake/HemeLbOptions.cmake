@@ -33,6 +33,7 @@ pass_option(HEMELB HEMELB_USE_SSE3 "Use SSE3 intrinsics" ${_default_sse3_flag})
 pass_option(HEMELB HEMELB_USE_VELOCITY_WEIGHTS_FILE "Use Velocity weights file" OFF)
 
 pass_option(HEMELB HEMELB_SEPARATE_CONCERNS "Communicate for each concern separately" OFF)
+pass_option(HEMELB HEMELB_USE_HDF5 "Build the HDF5 extraction output format (needs parallel HDF5)" OFF)
 
 if (HEMELB_BUILD_RBC)
   set(_default_kernel GuoForcingLBGK)
@@ -56,7 +57,7 @@ pass_cachevar_choice(HEMELB HEMELB_LATTICE ${_default_lattice}
   D3Q15 D3Q19 D3Q27 D3Q15i)
 pass_cachevar_choice(HEMELB HEMELB_KERNEL ${_default_kernel}
   STRING "Select the kernel to use"
-  LBGK EntropicAnsumali EntropicChik MRT TRT NNCY NNCYMOUSE NNC NNTPL GuoForcingLBGK)
+  LBGK EntropicAnsumali EntropicChik EntropicSeries MRT TRT NNCY NNCYMOUSE NNC NNTPL GuoForcingLBGK Regularised GuoForcingRegularised)
 pass_cachevar_choice(HEMELB HEMELB_WALL_BOUNDARY "SIMPLEBOUNCEBACK"
   STRING "Select the boundary conditions to be used at the walls"
   BFL GZS SIMPLEBOUNCEBACK JUNKYANG)
@@ -28,7 +28,7 @@
 namespace hemelb
 {
     namespace configuration { class SimBuilder; }
-    namespace extraction { class PropertyActor; }
+    namespace extraction { class PropertyActor; class ProbeActor; class CheckpointWriter; }
 
     template<class TRAITS = Traits<>>
   class SimulationMaster
@@ -126,6 +126,8 @@ namespace hemelb
 
       std::shared_ptr<extraction::IterableDataSource> propertyDataSource;
       std::shared_ptr<extraction::PropertyActor> propertyExtractor;
+      std::shared_ptr<extraction::ProbeActor> probeActor;
+      std::shared_ptr<extraction::CheckpointWriter> checkpointWriter;
 
       std::shared_ptr<net::phased::StepManager> stepManager;
       std::shared_ptr<net::phased::NetConcern> netConcern;
@@ -14,6 +14,7 @@
 
 #include "configuration/SimConfig.h"
 #include "configuration/SimBuilder.h"
+#include "extraction/ProbeActor.h"
 #include "extraction/PropertyActor.h"
 #include "extraction/LbDataSourceIterator.h"
 #include "io/writers/XdrFileWriter.h"
@@ -233,10 +234,23 @@ namespace hemelb
       propertyCache.velocityCache.SetRefreshFlag();
     }
 
-    // If extracting property results, check what's required by them.
-    if (propertyExtractor)
+    // If extracting property results, check what's required by
+    // them. With temporal blocking some sites compute the values for
+    // the next synchronisation step already, so ask for those too.
+    auto const timestep = simulationState->GetTimeStep();
+    auto const syncStep = latticeBoltzmannModel->GetNextSyncTimeStep(timestep);
+    for (auto step: {timestep, syncStep})
     {
-      propertyExtractor->SetRequiredProperties(propertyCache);
+      if (propertyExtractor)
+      {
+        propertyExtractor->SetRequiredProperties(propertyCache, step);
+      }
+      if (probeActor)
+      {
+        probeActor->SetRequiredProperties(propertyCache, step);
+      }
+      if (syncStep == timestep)
+        break;
     }
   }
 
@@ -50,6 +50,7 @@ namespace hemelb::configuration {
         auto&& i = config.sim_info;
         lb::LbmParameters ans(i.time.step_s, i.space.step_m, i.fluid.density_kgm3, i.fluid.viscosity_Pas);
         ans.StressType = i.stress_type;
+        ans.ViscosityTableTolerance = i.fluid.viscosity_table_tolerance;
         return ans;
     }
 
@@ -7,7 +7,9 @@
 #define HEMELB_CONFIGURATION_SIMBUILDER_H
 
 #include "configuration/SimConfig.h"
+#include "extraction/CheckpointWriter.h"
 #include "extraction/LbDataSourceIterator.h"
+#include "extraction/ProbeActor.h"
 #include "extraction/PropertyActor.h"
 #include "geometry/GmyReadResult.h"
 #include "geometry/neighbouring/NeighbouringDataManager.h"
@@ -230,6 +232,10 @@ namespace hemelb::configuration {
 
         lbm->Initialise(control.inletValues.get(),
                         control.outletValues.get());
+        if (auto const depth = config.GetTemporalBlockingDepth(); depth > 1) {
+            log::Logger::Log<log::Info, log::Singleton>("Temporal blocking %u time steps at a time.", depth);
+            lbm->SetTemporalBlocking(depth);
+        }
         auto ic = BuildInitialCondition();
         lbm->SetInitialConditions(ic, ioComms);
         ndm->ShareNeeds();
@@ -251,6 +257,35 @@ namespace hemelb::configuration {
         );
         maybe_register_actor(control.propertyExtractor, 1);
 
+        if (!config.GetProbes().empty()) {
+            // Probe files go in the extraction dir too
+            auto probes = config.GetProbes();
+            for (auto& p: probes) {
+                p.filename = control.fileManager->GetDataExtractionPath() / p.filename;
+            }
+            control.probeActor = std::make_shared<extraction::ProbeActor>(
+                    *control.simulationState,
+                    probes,
+                    *control.propertyDataSource,
+                    timings,
+                    ioComms
+            );
+            maybe_register_actor(control.probeActor, 1);
+        }
+
+        if (auto const& cp = config.GetNativeCheckpoint()) {
+            control.checkpointWriter = std::make_shared<extraction::CheckpointWriter>(
+                    *control.fieldData,
+                    *control.simulationState,
+                    control.fileManager->GetDataExtractionPath() / cp->filename,
+                    cp->period,
+                    cp->base_interval,
+                    timings,
+                    ioComms
+            );
+            maybe_register_actor(control.checkpointWriter, 1);
+        }
+
         control.netConcern = std::make_shared<net::phased::NetConcern>(
                 control.communicationNet
         );
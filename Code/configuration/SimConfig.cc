@@ -3,6 +3,8 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 
+#include <cmath>
+#include <random>
 #include <string>
 
 #include "configuration/SimConfig.h"
@@ -99,6 +101,34 @@ namespace hemelb::configuration
 	      throw Exception() << "Input XML has redbloodcells section but HEMELB_BUILD_RBC=OFF";
 #endif
       }
+
+      if (GetTemporalBlockingDepth() > 1)
+        CheckTemporalBlocking();
+    }
+
+    void SimConfig::CheckTemporalBlocking() const
+    {
+      auto const depth = GetTemporalBlockingDepth();
+      auto check_period = [&](LatticeTimeStep period, std::string_view what) {
+        if (period % depth)
+          throw Exception() << "With temporal blocking of depth " << depth << ", the " << what
+                            << " period (" << period << ") must be a multiple of it";
+      };
+      for (auto const& output: propertyOutputs)
+      {
+        check_period(output.frequency, "property output");
+        for (auto const& field: output.fields)
+          if (!std::holds_alternative<extraction::statistic::None>(field.statistic))
+            throw Exception() << "Temporal blocking cannot be used with field statistics";
+      }
+      for (auto const& probe: probes)
+        check_period(probe.frequency, "probe");
+      if (nativeCheckpoint)
+        check_period(nativeCheckpoint->period, "checkpoint");
+      if (monitoringConfig.doConvergenceCheck || monitoringConfig.doIncompressibilityCheck)
+        throw Exception() << "Temporal blocking cannot be used with convergence or incompressibility checks";
+      if (hasColloidSection || HasRBCSection())
+        throw Exception() << "Temporal blocking cannot be used with colloids or red blood cells";
     }
 
     void SimConfig::DoIOForSimulation(const io::xml::Element simEl)
@@ -138,6 +168,16 @@ namespace hemelb::configuration
             sim_info.time.warmup_steps = 0;
         }
 
+        // Optional element
+        // <temporal_blocking depth="unsigned" />
+        if (auto tbEl = simEl.GetChildOrNull("temporal_blocking"))
+        {
+            auto const depth = tbEl.GetAttributeOrThrow<unsigned>("depth");
+            if (depth < 1 || depth > 255)
+                throw Exception() << "Temporal blocking depth must be from 1 to 255, not " << depth;
+            sim_info.time.temporal_blocking_depth = depth;
+        }
+
         // Required element
         // <voxel_size value="float" units="m" />
         const io::xml::Element vsEl = simEl.GetChildOrThrow("voxel_size");
@@ -162,6 +202,16 @@ namespace hemelb::configuration
                     return GetDimensionalValue<PhysicalDynamicViscosity>(el, "Pa.s");
                 }).value_or(DEFAULT_FLUID_VISCOSITY_Pas);
 
+        // Optional element
+        // <viscosity_table tolerance="float" />
+        if (auto vtEl = simEl.GetChildOrNull("viscosity_table"))
+        {
+            auto const tolerance = vtEl.GetAttributeOrThrow<double>("tolerance");
+            if (!(tolerance > 0 && tolerance < 1))
+                throw Exception() << "Viscosity table tolerance must be between 0 and 1, not " << tolerance;
+            sim_info.fluid.viscosity_table_tolerance = tolerance;
+        }
+
         // Optional element (default = 0)
         // <reference_pressure value="float" units="mmHg" />
         sim_info.fluid.reference_pressure_mmHg = simEl.GetChildOrNull("reference_pressure").transform(
@@ -301,7 +351,28 @@ namespace hemelb::configuration
         propertyOutputs.push_back(DoIOForPropertyOutputFile(*poPtr));
       }
 
+      for (io::xml::ChildIterator probePtr = propertiesEl.IterChildren("probe");
+          !probePtr.AtEnd(); ++probePtr)
+      {
+        probes.push_back(DoIOForProbeFile(*probePtr));
+      }
+
       if (auto cpEl = propertiesEl.GetChildOrNull("checkpoint")) {
+	auto const format = cpEl.GetAttributeMaybe("format").value_or("xtr");
+	if (format == "native") {
+	  // Raw distributions, written asynchronously by a
+	  // CheckpointWriter rather than an extractor.
+	  auto& cp = nativeCheckpoint.emplace();
+	  cp.filename = cpEl.GetAttributeOrThrow("file");
+	  cpEl.GetAttributeOrThrow("period", cp.period);
+	  cp.base_interval = cpEl.GetAttributeMaybe<unsigned>("base_interval").value_or(cp.base_interval);
+	  if (cp.base_interval == 0)
+	    throw Exception() << "Checkpoint base_interval must be positive in " << cpEl.GetPath();
+	  return;
+	}
+	if (format != "xtr")
+	  throw Exception() << "Invalid checkpoint format '" << format << "' in " << cpEl.GetPath();
+
 	// Create a checkpoint property extractor.
 	//
 	// This is just a normal one, but fixed to be whole geometry,
@@ -359,39 +430,171 @@ namespace hemelb::configuration
 
       propertyoutputEl.GetAttributeOrThrow("period", file.frequency);
 
-      io::xml::Element geometryEl = propertyoutputEl.GetChildOrThrow("geometry");
+      auto&& compression = propertyoutputEl.GetAttributeMaybe("compression").value_or("none");
+      if (compression == "none") {
+	file.compression = extraction::no_compression{};
+      } else if (compression == "lossless") {
+	file.compression = extraction::lossless_compression{};
+      } else if (compression == "lossy") {
+	auto& lossy = file.compression.emplace<extraction::lossy_compression>();
+	propertyoutputEl.GetAttributeOrThrow("tolerance", lossy.tolerance);
+	if (!(lossy.tolerance > 0.0))
+	  throw Exception() << "Lossy compression needs a positive tolerance at: " << propertyoutputEl.GetPath();
+      } else {
+	throw Exception()
+	  << "Invalid value of compression attribute '" << compression
+	  << "' at: " << propertyoutputEl.GetPath();
+      }
+      file.queue_depth = propertyoutputEl.GetAttributeMaybe<unsigned>("queue_depth").value_or(file.queue_depth);
+
+      auto&& format = propertyoutputEl.GetAttributeMaybe("format").value_or("xtr");
+      if (format == "xtr") {
+	file.format = extraction::xtr_format{};
+      } else if (format == "hdf5") {
+	auto& hdf5 = file.format.emplace<extraction::hdf5_format>();
+	hdf5.chunk_sites = propertyoutputEl.GetAttributeMaybe<unsigned>("chunk_sites").value_or(hdf5.chunk_sites);
+	hdf5.deflate = propertyoutputEl.GetAttributeMaybe<unsigned>("deflate").value_or(hdf5.deflate);
+	if (hdf5.deflate > 9)
+	  throw Exception() << "Deflate level must be from 0 to 9 at: " << propertyoutputEl.GetPath();
+	// HDF5 has its own compression filters
+	if (!std::holds_alternative<extraction::no_compression>(file.compression))
+	  throw Exception() << "HDF5 output is compressed with the deflate attribute, not compression, at: "
+			    << propertyoutputEl.GetPath();
+#ifndef HEMELB_USE_HDF5
+	throw Exception() << "HDF5 output needs HemeLB built with HEMELB_USE_HDF5 at: "
+			  << propertyoutputEl.GetPath();
+#endif
+      } else {
+	throw Exception()
+	  << "Invalid value of format attribute '" << format
+	  << "' at: " << propertyoutputEl.GetPath();
+      }
+
+      auto&& grid = propertyoutputEl.GetAttributeMaybe("grid").value_or("full");
+      if (grid == "full") {
+	file.grid = extraction::full_grid{};
+      } else if (grid == "subsample" || grid == "box") {
+	unsigned factor;
+	propertyoutputEl.GetAttributeOrThrow("factor", factor);
+	if (factor == 0)
+	  throw Exception() << "Grid factor must be positive at: " << propertyoutputEl.GetPath();
+	if (grid == "subsample")
+	  file.grid = extraction::subsampled_grid{factor};
+	else
+	  file.grid = extraction::box_filtered_grid{factor};
+      } else {
+	throw Exception()
+	  << "Invalid value of grid attribute '" << grid
+	  << "' at: " << propertyoutputEl.GetPath();
+      }
+
+      file.geometry.reset(DoIOForGeometrySelector(propertyoutputEl.GetChildOrThrow("geometry")));
+
+      for (io::xml::ChildIterator fieldPtr = propertyoutputEl.IterChildren("field");
+          !fieldPtr.AtEnd(); ++fieldPtr)
+        file.fields.push_back(DoIOForPropertyField(*fieldPtr));
+
+      return file;
+    }
+
+    extraction::GeometrySelector* SimConfig::DoIOForGeometrySelector(
+        const io::xml::Element& geometryEl)
+    {
       auto type = geometryEl.GetAttributeOrThrow("type");
 
       if (type == "plane")
       {
-        file.geometry.reset(DoIOForPlaneGeometry(geometryEl));
+        return DoIOForPlaneGeometry(geometryEl);
       }
       else if (type == "line")
       {
-        file.geometry.reset(DoIOForLineGeometry(geometryEl));
+        return DoIOForLineGeometry(geometryEl);
       }
       else if (type == "whole")
       {
-        file.geometry.reset(new extraction::WholeGeometrySelector());
+        return new extraction::WholeGeometrySelector();
       }
       else if (type == "surface")
       {
-        file.geometry.reset(new extraction::GeometrySurfaceSelector());
+        return new extraction::GeometrySurfaceSelector();
       }
       else if (type == "surfacepoint")
       {
-        file.geometry.reset(DoIOForSurfacePoint(geometryEl));
+        return DoIOForSurfacePoint(geometryEl);
       }
       else
       {
         throw Exception() << "Unrecognised property output geometry selector '" << type
             << "' in element " << geometryEl.GetPath();
       }
+    }
 
-      for (io::xml::ChildIterator fieldPtr = propertyoutputEl.IterChildren("field");
-          !fieldPtr.AtEnd(); ++fieldPtr)
-        file.fields.push_back(DoIOForPropertyField(*fieldPtr));
+    extraction::ProbeFile SimConfig::DoIOForProbeFile(const io::xml::Element& probeEl)
+    {
+      auto file = extraction::ProbeFile{};
+      file.filename = probeEl.GetAttributeOrThrow("file");
+      probeEl.GetAttributeOrThrow("period", file.frequency);
+      if (file.frequency == 0)
+        throw Exception() << "Probe period must be positive at: " << probeEl.GetPath();
 
+      for (io::xml::ChildIterator qPtr = probeEl.IterChildren("quantity"); !qPtr.AtEnd(); ++qPtr)
+      {
+        auto const& quantityEl = *qPtr;
+        auto& quantity = file.quantities.emplace_back();
+        // Reuse the field parsing for the source
+        auto const field = DoIOForPropertyField(quantityEl);
+        quantity.name = field.name;
+        quantity.src = field.src;
+        if (std::holds_alternative<extraction::source::StressTensor>(quantity.src)
+            || std::holds_alternative<extraction::source::Distributions>(quantity.src)
+            || std::holds_alternative<extraction::source::MpiRank>(quantity.src))
+          throw Exception() << "Probes can only reduce scalar and vector fields at: "
+              << quantityEl.GetPath();
+
+        auto geometryEl = quantityEl.GetChildOrThrow("geometry");
+        quantity.geometry.reset(DoIOForGeometrySelector(geometryEl));
+
+        auto const reduction = quantityEl.GetAttributeOrThrow("reduction");
+        if (reduction == "sum")
+        {
+          quantity.reduction = extraction::reduction::Sum{};
+        }
+        else if (reduction == "mean")
+        {
+          quantity.reduction = extraction::reduction::Mean{};
+        }
+        else if (reduction == "integral")
+        {
+          quantity.reduction = extraction::reduction::Integral{};
+        }
+        else if (reduction == "flux")
+        {
+          if (!std::holds_alternative<extraction::source::Velocity>(quantity.src))
+            throw Exception() << "Probe fluxes need type=\"velocity\" at: " << quantityEl.GetPath();
+          quantity.reduction = extraction::reduction::Flux{};
+        }
+        else if (reduction == "difference")
+        {
+          // Mean over the first geometry minus mean over the second
+          auto& diff = quantity.reduction.emplace<extraction::reduction::Difference>();
+          diff.other.reset(DoIOForGeometrySelector(geometryEl.NextSiblingOrThrow("geometry")));
+        }
+        else
+        {
+          throw Exception() << "Invalid probe reduction '" << reduction << "' in "
+              << quantityEl.GetPath();
+        }
+
+        if (std::holds_alternative<extraction::reduction::Integral>(quantity.reduction)
+            || std::holds_alternative<extraction::reduction::Flux>(quantity.reduction))
+        {
+          if (!dynamic_cast<extraction::PlaneGeometrySelector*>(quantity.geometry.get()))
+            throw Exception() << "Probe reduction '" << reduction << "' needs a plane geometry at: "
+                << quantityEl.GetPath();
+        }
+      }
+      if (file.quantities.empty())
+        throw Exception() << "Probe has no quantities at: " << probeEl.GetPath();
       return file;
     }
 
@@ -505,6 +708,68 @@ namespace hemelb::configuration
       {
         throw Exception() << "Unrecognised field type '" << type << "' in " << fieldEl.GetPath();
       }
+
+      // Optionally, a statistic accumulated over time instead of the current value
+      auto const statistic = fieldEl.GetAttributeMaybe("statistic").value_or("none");
+      if (statistic == "none")
+      {
+        field.statistic = extraction::statistic::None{};
+      }
+      else if (statistic == "mean")
+      {
+        field.statistic = extraction::statistic::Mean{};
+      }
+      else if (statistic == "variance")
+      {
+        field.statistic = extraction::statistic::Variance{};
+      }
+      else if (statistic == "min")
+      {
+        field.statistic = extraction::statistic::Minimum{};
+      }
+      else if (statistic == "max")
+      {
+        field.statistic = extraction::statistic::Maximum{};
+      }
+      else if (statistic == "osi")
+      {
+        if (!std::holds_alternative<extraction::source::Traction>(field.src)
+            && !std::holds_alternative<extraction::source::TangentialProjectionTraction>(field.src))
+          throw Exception() << "Oscillatory shear index needs a traction field in " << fieldEl.GetPath();
+        field.statistic = extraction::statistic::Osi{};
+      }
+      else if (statistic == "phase")
+      {
+        // <field type=".." statistic="phase" phases="int">
+        //   <period value="float" units="s" />
+        // </field>
+        auto const period_s = GetDimensionalValue<PhysicalTime>(fieldEl.GetChildOrThrow("period"), "s");
+        auto const period = static_cast<LatticeTimeStep>(std::round(period_s / sim_info.time.step_s));
+        unsigned phases;
+        fieldEl.GetAttributeOrThrow("phases", phases);
+        if (period == 0 || phases == 0 || phases > period)
+          throw Exception() << "Invalid period or number of phases in " << fieldEl.GetPath();
+        field.statistic = extraction::statistic::PhaseMean{period, phases};
+      }
+      else
+      {
+        throw Exception() << "Unrecognised statistic '" << statistic << "' in " << fieldEl.GetPath();
+      }
+
+      if (!std::holds_alternative<extraction::statistic::None>(field.statistic))
+      {
+        if (std::holds_alternative<extraction::source::Distributions>(field.src)
+            || std::holds_alternative<extraction::source::MpiRank>(field.src))
+          throw Exception() << "Cannot accumulate statistics of field type '" << type << "' in "
+                            << fieldEl.GetPath();
+        // Variances and indices are unchanged by an offset
+        if (std::holds_alternative<extraction::statistic::Variance>(field.statistic)
+            || std::holds_alternative<extraction::statistic::Osi>(field.statistic))
+        {
+          field.noffsets = 0;
+          field.offset = {};
+        }
+      }
       return field;
     }
 
@@ -610,6 +875,28 @@ namespace hemelb::configuration
                                                                             0e0);
             ioletConf.cell_inserters.push_back(inserterConf);
         }
+
+        // Optional element <seedcells template="name">
+        //   <haematocrit value="float" units="dimensionless" />
+        //   Optional: <separation value="float" units="m" />
+        //   Optional: <seed value="int" />
+        if (auto seedEl = ioletEl.GetChildOrNull("seedcells")) {
+            if (!ioletConf.flow_extension)
+                throw Exception() << "Cells can only be seeded into a flow extension: " << seedEl.GetPath();
+            CellSeedingConfig seedConf;
+            seedConf.template_name = seedEl.GetAttributeOrThrow("template");
+            seedConf.haematocrit = GetDimensionalValue<Dimensionless>(
+                    seedEl.GetChildOrThrow("haematocrit"), "dimensionless");
+            if (seedConf.haematocrit <= 0 || seedConf.haematocrit >= 1)
+                throw Exception() << "Seeding haematocrit must be in (0, 1): " << seedConf.haematocrit;
+            seedConf.separation_m = GetDimensionalValueWithDefault<PhysicalDistance>(
+                    seedEl, "separation", "m", 0e0);
+            // All processes must seed the same cells, hence a default seed rather than a random one
+            seedConf.seed = seedEl.GetChildOrNull("seed").transform(
+                    [](io::xml::Element const& _) { return _.GetAttributeOrThrow<std::int64_t>("value"); }
+            ).value_or(std::default_random_engine::default_seed);
+            ioletConf.cell_seeding = seedConf;
+        }
     }
 
     template <typename T, typename F>
@@ -929,10 +1216,31 @@ namespace hemelb::configuration
             throw Exception() << "Box-size < cell-cell interaction size: "
                                  "cell-cell interactions cannot be all accounted for.";
 
+        // Optional element (default = stencil chosen at build time)
+        // <stencil value="FourPoint" far="TwoPoint" />
+        if (auto stencilEl = rbcEl.GetChildOrNull("stencil")) {
+            ans.stencil = std::string(stencilEl.GetAttributeOrThrow("value"));
+            if (auto far = stencilEl.GetAttributeMaybe("far"))
+                ans.far_stencil = std::string(*far);
+        }
+
+        auto const outputEl = rbcEl.GetChildOrThrow("output");
         ans.output_period = GetDimensionalValue<LatticeTimeStep>(
-                rbcEl.GetChildOrThrow("output").GetChildOrThrow("period"),
+                outputEl.GetChildOrThrow("period"),
                 "lattice"
         );
+        // Optional element (default = VTP)
+        // <format value="VTP|XDR" />
+        if (auto formatEl = outputEl.GetChildOrNull("format")) {
+            auto const fmt = formatEl.GetAttributeOrThrow("value");
+            if (fmt == "VTP") {
+                ans.output_format = VTPCellOutputFormat{};
+            } else if (fmt == "XDR") {
+                ans.output_format = XDRCellOutputFormat{};
+            } else {
+                throw Exception() << "Invalid cell output format '" << fmt << "'";
+            }
+        }
 
         return ans;
     }
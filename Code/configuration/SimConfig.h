@@ -15,6 +15,7 @@
 #include "lb/LbmParameters.h"
 #include "lb/iolets/InOutLets.h"
 #include "extraction/GeometrySelectors.h"
+#include "extraction/ProbeFile.h"
 #include "extraction/PropertyOutputFile.h"
 #include "io/xml.h"
 #include "quantity.h"
@@ -111,6 +112,8 @@ namespace hemelb::configuration
         std::uint64_t total_steps;
         std::uint64_t warmup_steps;
         PhysicalTime step_s;
+        // Time steps per temporal blocking cycle, 1 for none
+        unsigned temporal_blocking_depth = 1;
     };
 
     struct SpaceInfo {
@@ -122,6 +125,8 @@ namespace hemelb::configuration
         PhysicalDensity density_kgm3;
         PhysicalDynamicViscosity viscosity_Pas;
         PhysicalPressure reference_pressure_mmHg;
+        // Relative error in tau of tabulated rheology, 0 for none
+        double viscosity_table_tolerance = 0;
     };
 
     struct GlobalSimInfo {
@@ -154,12 +159,21 @@ namespace hemelb::configuration
         PhysicalDistance dy_m;
     };
 
+    //! Cells packed into the flow extension before the first step
+    struct CellSeedingConfig {
+        std::int64_t seed;
+        std::string template_name;
+        Dimensionless haematocrit;
+        PhysicalDistance separation_m;
+    };
+
     struct IoletConfigBase {
         PhysicalPosition position;
         util::Vector3D<double> normal;
         std::optional<std::uint64_t> warmup_steps;
         std::optional<FlowExtensionConfig> flow_extension;
         std::vector<CellInserterConfig> cell_inserters;
+        std::optional<CellSeedingConfig> cell_seeding;
     };
 
     // Consider removing
@@ -243,12 +257,32 @@ namespace hemelb::configuration
         std::size_t exponent;
     };
 
+    //! One VTK PolyData file per cell and output step
+    struct VTPCellOutputFormat {};
+    //! One collective XDR file per output step, see io/formats/cells.h
+    struct XDRCellOutputFormat {};
+    using CellOutputFormat = std::variant<VTPCellOutputFormat, XDRCellOutputFormat>;
+
+    //! Checkpoints written in the native format, see io/formats/checkpoint.h
+    struct NativeCheckpointConfig {
+        //! Data file pattern, relative to the extraction directory, with '%d' for the time step
+        std::filesystem::path filename;
+        LatticeTimeStep period;
+        //! Every this many checkpoints is a full one; those in between are deltas from it
+        unsigned base_interval = 1;
+    };
+
     struct RBCConfig {
         LatticeDistance boxSize;
         std::map<std::string, TemplateCellConfig> meshes;
         NodeForceConfig cell2cell;
         NodeForceConfig cell2wall;
         LatticeTimeStep output_period;
+        CellOutputFormat output_format;
+        //! IBM stencil, if not the one HemeLB was built with
+        std::optional<std::string> stencil;
+        //! Cheaper stencil for cells away from other cells and walls
+        std::optional<std::string> far_stencil;
     };
 
     class SimConfig
@@ -300,6 +334,10 @@ namespace hemelb::configuration
         {
           return sim_info.time.step_s;
         }
+        unsigned GetTemporalBlockingDepth() const
+        {
+          return sim_info.time.temporal_blocking_depth;
+        }
         PhysicalDistance GetVoxelSize() const
         {
           return sim_info.space.step_m;
@@ -320,6 +358,14 @@ namespace hemelb::configuration
         {
           return propertyOutputs;
         }
+        std::vector<extraction::ProbeFile> const& GetProbes() const
+        {
+          return probes;
+        }
+        std::optional<NativeCheckpointConfig> const& GetNativeCheckpoint() const
+        {
+          return nativeCheckpoint;
+        }
         path const& GetColloidConfigPath() const
         {
           return xmlFilePath;
@@ -407,6 +453,8 @@ namespace hemelb::configuration
             const io::xml::Element& propertyoutputEl);
         extraction::StraightLineGeometrySelector* DoIOForLineGeometry(
             const io::xml::Element& xmlNode);
+        extraction::GeometrySelector* DoIOForGeometrySelector(const io::xml::Element&);
+        extraction::ProbeFile DoIOForProbeFile(const io::xml::Element& probeEl);
         extraction::PlaneGeometrySelector* DoIOForPlaneGeometry(const io::xml::Element&);
         extraction::SurfacePointSelector* DoIOForSurfacePoint(const io::xml::Element&);
 
@@ -434,6 +482,13 @@ namespace hemelb::configuration
          */
         void DoIOForConvergenceCriterion(const io::xml::Element& criterionEl);
 
+        /**
+         * Checks that everything that reads the fields does so only at
+         * temporal blocking synchronisation steps, when all sites are
+         * at the same time.
+         */
+        void CheckTemporalBlocking() const;
+
         TemplateCellConfig readCell(const io::xml::Element& cellNode) const;
         std::map<std::string, TemplateCellConfig> readTemplateCells(io::xml::Element const& cellsEl) const;
         RBCConfig DoIOForRedBloodCells(const io::xml::Element& rbcEl) const;
@@ -443,6 +498,8 @@ namespace hemelb::configuration
         path dataFilePath;
 
         std::vector<extraction::PropertyOutputFile> propertyOutputs;
+        std::vector<extraction::ProbeFile> probes;
+        std::optional<NativeCheckpointConfig> nativeCheckpoint;
         /**
          * True if the file has a colloids section.
          */
@@ -0,0 +1,247 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "extraction/CheckpointWriter.h"
+
+#include <array>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#include "Exception.h"
+#include "geometry/FieldData.h"
+#include "io/formats/checkpoint.h"
+#include "lb/SimulationState.h"
+#include "log/Logger.h"
+#include "reporting/Timers.h"
+
+namespace hemelb::extraction
+{
+    namespace fmt = hemelb::io::formats;
+
+    namespace
+    {
+      // Appends the raw bytes of values to a buffer
+      template <typename... Ts>
+      void append(std::vector<char>& buffer, Ts... values) {
+	auto one = [&buffer](auto const& value) {
+	  auto const n = buffer.size();
+	  buffer.resize(n + sizeof(value));
+	  std::memcpy(buffer.data() + n, &value, sizeof(value));
+	};
+	(one(values), ...);
+      }
+
+      template <typename T>
+      void append(std::vector<char>& buffer, std::span<T const> values) {
+	auto const bytes = std::as_bytes(values);
+	auto const first = reinterpret_cast<char const*>(bytes.data());
+	buffer.insert(buffer.end(), first, first + bytes.size());
+      }
+
+      // Appends a file name, padded with zeros as the format says
+      void appendName(std::vector<char>& buffer, std::string const& name) {
+	buffer.insert(buffer.end(), name.begin(), name.end());
+	buffer.resize(buffer.size() + fmt::checkpoint::PaddedNameLength(name.size()) - name.size(), 0);
+      }
+    }
+
+    CheckpointWriter::CheckpointWriter(const geometry::FieldData& fieldData,
+				       const lb::SimulationState& simulationState,
+				       std::filesystem::path filePattern, LatticeTimeStep period,
+				       unsigned baseInterval,
+				       reporting::Timers& timers, const net::IOCommunicator& ioComms) :
+      fieldData(fieldData), simulationState(simulationState), filePattern(filePattern.native()),
+      period(period), baseInterval(baseInterval), timers(timers), comms(ioComms)
+    {
+      if (this->filePattern.find("%d") == std::string::npos)
+	throw Exception() << "Checkpoint file name must contain '%d': " << this->filePattern;
+      if (period == 0)
+	throw Exception() << "Checkpoint period must be positive";
+      if (baseInterval == 0)
+	throw Exception() << "Checkpoint base interval must be positive";
+    }
+
+    CheckpointWriter::~CheckpointWriter()
+    {
+      try
+      {
+	Flush();
+      }
+      catch (std::exception const& e)
+      {
+	log::Logger::Log<log::Error, log::OnePerCore>("Could not complete checkpoint: %s", e.what());
+      }
+    }
+
+    void CheckpointWriter::EndIteration()
+    {
+      auto const timestep = simulationState.GetTimeStep();
+      if (timestep % period != 0)
+	return;
+
+      timers[reporting::Timers::extractionWriting].Start();
+      Write(GetFilename(timestep), timestep);
+      timers[reporting::Timers::extractionWriting].Stop();
+    }
+
+    std::filesystem::path CheckpointWriter::GetFilename(LatticeTimeStep timestep) const
+    {
+      // Same zero padding as extraction files
+      int width = 3;
+      unsigned long next = 1000;
+      while (simulationState.GetTotalTimeSteps() > next) {
+	width += 1;
+	next *= 10;
+      }
+      std::ostringstream number;
+      number << std::setw(width) << std::setfill('0') << timestep;
+
+      auto result = filePattern;
+      result.replace(result.find("%d"), 2, number.str());
+      return result;
+    }
+
+    std::filesystem::path CheckpointWriter::GetIndexFilename() const
+    {
+      return fmt::checkpoint::PatternToIndex(filePattern);
+    }
+
+    void CheckpointWriter::WriteIndex()
+    {
+      auto const& domain = fieldData.GetDomain();
+      auto const nSites = domain.GetLocalFluidSiteCount();
+
+      std::vector<std::uint32_t> coords;
+      coords.reserve(3 * nSites);
+      for (site_t i = 0; i < nSites; ++i) {
+	auto const& position = fieldData.GetSite(i).GetGlobalSiteCoords();
+	coords.push_back(position.x());
+	coords.push_back(position.y());
+	coords.push_back(position.z());
+      }
+      auto const coordsSpan = std::span<std::uint32_t const>(coords);
+
+      // IO rank writes the header and block descriptions, followed by its own coordinates
+      std::array<std::uint64_t, 2> const block{std::uint64_t(nSites), fmt::checkpoint::Checksum(coordsSpan)};
+      auto const blocks = comms.Gather(block, comms.GetIORank());
+      std::vector<char> indexBuffer;
+      if (comms.OnIORank()) {
+	append(indexBuffer,
+	       std::uint32_t(fmt::HemeLbMagicNumber),
+	       std::uint32_t(fmt::checkpoint::IndexMagicNumber),
+	       std::uint32_t(fmt::checkpoint::VersionNumber),
+	       std::uint32_t(comms.Size()),
+	       std::uint64_t(domain.GetTotalFluidSites()));
+	auto const table = std::span<std::array<std::uint64_t, 2> const>(blocks);
+	append(indexBuffer, table);
+	indexChecksum = fmt::checkpoint::Checksum(table);
+      }
+      append(indexBuffer, coordsSpan);
+
+      std::uint64_t const size = indexBuffer.size();
+      auto const offset = comms.Scan(size, MPI_SUM) - size;
+      auto indexFile = net::MpiFile::Open(comms, GetIndexFilename(),
+					  MPI_MODE_WRONLY | MPI_MODE_CREATE | MPI_MODE_EXCL);
+      indexFile.WriteAtAll(offset, std::span<char const>(indexBuffer));
+      indexFile.Close();
+      indexWritten = true;
+    }
+
+    void CheckpointWriter::Write(const std::filesystem::path& filename, LatticeTimeStep timestep)
+    {
+      Flush();
+      if (!indexWritten)
+	WriteIndex();
+
+      auto const& domain = fieldData.GetDomain();
+      auto const numVectors = domain.GetLatticeInfo().GetNumVectors();
+      auto const nSites = domain.GetLocalFluidSiteCount();
+      auto const fs = std::span<distribn_t const>(fieldData.GetFOld(0), nSites * numVectors);
+
+      // Snapshot, so that the simulation can carry on while this is written
+      if (checkpointCount++ % baseInterval == 0) {
+	EncodeFull(timestep, fs);
+	if (baseInterval > 1) {
+	  base.assign(fs.begin(), fs.end());
+	  baseFilename = filename.filename();
+	  baseTimestep = timestep;
+	}
+      } else {
+	EncodeDelta(timestep, fs);
+      }
+
+      // Blocks follow each other in rank order, header first
+      std::uint64_t const size = buffer.size();
+      auto const offset = comms.Scan(size, MPI_SUM) - size;
+      file = net::MpiFile::Open(comms, filename, MPI_MODE_WRONLY | MPI_MODE_CREATE | MPI_MODE_EXCL);
+      request = file.IWriteAtAll(offset, std::span<char const>(buffer));
+    }
+
+    void CheckpointWriter::EncodeFull(LatticeTimeStep timestep, std::span<distribn_t const> fs)
+    {
+      auto const& domain = fieldData.GetDomain();
+      if (comms.OnIORank()) {
+	auto const indexName = GetIndexFilename().filename().native();
+	append(buffer,
+	       std::uint32_t(fmt::HemeLbMagicNumber),
+	       std::uint32_t(fmt::checkpoint::MagicNumber),
+	       std::uint32_t(fmt::checkpoint::VersionNumber),
+	       std::uint32_t(fmt::checkpoint::ByteOrderMark),
+	       std::uint64_t(timestep),
+	       std::uint64_t(domain.GetTotalFluidSites()),
+	       std::uint32_t(comms.Size()),
+	       std::uint32_t(domain.GetLatticeInfo().GetNumVectors()),
+	       indexChecksum,
+	       std::uint32_t(indexName.size()), std::uint32_t(0));
+	appendName(buffer, indexName);
+      }
+      append(buffer, fmt::checkpoint::Checksum(fs));
+      append(buffer, fs);
+    }
+
+    void CheckpointWriter::EncodeDelta(LatticeTimeStep timestep, std::span<distribn_t const> fs)
+    {
+      static_assert(std::is_same_v<distribn_t, double>, "Deltas are of 64-bit values");
+      auto const& domain = fieldData.GetDomain();
+      auto const encoded = fmt::checkpoint::EncodeDelta(fs, base);
+
+      // Blocks vary in length, so the IO rank writes a table of them
+      std::uint64_t const blockLength = sizeof(std::uint64_t) + encoded.size();
+      auto const blockLengths = comms.Gather(blockLength, comms.GetIORank());
+      if (comms.OnIORank()) {
+	auto const indexName = GetIndexFilename().filename().native();
+	auto const& baseName = baseFilename.native();
+	append(buffer,
+	       std::uint32_t(fmt::HemeLbMagicNumber),
+	       std::uint32_t(fmt::checkpoint::DeltaMagicNumber),
+	       std::uint32_t(fmt::checkpoint::VersionNumber),
+	       std::uint32_t(fmt::checkpoint::ByteOrderMark),
+	       std::uint64_t(timestep),
+	       std::uint64_t(domain.GetTotalFluidSites()),
+	       std::uint32_t(comms.Size()),
+	       std::uint32_t(domain.GetLatticeInfo().GetNumVectors()),
+	       indexChecksum,
+	       std::uint32_t(indexName.size()), std::uint32_t(0),
+	       std::uint64_t(baseTimestep),
+	       std::uint32_t(baseName.size()), std::uint32_t(0));
+	appendName(buffer, indexName);
+	appendName(buffer, baseName);
+	append(buffer, std::span<std::uint64_t const>(blockLengths));
+      }
+      append(buffer, fmt::checkpoint::Checksum(fs));
+      buffer.insert(buffer.end(), encoded.begin(), encoded.end());
+    }
+
+    void CheckpointWriter::Flush()
+    {
+      if (request != MPI_REQUEST_NULL)
+      {
+	net::MpiCall{MPI_Wait}(&request, MPI_STATUS_IGNORE);
+      }
+      file.Close();
+      buffer.clear();
+    }
+}
@@ -0,0 +1,120 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_EXTRACTION_CHECKPOINTWRITER_H
+#define HEMELB_EXTRACTION_CHECKPOINTWRITER_H
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "units.h"
+#include "net/IOCommunicator.h"
+#include "net/IteratedAction.h"
+#include "net/MpiFile.h"
+#include "reporting/timers_fwd.h"
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    class FieldData;
+  }
+  namespace lb
+  {
+    class SimulationState;
+  }
+}
+
+namespace hemelb::extraction
+{
+    /**
+     * Writes checkpoints in the native format described in
+     * io/formats/checkpoint.h.
+     *
+     * Site coordinates are written once, to the index file, the first
+     * time a checkpoint is written. Each checkpoint records the
+     * index's name, then copies the distributions, in FieldData
+     * order, into a snapshot buffer and starts a non-blocking
+     * collective write from it, so the LB loop
+     * carries on while MPI writes. The write completes at the start
+     * of the next checkpoint, on Flush, or when the writer is
+     * destroyed.
+     *
+     * With a base interval above one, only every base interval'th
+     * checkpoint is written in full. The writer keeps a copy of its
+     * distributions, and the checkpoints in between are written as
+     * delta files, holding the compressed difference from it.
+     */
+    class CheckpointWriter : public net::IteratedAction
+    {
+      public:
+        /**
+         * @param filePattern path of the data files, where '%d' is replaced by the time step
+         * @param period number of time steps between checkpoints
+         * @param baseInterval number of checkpoints from one full checkpoint to the next
+         */
+        CheckpointWriter(const geometry::FieldData& fieldData,
+                         const lb::SimulationState& simulationState,
+                         std::filesystem::path filePattern, LatticeTimeStep period,
+                         unsigned baseInterval,
+                         reporting::Timers& timers, const net::IOCommunicator& ioComms);
+        CheckpointWriter(const CheckpointWriter&) = delete;
+        CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+        //! Completes any pending write. Collective.
+        ~CheckpointWriter() override;
+
+        //! Writes a checkpoint if this is a checkpoint step.
+        void EndIteration() override;
+
+        //! Starts writing the current distributions to the given file,
+        //! in full or as a delta as the base interval says. Collective.
+        void Write(const std::filesystem::path& filename, LatticeTimeStep timestep);
+        //! Waits for the pending write, if any, and closes its file. Collective.
+        void Flush();
+
+        //! Data file for the given time step
+        std::filesystem::path GetFilename(LatticeTimeStep timestep) const;
+        //! Index file shared by all the checkpoints of this run
+        std::filesystem::path GetIndexFilename() const;
+
+      private:
+        //! Writes the site coordinates, blocking. Collective.
+        void WriteIndex();
+        //! Fills the buffer with a full checkpoint
+        void EncodeFull(LatticeTimeStep timestep, std::span<distribn_t const> fs);
+        //! Fills the buffer with a delta from the base. Collective.
+        void EncodeDelta(LatticeTimeStep timestep, std::span<distribn_t const> fs);
+
+        const geometry::FieldData& fieldData;
+        const lb::SimulationState& simulationState;
+        std::string filePattern;
+        LatticeTimeStep period;
+        unsigned baseInterval;
+        reporting::Timers& timers;
+        const net::IOCommunicator& comms;
+
+        //! Checksum of the index block descriptions, only known on the IO rank
+        std::uint64_t indexChecksum = 0;
+        bool indexWritten = false;
+
+        //! Number of checkpoints written so far
+        unsigned checkpointCount = 0;
+        //! The last full checkpoint, for deltas: its distributions,
+        //! file name and time step
+        std::vector<distribn_t> base;
+        std::filesystem::path baseFilename;
+        LatticeTimeStep baseTimestep = 0;
+
+        net::MpiFile file;
+        //! Snapshot being written. Must outlive the request.
+        std::vector<char> buffer;
+        MPI_Request request = MPI_REQUEST_NULL;
+    };
+}
+
+#endif // HEMELB_EXTRACTION_CHECKPOINTWRITER_H
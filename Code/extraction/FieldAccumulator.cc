@@ -0,0 +1,150 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "extraction/FieldAccumulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace hemelb::extraction
+{
+    unsigned GetStatisticLength(statistic::Type const& statistic, unsigned sampleLength)
+    {
+      return overload_visit(statistic,
+	[](statistic::Osi) { return 1U; },
+	[&](statistic::PhaseMean const& phase) { return phase.bins * sampleLength; },
+	[&](auto) { return sampleLength; }
+      );
+    }
+
+    FieldAccumulator::FieldAccumulator(statistic::Type statistic_, std::size_t nSites,
+				       unsigned sampleLength) :
+      statistic(statistic_), nSites(nSites), sampleLength(sampleLength)
+    {
+      stride = overload_visit(statistic,
+	[](statistic::None) -> unsigned {
+	  throw Exception() << "Cannot accumulate the current value";
+	},
+	[&](statistic::Variance) {
+	  // Mean and sum of squared differences from it
+	  return 2 * sampleLength;
+	},
+	[&](statistic::Osi) {
+	  // Sum of the vector and of its magnitude
+	  if (sampleLength != 3)
+	    throw Exception() << "Oscillatory shear index needs a vector field";
+	  return 4U;
+	},
+	[&](statistic::PhaseMean const& phase) {
+	  if (phase.period == 0 || phase.bins == 0)
+	    throw Exception() << "Phase averages need a positive period and number of phases";
+	  return sampleLength;
+	},
+	[&](auto) {
+	  return sampleLength;
+	}
+      );
+      auto const nBins = overload_visit(statistic,
+	[](statistic::PhaseMean const& phase) { return phase.bins; },
+	[](auto) { return 1U; }
+      );
+      data.resize(nBins * nSites * stride);
+      counts.resize(nBins);
+      Reset();
+    }
+
+    unsigned FieldAccumulator::GetLength() const
+    {
+      return GetStatisticLength(statistic, sampleLength);
+    }
+
+    void FieldAccumulator::StartStep(LatticeTimeStep timestep)
+    {
+      if (auto phase = std::get_if<statistic::PhaseMean>(&statistic))
+	bin = (timestep % phase->period) * phase->bins / phase->period;
+      ++counts[bin];
+    }
+
+    void FieldAccumulator::Add(std::size_t site, std::span<const double> sample)
+    {
+      auto const values = std::span<double>(data).subspan((bin * nSites + site) * stride, stride);
+      auto const n = double(counts[bin]);
+      overload_visit(statistic,
+	[](statistic::None) {
+	},
+	[&](statistic::Mean) {
+	  for (unsigned j = 0; j < sampleLength; ++j)
+	    values[j] += (sample[j] - values[j]) / n;
+	},
+	[&](statistic::Variance) {
+	  for (unsigned j = 0; j < sampleLength; ++j) {
+	    auto const delta = sample[j] - values[j];
+	    values[j] += delta / n;
+	    values[sampleLength + j] += delta * (sample[j] - values[j]);
+	  }
+	},
+	[&](statistic::Minimum) {
+	  for (unsigned j = 0; j < sampleLength; ++j)
+	    values[j] = std::min(values[j], sample[j]);
+	},
+	[&](statistic::Maximum) {
+	  for (unsigned j = 0; j < sampleLength; ++j)
+	    values[j] = std::max(values[j], sample[j]);
+	},
+	[&](statistic::Osi) {
+	  for (unsigned j = 0; j < 3; ++j)
+	    values[j] += sample[j];
+	  values[3] += std::hypot(sample[0], sample[1], sample[2]);
+	},
+	[&](statistic::PhaseMean const&) {
+	  for (unsigned j = 0; j < sampleLength; ++j)
+	    values[j] += (sample[j] - values[j]) / n;
+	}
+      );
+    }
+
+    void FieldAccumulator::Get(std::size_t site, std::span<double> result) const
+    {
+      auto const values = [&](unsigned b) {
+	return std::span<const double>(data).subspan((b * nSites + site) * stride, stride);
+      };
+      if (counts[0] == 0 && !std::holds_alternative<statistic::PhaseMean>(statistic)) {
+	std::fill(result.begin(), result.end(), 0.0);
+	return;
+      }
+      overload_visit(statistic,
+	[&](statistic::Variance) {
+	  // Population variance
+	  for (unsigned j = 0; j < sampleLength; ++j)
+	    result[j] = values(0)[sampleLength + j] / counts[0];
+	},
+	[&](statistic::Osi) {
+	  // 1/2 (1 - |mean of vector| / mean of magnitude)
+	  auto const v = values(0);
+	  result[0] = v[3] > 0.0 ? 0.5 * (1.0 - std::hypot(v[0], v[1], v[2]) / v[3]) : 0.0;
+	},
+	[&](statistic::PhaseMean const& phase) {
+	  for (unsigned b = 0; b < phase.bins; ++b)
+	    for (unsigned j = 0; j < sampleLength; ++j)
+	      result[b * sampleLength + j] = counts[b] ? values(b)[j] : 0.0;
+	},
+	[&](auto) {
+	  std::copy_n(values(0).begin(), sampleLength, result.begin());
+	}
+      );
+    }
+
+    void FieldAccumulator::Reset()
+    {
+      auto const initial = overload_visit(statistic,
+	[](statistic::Minimum) { return std::numeric_limits<double>::infinity(); },
+	[](statistic::Maximum) { return -std::numeric_limits<double>::infinity(); },
+	[](auto) { return 0.0; }
+      );
+      std::fill(data.begin(), data.end(), initial);
+      std::fill(counts.begin(), counts.end(), 0);
+    }
+}
@@ -0,0 +1,90 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_EXTRACTION_FIELDACCUMULATOR_H
+#define HEMELB_EXTRACTION_FIELDACCUMULATOR_H
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "extraction/OutputField.h"
+#include "units.h"
+
+namespace hemelb::extraction
+{
+    /**
+     * Number of values of a statistic at each site
+     * @param statistic
+     * @param sampleLength number of values of the source at each site
+     * @return
+     */
+    unsigned GetStatisticLength(statistic::Type const& statistic, unsigned sampleLength);
+
+    /**
+     * Accumulates a statistic over time of one output field, at each
+     * of a fixed set of sites.
+     *
+     * Each time step, call StartStep and then Add the current value
+     * of the field's source at every site. Means and variances are
+     * updated with Welford's algorithm, so long runs do not lose
+     * precision.
+     */
+    class FieldAccumulator
+    {
+      public:
+        /**
+         * @param statistic what to accumulate; must not be statistic::None
+         * @param nSites number of sites
+         * @param sampleLength number of values of the source at each site
+         */
+        FieldAccumulator(statistic::Type statistic, std::size_t nSites, unsigned sampleLength);
+
+        /**
+         * Number of values of the statistic at each site
+         * @return
+         */
+        unsigned GetLength() const;
+
+        /**
+         * Start a new time step, before adding its samples.
+         * @param timestep
+         */
+        void StartStep(LatticeTimeStep timestep);
+
+        /**
+         * Add the value of the source at a site for the current time step.
+         * @param site
+         * @param sample sampleLength values
+         */
+        void Add(std::size_t site, std::span<const double> sample);
+
+        /**
+         * Get the statistic at a site. Statistics of no samples are zero.
+         * @param site
+         * @param result GetLength() values
+         */
+        void Get(std::size_t site, std::span<double> result) const;
+
+        /**
+         * Forget all samples.
+         */
+        void Reset();
+
+      private:
+        statistic::Type statistic;
+        std::size_t nSites;
+        unsigned sampleLength;
+        // Number of values stored per site (per phase, for phase means)
+        unsigned stride;
+        std::vector<double> data;
+        // Number of time steps accumulated, per phase for phase means
+        std::vector<std::uint64_t> counts;
+        // Phase of the current time step
+        unsigned bin = 0;
+    };
+}
+
+#endif // HEMELB_EXTRACTION_FIELDACCUMULATOR_H
@@ -0,0 +1,242 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "extraction/Hdf5FieldWriter.h"
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <numeric>
+
+#include "Exception.h"
+#include "log/Logger.h"
+#include "net/IOCommunicator.h"
+
+#ifndef H5_HAVE_PARALLEL
+#error "HDF5 extraction output needs an HDF5 library built with parallel (MPI) support"
+#endif
+
+namespace hemelb::extraction
+{
+    namespace
+    {
+      // Throws if an HDF5 call failed, else passes its result on
+      template <typename T>
+      T check(T result, char const* what)
+      {
+	if (result < 0)
+	  throw Exception() << "HDF5 error: " << what;
+	return result;
+      }
+
+      hid_t FileType(code::Type const& typecode)
+      {
+	return overload_visit(typecode,
+	  [](float) { return H5T_NATIVE_FLOAT; },
+	  [](double) { return H5T_NATIVE_DOUBLE; },
+	  [](std::int32_t) { return H5T_NATIVE_INT32; },
+	  [](std::uint32_t) { return H5T_NATIVE_UINT32; },
+	  [](std::int64_t) { return H5T_NATIVE_INT64; },
+	  [](std::uint64_t) { return H5T_NATIVE_UINT64; }
+	);
+      }
+
+      // Writes a double or array of doubles attribute
+      void WriteAttribute(hid_t object, char const* name, std::span<const double> values)
+      {
+	hsize_t const n = values.size();
+	auto const space = check(H5Screate_simple(1, &n, nullptr), "create attribute space");
+	auto const attribute = check(H5Acreate2(object, name, H5T_NATIVE_DOUBLE, space, H5P_DEFAULT, H5P_DEFAULT),
+				     "create attribute");
+	check(H5Awrite(attribute, H5T_NATIVE_DOUBLE, values.data()), "write attribute");
+	H5Aclose(attribute);
+	H5Sclose(space);
+      }
+
+      // Writes a block of rows, starting at a row, to the dataset's
+      // last time step (or to the dataset itself, for rank 2 datasets
+      // without a time dimension). Collective.
+      void WriteRows(hid_t dataset, hid_t transfer, hid_t memType, void const* data,
+		     hsize_t time, std::uint64_t start, std::uint64_t count, bool timed)
+      {
+	auto const fileSpace = check(H5Dget_space(dataset), "get dataset space");
+	auto const rank = check(H5Sget_simple_extent_ndims(fileSpace), "get dataset rank");
+	std::array<hsize_t, 3> dims;
+	H5Sget_simple_extent_dims(fileSpace, dims.data(), nullptr);
+
+	// Select our rows, at the given time if there is one
+	std::array<hsize_t, 3> offset{0, 0, 0}, block = dims;
+	auto const siteDim = timed ? 1 : 0;
+	if (timed) {
+	  offset[0] = time;
+	  block[0] = 1;
+	}
+	offset[siteDim] = start;
+	block[siteDim] = count;
+
+	hsize_t const memSize = std::accumulate(block.begin(), block.begin() + rank, hsize_t{1},
+						 std::multiplies<hsize_t>{});
+	auto const memSpace = check(H5Screate_simple(1, &memSize, nullptr), "create memory space");
+	if (count == 0) {
+	  // Still take part in the collective write
+	  H5Sselect_none(fileSpace);
+	  H5Sselect_none(memSpace);
+	} else {
+	  check(H5Sselect_hyperslab(fileSpace, H5S_SELECT_SET, offset.data(), nullptr, block.data(), nullptr),
+		"select hyperslab");
+	}
+	check(H5Dwrite(dataset, memType, memSpace, fileSpace, transfer, data), "write dataset");
+	H5Sclose(memSpace);
+	H5Sclose(fileSpace);
+      }
+    }
+
+    Hdf5FieldWriter::Hdf5FieldWriter(const std::filesystem::path& filename,
+				     const std::vector<OutputField>& fields,
+				     const std::vector<unsigned>& fieldLengths,
+				     std::span<const util::Vector3D<std::uint32_t>> coords,
+				     PhysicalDistance voxelSize, const PhysicalPosition& origin,
+				     const hdf5_format& options, const net::IOCommunicator& comms) :
+      fieldLengths(fieldLengths), localSiteCount(coords.size()), onIORank(comms.OnIORank())
+    {
+      globalSiteCount = comms.AllReduce(localSiteCount, MPI_SUM);
+      siteStart = comms.Scan(localSiteCount, MPI_SUM) - localSiteCount;
+
+      auto const access = check(H5Pcreate(H5P_FILE_ACCESS), "create file access properties");
+      check(H5Pset_fapl_mpio(access, comms, MPI_INFO_NULL), "set MPI-IO driver");
+      // Like the XTR format, do not overwrite existing output
+      file = H5Fcreate(filename.c_str(), H5F_ACC_EXCL, H5P_DEFAULT, access);
+      H5Pclose(access);
+      if (file < 0)
+	throw Exception() << "Could not create HDF5 extraction file " << filename;
+
+      transfer = check(H5Pcreate(H5P_DATASET_XFER), "create transfer properties");
+      check(H5Pset_dxpl_mpio(transfer, H5FD_MPIO_COLLECTIVE), "set collective transfers");
+
+      std::array<double, 3> const originValues{origin.x(), origin.y(), origin.z()};
+      WriteAttribute(file, "voxel_size", std::span<const double>(&voxelSize, 1));
+      WriteAttribute(file, "origin", originValues);
+
+      // Coordinates, once
+      {
+	std::array<hsize_t, 2> const dims{globalSiteCount, 3};
+	auto const space = check(H5Screate_simple(2, dims.data(), nullptr), "create grid space");
+	auto const grid = check(H5Dcreate2(file, "grid", H5T_NATIVE_UINT32, space,
+					   H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT),
+				"create grid dataset");
+	std::vector<std::uint32_t> flat;
+	flat.reserve(3 * coords.size());
+	for (auto const& c: coords)
+	  flat.insert(flat.end(), {c.x(), c.y(), c.z()});
+	WriteRows(grid, transfer, H5T_NATIVE_UINT32, flat.data(), 0, siteStart, localSiteCount, false);
+	H5Dclose(grid);
+	H5Sclose(space);
+      }
+
+      // Time steps, one per record
+      {
+	hsize_t const dims = 0, maxDims = H5S_UNLIMITED, chunk = 1024;
+	auto const space = check(H5Screate_simple(1, &dims, &maxDims), "create time space");
+	auto const create = check(H5Pcreate(H5P_DATASET_CREATE), "create dataset properties");
+	check(H5Pset_chunk(create, 1, &chunk), "set time chunk");
+	timeDataset = check(H5Dcreate2(file, "time", H5T_NATIVE_UINT64, space,
+				       H5P_DEFAULT, create, H5P_DEFAULT),
+			    "create time dataset");
+	H5Pclose(create);
+	H5Sclose(space);
+      }
+
+      auto const group = check(H5Gcreate2(file, "fields", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT),
+			       "create fields group");
+      for (std::size_t i = 0; i < fields.size(); ++i)
+      {
+	auto const& field = fields[i];
+	auto const length = fieldLengths[i];
+	// Scalars have no component dimension
+	int const rank = length == 1 ? 2 : 3;
+	std::array<hsize_t, 3> const dims{0, globalSiteCount, length};
+	std::array<hsize_t, 3> const maxDims{H5S_UNLIMITED, globalSiteCount, length};
+
+	// Default to chunks of about a MiB
+	auto const valueSize = code::type_to_size(field.typecode);
+	hsize_t chunkSites = options.chunk_sites ? options.chunk_sites
+	  : std::max<hsize_t>(1, (1 << 20) / (valueSize * length));
+	chunkSites = std::clamp<hsize_t>(chunkSites, 1, std::max<hsize_t>(globalSiteCount, 1));
+	std::array<hsize_t, 3> const chunk{1, chunkSites, length};
+
+	auto const create = check(H5Pcreate(H5P_DATASET_CREATE), "create dataset properties");
+	check(H5Pset_chunk(create, rank, chunk.data()), "set field chunk");
+	if (options.deflate > 0)
+	{
+	  check(H5Pset_shuffle(create), "set shuffle filter");
+	  check(H5Pset_deflate(create, options.deflate), "set deflate filter");
+	}
+	auto const space = check(H5Screate_simple(rank, dims.data(), maxDims.data()), "create field space");
+	auto const dataset = check(H5Dcreate2(group, field.name.c_str(), FileType(field.typecode), space,
+					      H5P_DEFAULT, create, H5P_DEFAULT),
+				   "create field dataset");
+	if (field.noffsets)
+	  WriteAttribute(dataset, "offset", field.offset);
+	fieldDatasets.push_back(dataset);
+	H5Sclose(space);
+	H5Pclose(create);
+      }
+      H5Gclose(group);
+    }
+
+    Hdf5FieldWriter::~Hdf5FieldWriter()
+    {
+      for (auto const dataset: fieldDatasets)
+	H5Dclose(dataset);
+      if (timeDataset >= 0)
+	H5Dclose(timeDataset);
+      if (transfer >= 0)
+	H5Pclose(transfer);
+      if (file >= 0 && H5Fclose(file) < 0)
+	log::Logger::Log<log::Error, log::OnePerCore>("Could not close HDF5 extraction file");
+    }
+
+    void Hdf5FieldWriter::Write(LatticeTimeStep timestep, const std::vector<std::vector<double>>& values)
+    {
+      auto const time = timeCount++;
+      // Extending is collective, with the same size everywhere
+      auto extend = [&](hid_t dataset, std::uint64_t length) {
+	std::array<hsize_t, 3> const dims{timeCount, globalSiteCount, length};
+	check(H5Dset_extent(dataset, dims.data()), "extend dataset");
+      };
+
+      extend(timeDataset, 0);
+      {
+	// Only the IO rank writes the time step
+	std::uint64_t const step = timestep;
+	auto const fileSpace = check(H5Dget_space(timeDataset), "get time space");
+	hsize_t const one = 1;
+	auto const memSpace = check(H5Screate_simple(1, &one, nullptr), "create memory space");
+	if (onIORank)
+	  check(H5Sselect_hyperslab(fileSpace, H5S_SELECT_SET, &time, nullptr, &one, nullptr), "select time");
+	else
+	{
+	  H5Sselect_none(fileSpace);
+	  H5Sselect_none(memSpace);
+	}
+	check(H5Dwrite(timeDataset, H5T_NATIVE_UINT64, memSpace, fileSpace, transfer, &step), "write time");
+	H5Sclose(memSpace);
+	H5Sclose(fileSpace);
+      }
+
+      for (std::size_t i = 0; i < fieldDatasets.size(); ++i)
+      {
+	extend(fieldDatasets[i], fieldLengths[i]);
+	// HDF5 converts to the type of the dataset
+	WriteRows(fieldDatasets[i], transfer, H5T_NATIVE_DOUBLE, values[i].data(),
+		  time, siteStart, localSiteCount, true);
+      }
+    }
+
+    void Hdf5FieldWriter::Flush()
+    {
+      check(H5Fflush(file, H5F_SCOPE_GLOBAL), "flush file");
+    }
+}
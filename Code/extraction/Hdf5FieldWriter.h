@@ -0,0 +1,99 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_EXTRACTION_HDF5FIELDWRITER_H
+#define HEMELB_EXTRACTION_HDF5FIELDWRITER_H
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include <hdf5.h>
+
+#include "extraction/OutputField.h"
+#include "extraction/PropertyOutputFile.h"
+#include "units.h"
+#include "util/Vector3D.h"
+
+namespace hemelb::net
+{
+  class IOCommunicator;
+}
+
+namespace hemelb::extraction
+{
+    /**
+     * Writes extracted fields to an HDF5 file, with parallel HDF5.
+     *
+     * Layout:
+     * /                    attributes "voxel_size" (m) and "origin" (m, 3)
+     * /grid                uint32 (N, 3) site coordinates, written once
+     * /time                uint64 (T) time steps
+     * /fields/<name>       (T, N) or (T, N, L) values, typed as in the
+     *                      field's typecode, less the "offset" attribute
+     *                      as in the XTR format
+     *
+     * Sites are ordered by rank, then as selected on that rank, so
+     * each rank writes one contiguous hyperslab per dataset, with
+     * collective I/O. Field datasets grow along time and are chunked
+     * by a block of sites at a single time, so that reading a subset
+     * of the sites, or a single time, only touches the chunks needed.
+     */
+    class Hdf5FieldWriter
+    {
+      public:
+        /**
+         * Creates the file and writes the site coordinates. Collective.
+         * @param filename
+         * @param fields
+         * @param fieldLengths number of values of each field at each site
+         * @param coords coordinates of this rank's sites
+         * @param voxelSize
+         * @param origin
+         * @param options chunking and compression
+         * @param comms
+         */
+        Hdf5FieldWriter(const std::filesystem::path& filename,
+                        const std::vector<OutputField>& fields,
+                        const std::vector<unsigned>& fieldLengths,
+                        std::span<const util::Vector3D<std::uint32_t>> coords,
+                        PhysicalDistance voxelSize, const PhysicalPosition& origin,
+                        const hdf5_format& options, const net::IOCommunicator& comms);
+        Hdf5FieldWriter(const Hdf5FieldWriter&) = delete;
+        Hdf5FieldWriter& operator=(const Hdf5FieldWriter&) = delete;
+        //! Closes the file. Collective.
+        ~Hdf5FieldWriter();
+
+        /**
+         * Appends a time step. Collective.
+         * @param timestep
+         * @param values for each field, its values at this rank's sites,
+         * all the values at one site then the next
+         */
+        void Write(LatticeTimeStep timestep, const std::vector<std::vector<double>>& values);
+
+        //! Flushes what has been written to the file system. Collective.
+        void Flush();
+
+      private:
+        hid_t file = H5I_INVALID_HID;
+        // Collective transfers
+        hid_t transfer = H5I_INVALID_HID;
+        hid_t timeDataset = H5I_INVALID_HID;
+        std::vector<hid_t> fieldDatasets;
+        std::vector<unsigned> fieldLengths;
+
+        std::uint64_t localSiteCount;
+        std::uint64_t globalSiteCount;
+        // First site written by this rank
+        std::uint64_t siteStart;
+        bool onIORank;
+        // Number of time steps written so far
+        hsize_t timeCount = 0;
+    };
+}
+
+#endif // HEMELB_EXTRACTION_HDF5FIELDWRITER_H
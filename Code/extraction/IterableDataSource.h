@@ -100,6 +100,14 @@ namespace hemelb::extraction
          */
         virtual void Reset() = 0;
 
+        /**
+         * Moves straight to a site, given by its index in iteration
+         * order: the site that is current after Reset and index + 1
+         * calls to ReadNext.
+         * @param index
+         */
+        virtual void SetSite(site_t index) = 0;
+
         /**
          * Returns true iff the passed location is within the lattice.
          *
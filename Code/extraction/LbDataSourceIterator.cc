@@ -84,6 +84,11 @@ namespace hemelb::extraction
       position = -1;
     }
 
+    void LbDataSourceIterator::SetSite(site_t index)
+    {
+      position = index;
+    }
+
     bool LbDataSourceIterator::IsValidLatticeSite(const util::Vector3D<site_t>& location) const
     {
       return data.GetDomain().IsValidLatticeSite(location);
@@ -100,6 +100,12 @@ namespace hemelb::extraction
          */
         void Reset() override;
 
+        /**
+         * Moves straight to a site. The index is the local contiguous site id.
+         * @param index
+         */
+        void SetSite(site_t index) override;
+
         /**
          * Returns true iff the passed location is within the lattice.
          *
@@ -4,8 +4,12 @@
 // license in the file LICENSE.
 #include "extraction/LocalDistributionInput.h"
 
+#include <algorithm>
+#include <array>
+
 #include "extraction/OutputField.h"
 #include "geometry/FieldData.h"
+#include "io/formats/checkpoint.h"
 #include "io/formats/formats.h"
 #include "io/formats/extraction.h"
 #include "io/formats/offset.h"
@@ -20,13 +24,8 @@ namespace hemelb::extraction {
   LocalDistributionInput::LocalDistributionInput(std::filesystem::path dataFilePath,
 						 std::optional<std::filesystem::path> maybeOffsetPath,
 						 const net::IOCommunicator& ioComm) :
-    comms{ioComm}, filePath{std::move(dataFilePath)}
+    comms{ioComm}, filePath{std::move(dataFilePath)}, offsetPath{std::move(maybeOffsetPath)}
   {
-    if (maybeOffsetPath) {
-      offsetPath = std::move(*maybeOffsetPath);
-    } else {
-      offsetPath = fmt::offset::ExtractionToOffset(filePath);
-    }
   }
 
   namespace {
@@ -48,10 +47,14 @@ namespace hemelb::extraction {
       auto inputFile = net::MpiFile::Open(comms, filePath, MPI_MODE_RDONLY);
       // Set the view to the file.
       inputFile.SetView(0, MPI_CHAR, MPI_CHAR, "native");
+      if (IsNative(inputFile)) {
+	LoadNative(inputFile, latDat, targetTime);
+	return;
+      }
       ReadExtractionHeaders(inputFile, NUMVECTORS);
 
       // Now read offset file.
-      ReadOffsets(offsetPath);
+      ReadOffsets(offsetPath.value_or(fmt::offset::ExtractionToOffset(filePath)));
 
       // Figure out how many checkpoints are in the XTR file and
       // therefore the position to start at.
@@ -66,7 +69,7 @@ namespace hemelb::extraction {
       auto ReadTimeByIndex = [&](uint64_t iTS) {
 	uint64_t ans;
 	std::vector<char> tsbuf(8);
-	inputFile.ReadAt(localStart + iTS*allCoresWriteLength, to_span(tsbuf));
+	inputFile.ReadAt(recordStart + iTS*allCoresWriteLength, to_span(tsbuf));
 	io::XdrMemReader dataReader(tsbuf);
 	dataReader.read(ans);
 	return ans;
@@ -104,62 +107,266 @@ namespace hemelb::extraction {
 	targetTime = timestep;
 
       log::Logger::Log<log::Info, log::Singleton>("Reading checkpoint from timestep %d with index %d", timestep, iTS);
-      // Read the local part of the checkpoint
-      const auto readLength = localStop - localStart;
-      const auto timeStart = iTS * allCoresWriteLength;
 
-      std::vector<char> dataBuffer(readLength);
-      inputFile.ReadAt(timeStart + localStart, to_span(dataBuffer));
+      // A checkpoint is the timestep followed by fixed-length site
+      // records: the grid coordinate as 3 x 32 b unsigned, then the
+      // distributions. Which rank wrote which site does not matter,
+      // so the records are split evenly over the ranks of this run.
+      uint64_t const siteLength = 3 * sizeof(uint32_t) + NUMVECTORS * sizeof(distribn_t);
+      uint64_t const sitesLength = allCoresWriteLength - sizeof(uint64_t);
+      if (sitesLength % siteLength)
+	throw Exception() << "Checkpoint record length not consistent with integer number of sites";
+      uint64_t const nSites = sitesLength / siteLength;
+      if (nSites != uint64_t(dom.GetTotalFluidSites()))
+	throw Exception() << "Checkpoint has " << nSites << " sites but the geometry has "
+			  << dom.GetTotalFluidSites();
+
+      uint64_t const firstSite = nSites * comms.Rank() / comms.Size();
+      uint64_t const lastSite = nSites * (comms.Rank() + 1) / comms.Size();
+      std::vector<char> dataBuffer((lastSite - firstSite) * siteLength);
+      inputFile.ReadAt(recordStart + iTS * allCoresWriteLength + sizeof(uint64_t) + firstSite * siteLength,
+		       to_span(dataBuffer));
       io::XdrMemReader dataReader(dataBuffer);
 
-      // Read the timestep
+      std::vector<uint32_t> coords(3 * (lastSite - firstSite));
+      std::vector<distribn_t> fs((lastSite - firstSite) * NUMVECTORS);
+      for (auto i = 0U; i < lastSite - firstSite; ++i) {
+	// Stored as 32 b unsigned
+	dataReader.read(coords[3 * i]);
+	dataReader.read(coords[3 * i + 1]);
+	dataReader.read(coords[3 * i + 2]);
+	for (auto j = 0U; j < NUMVECTORS; j++) {
+	  dataReader.read(fs[i * NUMVECTORS + j]);
+	}
+      }
+      StoreSites(latDat, coords, fs);
+    }
+
+    bool LocalDistributionInput::IsNative(net::MpiFile& inputFile) const {
+      int native = 0;
       if (comms.OnIORank()) {
-	dataReader.read(timestep);
+	std::array<uint32_t, 2> magic{0, 0};
+	if (inputFile.GetSize() >= MPI_Offset(sizeof(magic)))
+	  inputFile.ReadAt(0, std::span<uint32_t>(magic));
+	native = magic[0] == fmt::HemeLbMagicNumber
+	  && (magic[1] == fmt::checkpoint::MagicNumber || magic[1] == fmt::checkpoint::DeltaMagicNumber);
       }
+      comms.Broadcast(native, comms.GetIORank());
+      return native;
+    }
 
-      site_t iSite = 0;
-      // while (dataReader.GetPosition() < readLength) {
-      for (; dataReader.GetPosition() < readLength; iSite++) {
-	// Read the grid coord and check it's consistent with latDat.
-	{
-	  // Stored as 32 b unsigned
-	  util::Vector3D<uint32_t> tmp;
-	  dataReader.read(tmp.x());
-	  dataReader.read(tmp.y());
-	  dataReader.read(tmp.z());
-
-	  // Convert to canonical type
-	  util::Vector3D<site_t> grid{tmp};
-	  // Look up the site ID and rank, as decomposed by this run
-	  // of HemeLB, for the grid coordinate read from the
-	  // checkpoint file.
-	  proc_t rank; site_t index;
-	  if (!dom.GetContiguousSiteId(grid, rank, index)) {
-	    // function returns a 'valid' flag
-	    throw Exception() << "Cannot get valid site from extracted site coordinate";
+    void LocalDistributionInput::LoadNative(net::MpiFile& inputFile, geometry::FieldData* latDat,
+					    std::optional<LatticeTimeStep>& targetTime) {
+      namespace cp = fmt::checkpoint;
+      auto&& dom = latDat->GetDomain();
+      const auto NUMVECTORS = dom.GetLatticeInfo().GetNumVectors();
+
+      // Headers are small, so every rank reads and checks them
+      // itself. Native values need no decoding.
+      struct Header {
+	uint32_t hlbMagic, magic, version, byteOrder;
+	uint64_t timestep, nSites;
+	uint32_t nBlocks, nVectors;
+	uint64_t indexChecksum;
+	uint32_t indexNameLength, reserved;
+      };
+      static_assert(sizeof(Header) == cp::HeaderLength);
+      auto readHeader = [&](net::MpiFile& file) {
+	Header header;
+	file.ReadAt(0, std::span<char>(reinterpret_cast<char*>(&header), sizeof(header)));
+	if (header.byteOrder != cp::ByteOrderMark)
+	  throw Exception() << "Checkpoint was written with a different byte order";
+	if (header.version != cp::VersionNumber)
+	  throw Exception() << "Version number incorrect."
+			    << " Supported: " << unsigned(cp::VersionNumber)
+			    << " Input: " << header.version;
+	if (header.nVectors != NUMVECTORS)
+	  throw Exception() << "Checkpoint contains " << header.nVectors
+			    << " distributions but this build of HemeLB requires " << NUMVECTORS;
+	if (header.nSites != uint64_t(dom.GetTotalFluidSites()))
+	  throw Exception() << "Checkpoint has " << header.nSites << " sites but the geometry has "
+			    << dom.GetTotalFluidSites();
+	return header;
+      };
+      auto const header = readHeader(inputFile);
+      if (targetTime && *targetTime != header.timestep)
+	throw Exception() << "Target timestep " << *targetTime << " not found in checkpoint file.";
+      timestep = header.timestep;
+      if (!targetTime)
+	targetTime = timestep;
+
+      // Unless given, the index is the one the checkpoint names
+      bool const delta = header.magic == cp::DeltaMagicNumber;
+      uint64_t const namesOffset = delta ? cp::DeltaHeaderLength : cp::HeaderLength;
+      std::string indexName(header.indexNameLength, '\0');
+      inputFile.ReadAt(namesOffset, std::span<char>(indexName));
+      auto indexFile = net::MpiFile::Open(comms, offsetPath.value_or(filePath.parent_path() / indexName),
+					  MPI_MODE_RDONLY);
+      indexFile.SetView(0, MPI_CHAR, MPI_CHAR, "native");
+      struct {
+	uint32_t hlbMagic, magic, version, nBlocks;
+	uint64_t nSites;
+      } indexHeader;
+      static_assert(sizeof(indexHeader) == cp::IndexHeaderLength);
+      indexFile.ReadAt(0, std::span<char>(reinterpret_cast<char*>(&indexHeader), sizeof(indexHeader)));
+      if (indexHeader.hlbMagic != fmt::HemeLbMagicNumber || indexHeader.magic != cp::IndexMagicNumber)
+	throw Exception() << "Checkpoint index does not have the index magic number";
+      if (indexHeader.nBlocks != header.nBlocks || indexHeader.nSites != header.nSites)
+	throw Exception() << "Checkpoint index does not match checkpoint";
+
+      if (header.nBlocks == 0)
+	throw Exception() << "Checkpoint index has no blocks";
+      std::vector<std::array<uint64_t, 2>> blocks(header.nBlocks);
+      indexFile.ReadAt(cp::IndexHeaderLength, std::span<uint64_t>(blocks.front().data(), 2 * blocks.size()));
+      if (cp::Checksum(std::span<std::array<uint64_t, 2> const>(blocks)) != header.indexChecksum)
+	throw Exception() << "Checkpoint index does not match checkpoint";
+
+      log::Logger::Log<log::Info, log::Singleton>("Reading native checkpoint from timestep %lu written by %u ranks",
+						  (unsigned long) timestep, header.nBlocks);
+
+      // A delta is read along with its base, from which its blocks
+      // are reconstructed. Its blocks vary in length, so it has a
+      // table of them. Blocks of distributions follow the data
+      // file's header and index name.
+      net::MpiFile baseFile;
+      std::vector<uint64_t> deltaLengths;
+      uint64_t deltaOffset = 0;
+      uint64_t dataOffset = cp::HeaderLength + cp::PaddedNameLength(header.indexNameLength);
+      if (delta) {
+	struct {
+	  uint64_t baseTimestep;
+	  uint32_t nameLength, reserved;
+	} deltaHeader;
+	static_assert(sizeof(Header) + sizeof(deltaHeader) == cp::DeltaHeaderLength);
+	inputFile.ReadAt(cp::HeaderLength, std::span<char>(reinterpret_cast<char*>(&deltaHeader),
+							   sizeof(deltaHeader)));
+	uint64_t const baseNameOffset = namesOffset + cp::PaddedNameLength(header.indexNameLength);
+	std::string baseName(deltaHeader.nameLength, '\0');
+	inputFile.ReadAt(baseNameOffset, std::span<char>(baseName));
+	uint64_t const tableOffset = baseNameOffset + cp::PaddedNameLength(deltaHeader.nameLength);
+	deltaLengths.resize(header.nBlocks);
+	inputFile.ReadAt(tableOffset, std::span<uint64_t>(deltaLengths));
+	deltaOffset = tableOffset + sizeof(uint64_t) * deltaLengths.size();
+
+	auto const basePath = filePath.parent_path() / baseName;
+	baseFile = net::MpiFile::Open(comms, basePath, MPI_MODE_RDONLY);
+	baseFile.SetView(0, MPI_CHAR, MPI_CHAR, "native");
+	auto const baseHeader = readHeader(baseFile);
+	if (baseHeader.hlbMagic != fmt::HemeLbMagicNumber || baseHeader.magic != cp::MagicNumber
+	    || baseHeader.timestep != deltaHeader.baseTimestep
+	    || baseHeader.indexChecksum != header.indexChecksum)
+	  throw Exception() << "Checkpoint base " << basePath << " does not match delta " << filePath;
+	log::Logger::Log<log::Info, log::Singleton>("Reconstructing checkpoint from base at timestep %lu",
+						    (unsigned long) baseHeader.timestep);
+	dataOffset = cp::HeaderLength + cp::PaddedNameLength(baseHeader.indexNameLength);
+      }
+
+      // Share the blocks out evenly, by number of blocks
+      uint64_t const firstBlock = uint64_t(header.nBlocks) * comms.Rank() / comms.Size();
+      uint64_t const lastBlock = uint64_t(header.nBlocks) * (comms.Rank() + 1) / comms.Size();
+      uint64_t coordsOffset = cp::IndexHeaderLength + cp::IndexBlockLength * uint64_t(header.nBlocks);
+      for (uint64_t b = 0; b < firstBlock; ++b) {
+	coordsOffset += 3 * sizeof(uint32_t) * blocks[b][0];
+	dataOffset += sizeof(uint64_t) + NUMVECTORS * sizeof(distribn_t) * blocks[b][0];
+	if (delta)
+	  deltaOffset += deltaLengths[b];
+      }
+
+      std::vector<uint32_t> coords;
+      std::vector<distribn_t> fs;
+      for (auto b = firstBlock; b < lastBlock; ++b) {
+	auto const [n, coordsChecksum] = blocks[b];
+	auto const blockCoords = coords.size();
+	auto const blockFs = fs.size();
+	coords.resize(blockCoords + 3 * n);
+	fs.resize(blockFs + NUMVECTORS * n);
+	uint64_t fsChecksum;
+	if (delta)
+	  inputFile.ReadAt(deltaOffset, std::span<uint64_t>(&fsChecksum, 1));
+	else
+	  inputFile.ReadAt(dataOffset, std::span<uint64_t>(&fsChecksum, 1));
+	if (n) {
+	  auto const c = std::span<uint32_t>(coords).subspan(blockCoords);
+	  auto const f = std::span<distribn_t>(fs).subspan(blockFs);
+	  indexFile.ReadAt(coordsOffset, c);
+	  if (delta) {
+	    // Base block, then the difference from it
+	    baseFile.ReadAt(dataOffset + sizeof(uint64_t), f);
+	    std::vector<char> encoded(deltaLengths[b] - sizeof(uint64_t));
+	    inputFile.ReadAt(deltaOffset + sizeof(uint64_t), std::span<char>(encoded));
+	    cp::DecodeDelta(encoded, f, f);
+	  } else {
+	    inputFile.ReadAt(dataOffset + sizeof(uint64_t), f);
 	  }
-	  if (rank != comms.Rank())
-	    throw Exception() << "Site read on rank " << comms.Rank()
-			      << " but should be read on " << rank;
-	  if (index != iSite)
-	    throw Exception() << "Site read at index " << iSite
-			      << " but should be read at " << index;
+	  if (cp::Checksum(std::span<uint32_t const>(c)) != coordsChecksum)
+	    throw Exception() << "Checksum mismatch in checkpoint index block " << b;
+	  if (cp::Checksum(std::span<distribn_t const>(f)) != fsChecksum)
+	    throw Exception() << "Checksum mismatch in checkpoint block " << b;
 	}
+	coordsOffset += 3 * sizeof(uint32_t) * n;
+	dataOffset += sizeof(uint64_t) + NUMVECTORS * sizeof(distribn_t) * n;
+	if (delta)
+	  deltaOffset += deltaLengths[b];
+      }
+      StoreSites(latDat, coords, fs);
+    }
+
+    void LocalDistributionInput::StoreSites(geometry::FieldData* latDat, std::span<const uint32_t> coords,
+					    std::span<const distribn_t> allFs) {
+      auto&& dom = latDat->GetDomain();
+      const auto NUMVECTORS = dom.GetLatticeInfo().GetNumVectors();
+
+      // Sort the sites by the rank that owns them in this run
+      std::vector<std::vector<int>> indicesByRank(comms.Size());
+      std::vector<std::vector<distribn_t>> fsByRank(comms.Size());
+      for (std::size_t i = 0; i < coords.size() / 3; ++i) {
+	// Convert to canonical type and look up the rank and site
+	// ID, as decomposed by this run of HemeLB
+	util::Vector3D<site_t> grid{coords[3 * i], coords[3 * i + 1], coords[3 * i + 2]};
+	if (!dom.IsValidLatticeSite(grid))
+	  throw Exception() << "Cannot get valid site from extracted site coordinate";
+	auto const [rank, index] = dom.GetRankIndexFromGlobalCoords(grid);
+	if (rank < 0 || rank >= comms.Size())
+	  throw Exception() << "Cannot get valid site from extracted site coordinate";
+
+	indicesByRank[rank].push_back(index);
+	auto const siteFs = allFs.subspan(i * NUMVECTORS, NUMVECTORS);
+	fsByRank[rank].insert(fsByRank[rank].end(), siteFs.begin(), siteFs.end());
+      }
+      // Deliver the sites to their owners
+      auto flatten = [&](auto const& byRank) {
+	using T = typename std::decay_t<decltype(byRank)>::value_type::value_type;
+	std::vector<int> sizes(byRank.size());
+	std::transform(byRank.begin(), byRank.end(), sizes.begin(),
+		       [](auto const& v) { return int(v.size()); });
+	net::displaced_data<T> ans{sizes};
+	for (std::size_t r = 0; r < byRank.size(); ++r)
+	  std::copy(byRank[r].begin(), byRank[r].end(), ans[r].begin());
+	return ans;
+      };
+      auto const indices = comms.AllToAllV(flatten(indicesByRank)).data;
+      auto const fs = comms.AllToAllV(flatten(fsByRank)).data;
+
+      std::vector<bool> seen(dom.GetLocalFluidSiteCount(), false);
+      for (std::size_t i = 0; i < indices.size(); ++i) {
+	auto const iSite = indices[i];
+	if (iSite < 0 || iSite >= dom.GetLocalFluidSiteCount() || seen[iSite])
+	  throw Exception() << "Checkpoint site " << iSite << " is invalid or duplicated on rank "
+			    << comms.Rank();
+	seen[iSite] = true;
 
 	distribn_t* f_old_p = latDat->GetFOld(iSite * NUMVECTORS);
 	distribn_t* f_new_p = latDat->GetFNew(iSite * NUMVECTORS);
 	// distField is read on IO rank and checked to be equal to
 	// NUMVECTORS so we use that instead of broadcasting and
 	// storing.
-	for (auto i = 0U; i < NUMVECTORS; i++) {
-	  distribn_t field_val;
-	  dataReader.read(field_val);
-	  f_new_p[i] = f_old_p[i] = field_val;
+	for (auto j = 0U; j < NUMVECTORS; j++) {
+	  f_new_p[j] = f_old_p[j] = fs[i * NUMVECTORS + j];
 	}
       }
 
-      if (iSite != dom.GetLocalFluidSiteCount())
-	throw Exception() << "Read " << iSite
+      if (site_t(indices.size()) != dom.GetLocalFluidSiteCount())
+	throw Exception() << "Read " << indices.size()
 			  << " sites but expected " << dom.GetLocalFluidSiteCount();
     }
 
@@ -281,29 +488,25 @@ namespace hemelb::extraction {
 			    << " Supported: " << unsigned(fmt::offset::VersionNumber)
 			    << " Input: " << version;
 
+	if (nRanks < 1)
+	  throw Exception() << "Offset file has invalid number of MPI ranks: " << nRanks;
 	if (nRanks != comms.Size())
-	  throw Exception() << "Offset file has wrong number of MPI ranks."
-			    << " Running with: " << comms.Size()
-			    << " Input: " << nRanks;
-
-	// Now read the encoded nProcs+1 values
-	// We are going to duplicate these into a flattened array of shape (nRanks, 2)
-	// [start0, end0, start1, end1, ...]
-	// where end_i == start_i+1 (except for the start finish obvs)
-	offsets.resize(2*nRanks);
-	offsetReader.read(offsets[0]);
-	for (int i = 1; i < nRanks; ++i) {
-	  offsetReader.read(offsets[2*i]);
-	  offsets[2*i - 1] = offsets[2*i];
-	}
-	offsetReader.read(offsets[2*nRanks-1]);
+	  log::Logger::Log<log::Info, log::Singleton>(
+	    "Checkpoint written by %d ranks, redistributing over %d ranks", nRanks, comms.Size()
+	  );
+
+	// Now read the encoded nProcs+1 values. Only the start of the
+	// first rank and the end of the last one matter, since sites
+	// are redistributed anyway.
+	offsets.resize(nRanks + 1);
+	for (auto& offset: offsets)
+	  offsetReader.read(offset);
+	recordStart = offsets.front();
 	// Compute the total length of a record
-	allCoresWriteLength = offsets[2*nRanks-1] - offsets[0];
+	allCoresWriteLength = offsets.back() - offsets.front();
       }
-      // Now bcast/scatter from IO rank to all
+      // Now bcast from IO rank to all
+      comms.Broadcast(recordStart, comms.GetIORank());
       comms.Broadcast(allCoresWriteLength, comms.GetIORank());
-      auto start_finish = comms.Scatter(offsets, 2, comms.GetIORank());
-      localStart = start_finish[0];
-      localStop = start_finish[1];
     }
 }
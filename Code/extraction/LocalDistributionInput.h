@@ -8,6 +8,7 @@
 
 #include <optional>
 #include <filesystem>
+#include <span>
 
 #include "extraction/IterableDataSource.h"
 #include "extraction/InputField.h"
@@ -46,8 +47,17 @@ namespace hemelb
       // Time is optional, if not supplied will use the last one in
       // the file and will set the argument to that value.
       //
-      // Requires the checkpoint have been saved with exactly the same
-      // domain decomposition as currently running.
+      // The checkpoint may have been saved with any number of ranks
+      // or decomposition: each rank reads an equal share of the sites
+      // and sends them on to the rank that owns them in this run.
+      //
+      // Both extraction-format checkpoints and native checkpoints
+      // (see io/formats/checkpoint.h) can be read; the format is
+      // detected from the magic numbers. For native checkpoints, the
+      // offset path, if given, is the index file; otherwise it is
+      // the index the checkpoint names, in its directory. Native delta files
+      // are reconstructed from the base checkpoint they name, which
+      // must be in the same directory.
       void LoadDistribution(geometry::FieldData* latDat, std::optional<LatticeTimeStep>& initalTime);
 
     private:
@@ -55,15 +65,23 @@ namespace hemelb
       void ReadExtractionHeaders(net::MpiFile&, const unsigned NUMVECTORS);
       void ReadOffsets(const std::string&);
 
+      // Whether the file starts with the native checkpoint (or delta) magic numbers
+      bool IsNative(net::MpiFile&) const;
+      void LoadNative(net::MpiFile&, geometry::FieldData* latDat, std::optional<LatticeTimeStep>& targetTime);
+
+      // Send the sites read by this rank (3 coordinates per site and
+      // their distributions) to the ranks that own them and store
+      // them in the field data. Collective.
+      void StoreSites(geometry::FieldData* latDat, std::span<const uint32_t> coords, std::span<const distribn_t> fs);
+
       const net::IOCommunicator& comms;
 
       // The path to the file to read from.
       std::filesystem::path filePath;
-      std::filesystem::path offsetPath;
+      std::optional<std::filesystem::path> offsetPath;
 
       InputField distField;
-      uint64_t localStart;
-      uint64_t localStop;
+      uint64_t recordStart;
       uint64_t timestep;
       uint64_t allCoresWriteLength;
     };
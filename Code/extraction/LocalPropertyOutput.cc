@@ -3,13 +3,21 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <unordered_map>
+
 #include "hassert.h"
 #include "extraction/LocalPropertyOutput.h"
+#include "io/Compression.h"
 #include "io/formats/formats.h"
 #include "io/formats/extraction.h"
 #include "io/formats/offset.h"
 #include "io/writers/XdrMemWriter.h"
 #include "io/writers/XdrVectorWriter.h"
+#include "log/Logger.h"
 #include "net/IOCommunicator.h"
 #include "util/span.h"
 #include "constants.h"
@@ -42,6 +50,18 @@ namespace hemelb::extraction
 	return ans;
       }
 
+      // Pack vectors indexed by rank for an all to all
+      template <typename T>
+      net::displaced_data<T> flatten(std::vector<std::vector<T>> const& byRank) {
+	std::vector<int> sizes(byRank.size());
+	std::transform(byRank.begin(), byRank.end(), sizes.begin(),
+		       [](auto const& v) { return int(v.size()); });
+	net::displaced_data<T> ans{sizes};
+	for (std::size_t r = 0; r < byRank.size(); ++r)
+	  std::copy(byRank[r].begin(), byRank[r].end(), ans[r].begin());
+	return ans;
+      }
+
       // Helper for writing values converted to the type contained in
       // the code::Type variant tag value.
       //
@@ -94,8 +114,17 @@ namespace hemelb::extraction
 
       header_length = io::formats::extraction::MainHeaderLength + CalcFieldHeaderLength(outputSpec.fields);
 
-      // Count sites on this rank
-      local_site_count = CountWrittenSitesOnRank();
+      // Find sites on this rank
+      SelectWrittenSitesOnRank();
+      local_site_count = selected_sites.size();
+      for (auto const& field: outputSpec.fields)
+      {
+	if (std::holds_alternative<statistic::None>(field.statistic))
+	  accumulators.emplace_back();
+	else
+	  accumulators.emplace_back(std::in_place, field.statistic, selected_sites.size(),
+				    GetFieldLength(field.src));
+      }
       global_site_count = comms.AllReduce(local_site_count, MPI_SUM);
 
       // Calculate how long local writes need to be (recall only IO
@@ -115,11 +144,25 @@ namespace hemelb::extraction
 	header_data = PrepareHeader();
       }
 
-      // Create the buffer that we'll write each iteration's data into.
-      buffer.resize(local_data_write_length);
+      // Create the buffers that we'll write each iteration's data
+      // into. Compressed data vary in length so those are sized when
+      // written.
+      pending_writes.resize(std::max(outputSpec.queue_depth, 1U));
+      if (IsHdf5())
+      {
+#ifndef HEMELB_USE_HDF5
+	throw Exception() << "HDF5 extraction output needs HemeLB built with HEMELB_USE_HDF5";
+#endif
+      }
+      else if (!IsCompressed())
+      {
+	for (auto& write: pending_writes)
+	  write.buffer.resize(local_data_write_length);
 
-      // Write the offset file
-      WriteOffsetFile();
+	// Write the offset file. Compressed records vary in length, so
+	// fixed offsets are no use for them.
+	WriteOffsetFile();
+      }
 
       // If we are doing all timesteps in one file, set it up now.
       if (std::holds_alternative<multi_timestep_file>(outputSpec.ts_mode)) {
@@ -127,17 +170,201 @@ namespace hemelb::extraction
       }
     }
 
-    uint64_t LocalPropertyOutput::CountWrittenSitesOnRank() {
-      auto n = uint64_t{0};
+    LocalPropertyOutput::~LocalPropertyOutput()
+    {
+      try
+      {
+	Flush();
+      }
+      catch (std::exception const& e)
+      {
+	log::Logger::Log<log::Error, log::OnePerCore>("Could not complete extraction output: %s", e.what());
+      }
+    }
+
+    void LocalPropertyOutput::SelectWrittenSitesOnRank() {
+      selected_sites.clear();
+      box_starts.clear();
+      box_sites.clear();
+      auto const factor = overload_visit(outputSpec.grid,
+	[](full_grid) { return 1U; },
+	[](subsampled_grid g) { return g.factor; },
+	[](box_filtered_grid g) { return g.factor; }
+      );
+
+      // When box filtering, the selected sites in each block, with
+      // blocks in the order their first site is met
+      std::unordered_map<std::uint64_t, std::size_t> block_numbers;
+      std::vector<std::uint64_t> block_keys;
+      std::vector<util::Vector3D<std::uint32_t>> block_positions;
+      std::vector<std::vector<site_t>> blocks;
+
+      site_t index = 0;
       dataSource.Reset();
       while (dataSource.ReadNext())
       {
-	if (outputSpec.geometry->Include(dataSource, dataSource.GetPosition()))
+	auto const position = dataSource.GetPosition();
+	if (outputSpec.geometry->Include(dataSource, position))
         {
-	  ++n;
+	  auto const lattice = position.as<std::uint32_t>();
+	  auto const coarse = lattice / factor;
+	  overload_visit(outputSpec.grid,
+	    [&](full_grid) {
+	      selected_sites.push_back({index, lattice});
+	    },
+	    [&](subsampled_grid) {
+	      if (coarse * factor == lattice)
+		selected_sites.push_back({index, coarse});
+	    },
+	    [&](box_filtered_grid) {
+	      // Coordinates fit in 21 bits
+	      auto const key = (std::uint64_t(coarse.x()) << 42) | (std::uint64_t(coarse.y()) << 21)
+		| std::uint64_t(coarse.z());
+	      auto const [it, added] = block_numbers.try_emplace(key, blocks.size());
+	      if (added)
+	      {
+		block_keys.push_back(key);
+		block_positions.push_back(coarse);
+		blocks.emplace_back();
+	      }
+	      blocks[it->second].push_back(index);
+	    }
+	  );
+	}
+	++index;
+      }
+
+      if (!IsBoxFiltered())
+	return;
+
+      // Each block is written by the lowest rank with sites in it.
+      // The rank that a block's key hashes to finds out which that is.
+      auto const size = std::size_t(comms.Size());
+      std::vector<std::vector<std::uint64_t>> keysByHome(size);
+      for (auto const key: block_keys)
+	keysByHome[key % size].push_back(key);
+      auto atHome = comms.AllToAllV(flatten(keysByHome));
+      std::unordered_map<std::uint64_t, int> lowest;
+      for (std::size_t r = 0; r < size; ++r)
+	for (auto const key: atHome[r])
+	  lowest.try_emplace(key, int(r));
+      std::vector<std::vector<int>> ownersByRank(size);
+      for (std::size_t r = 0; r < size; ++r)
+	for (auto const key: atHome[r])
+	  ownersByRank[r].push_back(lowest.at(key));
+      auto owners = comms.AllToAllV(flatten(ownersByRank));
+
+      // Our blocks go first, then those we send to their owners
+      std::vector<std::size_t> order;
+      std::vector<std::size_t> answered(size, 0);
+      std::vector<std::vector<std::size_t>> sentByOwner(size);
+      for (std::size_t b = 0; b < blocks.size(); ++b)
+      {
+	auto const home = block_keys[b] % size;
+	auto const owner = owners[home][answered[home]++];
+	if (owner == comms.Rank())
+	{
+	  selected_sites.push_back({blocks[b].front(), block_positions[b]});
+	  order.push_back(b);
+	}
+	else
+	{
+	  sentByOwner[owner].push_back(b);
+	}
+      }
+      auto const n_selected = order.size();
+
+      box_sends.assign(size, {});
+      std::vector<std::vector<std::uint64_t>> keysByOwner(size), countsByOwner(size);
+      for (std::size_t r = 0; r < size; ++r)
+	for (auto const b: sentByOwner[r])
+	{
+	  box_sends[r].push_back(order.size());
+	  order.push_back(b);
+	  keysByOwner[r].push_back(block_keys[b]);
+	  countsByOwner[r].push_back(blocks[b].size());
+	}
+
+      box_starts.push_back(0);
+      for (auto const b: order)
+      {
+	box_sites.insert(box_sites.end(), blocks[b].begin(), blocks[b].end());
+	box_starts.push_back(box_sites.size());
+      }
+
+      // Find which of our blocks the others will send sums for, and
+      // count all the sites in each
+      std::unordered_map<std::uint64_t, std::size_t> selected_numbers;
+      box_counts.clear();
+      for (std::size_t i = 0; i < n_selected; ++i)
+      {
+	selected_numbers.emplace(block_keys[order[i]], i);
+	box_counts.push_back(blocks[order[i]].size());
+      }
+      auto keysIn = comms.AllToAllV(flatten(keysByOwner));
+      auto countsIn = comms.AllToAllV(flatten(countsByOwner));
+      box_receives.assign(size, {});
+      for (std::size_t r = 0; r < size; ++r)
+      {
+	auto const keys = keysIn[r];
+	auto const counts = countsIn[r];
+	for (std::size_t k = 0; k < keys.size(); ++k)
+	{
+	  auto const i = selected_numbers.at(keys[k]);
+	  box_receives[r].push_back(i);
+	  box_counts[i] += counts[k];
 	}
       }
-      return n;
+    }
+
+    void LocalPropertyOutput::ReduceBoxSamples()
+    {
+      // Where each field's source starts in a block's values
+      std::vector<std::size_t> starts{0};
+      for (auto const& field: outputSpec.fields)
+	starts.push_back(starts.back() + GetFieldLength(field.src));
+      auto const length = starts.back();
+
+      // Sums over this rank's sites in each block
+      auto const n_blocks = box_starts.size() - 1;
+      std::vector<double> sums(n_blocks * length, 0.0);
+      std::vector<double> sample;
+      for (std::size_t b = 0; b < n_blocks; ++b)
+      {
+	for (auto i = box_starts[b]; i < box_starts[b + 1]; ++i)
+	{
+	  dataSource.SetSite(box_sites[i]);
+	  for (std::size_t i_field = 0; i_field < outputSpec.fields.size(); ++i_field)
+	  {
+	    ReadSample(outputSpec.fields[i_field], sample);
+	    auto const sum = sums.begin() + b * length + starts[i_field];
+	    std::transform(sample.begin(), sample.end(), sum, sum, std::plus<double>{});
+	  }
+	}
+      }
+
+      // Add the sums of split blocks up on the ranks that write them
+      std::vector<std::vector<double>> sumsByRank(box_sends.size());
+      for (std::size_t r = 0; r < box_sends.size(); ++r)
+	for (auto const b: box_sends[r])
+	  sumsByRank[r].insert(sumsByRank[r].end(), sums.begin() + b * length,
+			       sums.begin() + (b + 1) * length);
+      auto received = comms.AllToAllV(flatten(sumsByRank));
+      for (std::size_t r = 0; r < box_receives.size(); ++r)
+      {
+	auto const in = received[r];
+	for (std::size_t k = 0; k < box_receives[r].size(); ++k)
+	{
+	  auto const sum = sums.begin() + box_receives[r][k] * length;
+	  std::transform(in.begin() + k * length, in.begin() + (k + 1) * length, sum, sum,
+			 std::plus<double>{});
+	}
+      }
+
+      box_means.assign(sums.begin(), sums.begin() + selected_sites.size() * length);
+      for (std::size_t i_site = 0; i_site < selected_sites.size(); ++i_site)
+	for (std::size_t j = 0; j < length; ++j)
+	  box_means[i_site * length + j] /= double(box_counts[i_site]);
     }
 
     // Work out how many bytes are needed to write one site's data.
@@ -149,7 +376,7 @@ namespace hemelb::extraction
       for (auto&& f: fields) {
 	// Also check that len offsets makes sense
 	auto n = f.noffsets;
-	auto len = GetFieldLength(f.src);
+	auto len = GetFieldLength(f);
 	if (n == 0 || n == 1 || n == len) {
 	  // ok
 	} else {
@@ -185,9 +412,10 @@ namespace hemelb::extraction
       // Encoder for ONLY the main header (note shorter length)
       headerWriter << std::uint32_t(io::formats::HemeLbMagicNumber)
 		   << std::uint32_t(io::formats::extraction::MagicNumber)
-		   << std::uint32_t(io::formats::extraction::VersionNumber);
-      headerWriter << double(dataSource.GetVoxelSize());
-      const util::Vector3D<distribn_t> &origin = dataSource.GetOrigin();
+		   << std::uint32_t(IsCompressed() ? unsigned(io::formats::extraction::CompressedVersionNumber)
+				    : unsigned(io::formats::extraction::VersionNumber));
+      headerWriter << double(GetGridVoxelSize());
+      auto const origin = GetGridOrigin();
       headerWriter << double(origin[0]) << double(origin[1]) << double(origin[2]);
 
       // Write the total site count and number of fields
@@ -196,7 +424,7 @@ namespace hemelb::extraction
 
       // Main header now finished - do field headers
       for (auto& field: outputSpec.fields) {
-	auto const len = GetFieldLength(field.src);
+	auto const len = GetFieldLength(field);
 	headerWriter << field.name
 		     << uint32_t(len)
 		     << uint32_t(code::type_to_enum(field.typecode))
@@ -224,6 +452,22 @@ namespace hemelb::extraction
 
     void LocalPropertyOutput::StartFile(std::string const& fn)
     {
+#ifdef HEMELB_USE_HDF5
+      if (IsHdf5())
+      {
+        std::vector<unsigned> lengths;
+        for (auto const& field: outputSpec.fields)
+          lengths.push_back(GetFieldLength(field));
+        std::vector<util::Vector3D<std::uint32_t>> coords;
+        coords.reserve(selected_sites.size());
+        for (auto const& site: selected_sites)
+          coords.push_back(site.position);
+        hdf5_file = std::make_unique<Hdf5FieldWriter>(fn, outputSpec.fields, lengths, coords,
+                                                      GetGridVoxelSize(), GetGridOrigin(),
+                                                      std::get<hdf5_format>(outputSpec.format), comms);
+        return;
+      }
+#endif
       // Open the file as write-only, create it if it doesn't exist,
       // don't create if the file already exists.
       outputFile = net::MpiFile::Open(comms, fn,
@@ -235,6 +479,209 @@ namespace hemelb::extraction
         // Write from the buffer
         outputFile.WriteAt(0, to_const_span(header_data));
       }
+
+      if (IsCompressed())
+      {
+        WriteSiteSection();
+      }
+    }
+
+    bool LocalPropertyOutput::IsCompressed() const
+    {
+      return !std::holds_alternative<no_compression>(outputSpec.compression);
+    }
+
+    bool LocalPropertyOutput::IsHdf5() const
+    {
+      return std::holds_alternative<hdf5_format>(outputSpec.format);
+    }
+
+    bool LocalPropertyOutput::IsBoxFiltered() const
+    {
+      return std::holds_alternative<box_filtered_grid>(outputSpec.grid);
+    }
+
+    PhysicalDistance LocalPropertyOutput::GetGridVoxelSize() const
+    {
+      return overload_visit(outputSpec.grid,
+	[&](full_grid) { return dataSource.GetVoxelSize(); },
+	[&](auto g) { return g.factor * dataSource.GetVoxelSize(); }
+      );
+    }
+
+    PhysicalPosition LocalPropertyOutput::GetGridOrigin() const
+    {
+      // A box filtered value belongs at the centre of its block
+      return overload_visit(outputSpec.grid,
+	[&](box_filtered_grid g) {
+	  auto const shift = 0.5 * (g.factor - 1) * dataSource.GetVoxelSize();
+	  return dataSource.GetOrigin() + PhysicalPosition(shift, shift, shift);
+	},
+	[&](auto) { return dataSource.GetOrigin(); }
+      );
+    }
+
+    void LocalPropertyOutput::WriteSiteSection()
+    {
+      namespace xtr = io::formats::extraction;
+
+      // Coordinates, column-wise
+      io::XdrVectorWriter siteWriter;
+      for (int d = 0; d < 3; ++d)
+      {
+	for (auto const& site: selected_sites)
+	{
+	  siteWriter << site.position[d];
+	}
+      }
+      auto const chunk = io::Deflate(siteWriter.GetBuf());
+
+      // IO rank writes the section header, followed by its own chunk
+      std::array<std::uint64_t, 2> const lengths{selected_sites.size(), chunk.size()};
+      auto const allLengths = comms.Gather(lengths, comms.GetIORank());
+      std::vector<char> buf;
+      if (comms.OnIORank())
+      {
+	auto const lossy = std::get_if<lossy_compression>(&outputSpec.compression);
+	io::XdrVectorWriter headerWriter;
+	headerWriter << std::uint32_t(comms.Size())
+		     << std::uint32_t(lossy ? xtr::Codec::LOSSY : xtr::Codec::DEFLATE)
+		     << double(lossy ? lossy->tolerance : 0.0);
+	for (auto const& l: allLengths)
+	  headerWriter << l[0];
+	for (auto const& l: allLengths)
+	  headerWriter << l[1];
+	buf = headerWriter.GetBuf();
+	HASSERT(buf.size() == xtr::SiteHeaderLength + 16 * allLengths.size());
+      }
+      buf.insert(buf.end(), chunk.begin(), chunk.end());
+
+      std::uint64_t const size = buf.size();
+      auto const offset = header_length + comms.Scan(size, MPI_SUM) - size;
+      outputFile.WriteAt(offset, to_const_span(buf));
+      record_start = header_length + comms.AllReduce(size, MPI_SUM);
+    }
+
+    void LocalPropertyOutput::WriteCompressedRecord(unsigned long timestepNumber, PendingWrite& slot)
+    {
+      // Values, column-wise
+      std::vector<std::vector<double>> columns;
+      for (auto const& field: outputSpec.fields)
+      {
+	columns.resize(columns.size() + GetFieldLength(field));
+      }
+      std::vector<double> values;
+      for (std::size_t i_site = 0; i_site < selected_sites.size(); ++i_site)
+      {
+	auto column = columns.begin();
+	for (std::size_t i_field = 0; i_field < outputSpec.fields.size(); ++i_field)
+	{
+	  if (auto const& accumulator = accumulators[i_field])
+	  {
+	    values.resize(accumulator->GetLength());
+	    accumulator->Get(i_site, values);
+	  }
+	  else
+	  {
+	    ReadSiteSample(i_site, i_field, values);
+	  }
+	  for (auto const value: values)
+	  {
+	    (column++)->push_back(value);
+	  }
+	}
+      }
+
+      io::XdrVectorWriter dataWriter;
+      auto const lossy = std::get_if<lossy_compression>(&outputSpec.compression);
+      unsigned long notQuantised = 0;
+      auto column = columns.begin();
+      for (auto const& field: outputSpec.fields)
+      {
+	auto const floating = std::holds_alternative<float>(field.typecode)
+	  || std::holds_alternative<double>(field.typecode);
+	for (auto j = 0U; j < GetFieldLength(field); ++j, ++column)
+	{
+	  for (auto const value: *column)
+	  {
+	    if (lossy && floating)
+	    {
+	      // Values of a diverged run, or past the range of a hyper,
+	      // are marked rather than rounded to an arbitrary integer
+	      auto const q = value / (2.0 * lossy->tolerance);
+	      if (std::abs(q) < 0x1p63)
+		dataWriter << std::int64_t(std::llround(q));
+	      else
+	      {
+		dataWriter << io::formats::extraction::LossyNotANumber;
+		++notQuantised;
+	      }
+	    }
+	    else
+	      write(dataWriter, field.typecode, value);
+	  }
+	}
+      }
+      if (notQuantised)
+	log::Logger::Log<log::Warning, log::OnePerCore>("%lu values at time step %lu are not finite or too large to quantise, "
+							 "so are written as NaN", notQuantised, timestepNumber);
+      auto const chunk = io::Deflate(dataWriter.GetBuf());
+
+      // IO rank writes the record header, followed by its own chunk
+      std::uint64_t const chunkLength = chunk.size();
+      auto const chunkLengths = comms.Gather(chunkLength, comms.GetIORank());
+      slot.buffer.clear();
+      if (comms.OnIORank())
+      {
+	io::XdrVectorWriter headerWriter;
+	headerWriter << std::uint64_t(timestepNumber)
+		     << std::uint64_t(std::accumulate(chunkLengths.begin(), chunkLengths.end(), std::uint64_t{0}));
+	for (auto const l: chunkLengths)
+	  headerWriter << l;
+	slot.buffer = headerWriter.GetBuf();
+      }
+      slot.buffer.insert(slot.buffer.end(), chunk.begin(), chunk.end());
+
+      std::uint64_t const size = slot.buffer.size();
+      auto const offset = record_start + comms.Scan(size, MPI_SUM) - size;
+      slot.request = outputFile.IWriteAt(offset, to_const_span(slot.buffer));
+      record_start += comms.AllReduce(size, MPI_SUM);
+    }
+
+    void LocalPropertyOutput::WriteHdf5Record(unsigned long timestepNumber)
+    {
+#ifdef HEMELB_USE_HDF5
+      // Values of each field, site by site
+      std::vector<std::vector<double>> columns(outputSpec.fields.size());
+      std::vector<double> values;
+      for (std::size_t i_site = 0; i_site < selected_sites.size(); ++i_site)
+      {
+	for (std::size_t i_field = 0; i_field < outputSpec.fields.size(); ++i_field)
+	{
+	  if (auto const& accumulator = accumulators[i_field])
+	  {
+	    values.resize(accumulator->GetLength());
+	    accumulator->Get(i_site, values);
+	  }
+	  else
+	  {
+	    ReadSiteSample(i_site, i_field, values);
+	  }
+	  columns[i_field].insert(columns[i_field].end(), values.begin(), values.end());
+	}
+      }
+      hdf5_file->Write(timestepNumber, columns);
+
+      for (auto& accumulator: accumulators)
+      {
+	if (accumulator)
+	  accumulator->Reset();
+      }
+      if (std::holds_alternative<single_timestep_files>(outputSpec.ts_mode))
+      {
+	hdf5_file.reset();
+      }
+#endif
     }
 
     template <typename... Ts>
@@ -253,6 +700,17 @@ namespace hemelb::extraction
 
     void LocalPropertyOutput::Write(unsigned long timestepNumber, unsigned long totalSteps)
     {
+        // Blocks split between ranks are added up before they are used
+        if (IsBoxFiltered() && (HasStatistics() || ShouldWrite(timestepNumber)))
+        {
+            ReduceBoxSamples();
+        }
+
+        if (HasStatistics())
+        {
+            Accumulate(timestepNumber);
+        }
+
         // Don't write if we shouldn't this iteration.
         if (!ShouldWrite(timestepNumber))
         {
@@ -270,11 +728,28 @@ namespace hemelb::extraction
             StartFile(fn);
         }
 
+      if (IsHdf5())
+      {
+        WriteHdf5Record(timestepNumber);
+        return;
+      }
+
+      // Take the oldest buffer, waiting for its write if need be. It
+      // keeps the file open until its write is done.
+      auto& slot = pending_writes[next_write];
+      next_write = (next_write + 1) % pending_writes.size();
+      Complete(slot);
+      slot.file = outputFile;
+
+      if (IsCompressed())
+      {
+	WriteCompressedRecord(timestepNumber, slot);
+      }
       // Don't write if this core doesn't do anything.
-      if (local_data_write_length > 0)
+      else if (local_data_write_length > 0)
       {
 	// Create the buffer.
-	auto xdrWriter = io::MakeXdrWriter(buffer.begin(), buffer.end());
+	auto xdrWriter = io::MakeXdrWriter(slot.buffer.begin(), slot.buffer.end());
 
 	// Firstly, the IO proc must write the iteration number.
 	if (comms.OnIORank())
@@ -282,80 +757,106 @@ namespace hemelb::extraction
 	  xdrWriter << (uint64_t) timestepNumber;
 	}
 
-	dataSource.Reset();
-
-	while (dataSource.ReadNext())
+	std::vector<double> values;
+	for (std::size_t i_site = 0; i_site < selected_sites.size(); ++i_site)
 	{
-	  const util::Vector3D<site_t>& position = dataSource.GetPosition();
-	  if (outputSpec.geometry->Include(dataSource, position))
-	  {
-	    // Write the position
-	    xdrWriter << (uint32_t) position.x() << (uint32_t) position.y() << (uint32_t) position.z();
+	  auto const& [index, position] = selected_sites[i_site];
+	  dataSource.SetSite(index);
+	  // Write the position
+	  xdrWriter << position.x() << position.y() << position.z();
 
-	    // Write for each field.
-	    for (auto& fieldSpec: outputSpec.fields)
+	  // Write for each field.
+	  for (std::size_t i_field = 0; i_field < outputSpec.fields.size(); ++i_field)
+	  {
+	    auto const& fieldSpec = outputSpec.fields[i_field];
+	    if (auto const& accumulator = accumulators[i_field])
 	    {
-	      overload_visit(
-	        fieldSpec.src,
-		[&](source::Pressure) {
-		  write(xdrWriter, fieldSpec.typecode, dataSource.GetPressure() - fieldSpec.offset[0]);
-		},
-		[&](source::Velocity) {
-		  auto&& v = dataSource.GetVelocity();
-		  write(xdrWriter, fieldSpec.typecode, v.x(), v.y(), v.z());
-		},
-		//! @TODO: Work out how to handle the different stresses.
-		[&](source::VonMisesStress) {
-		  write(xdrWriter, fieldSpec.typecode, dataSource.GetVonMisesStress());
-		},
-		[&](source::ShearStress) {
-		  write(xdrWriter, fieldSpec.typecode, dataSource.GetShearStress());
-		},
-		[&](source::ShearRate) {
-		  write(xdrWriter, fieldSpec.typecode, dataSource.GetShearRate());
-		},
-		[&](source::StressTensor) {
-		  util::Matrix3D tensor = dataSource.GetStressTensor();
-		  // Only the upper triangular part of the symmetric
-		  // tensor is stored. Storage is row-wise.
-		  write(xdrWriter, fieldSpec.typecode,
-			tensor[0][0], tensor[0][1], tensor[0][2],
-                                      tensor[1][1], tensor[1][2],
-                                                    tensor[2][2]);
-		},
-		[&](source::Traction) {
-		  auto&& t = dataSource.GetTraction();
-		  write(xdrWriter, fieldSpec.typecode, t.x(), t.y(), t.z());
-		},
-		[&](source::TangentialProjectionTraction) {
-		  auto&& t = dataSource.GetTangentialProjectionTraction();
-		  write(xdrWriter, fieldSpec.typecode, t.x(), t.y(), t.z());
-		},
-		[&](source::Distributions) {
-		  unsigned numComponents = dataSource.GetNumVectors();
-		  distribn_t const* d_ptr = dataSource.GetDistribution();
-		  for (auto i = 0U; i < numComponents; i++)
-		  {
-		    write(xdrWriter, fieldSpec.typecode, d_ptr[i]);
-		  }
-		},
-		[&](source::MpiRank) {
-		  write(xdrWriter, fieldSpec.typecode, comms.Rank());
-		}
-              );
+	      values.resize(accumulator->GetLength());
+	      accumulator->Get(i_site, values);
+	      for (auto const value: values)
+		write(xdrWriter, fieldSpec.typecode, value);
+	      continue;
 	    }
+	    if (IsBoxFiltered())
+	    {
+	      ReadSiteSample(i_site, i_field, values);
+	      for (auto const value: values)
+		write(xdrWriter, fieldSpec.typecode, value);
+	      continue;
+	    }
+
+	    overload_visit(
+	      fieldSpec.src,
+	      [&](source::Pressure) {
+		write(xdrWriter, fieldSpec.typecode, dataSource.GetPressure() - fieldSpec.offset[0]);
+	      },
+	      [&](source::Velocity) {
+		auto&& v = dataSource.GetVelocity();
+		write(xdrWriter, fieldSpec.typecode, v.x(), v.y(), v.z());
+	      },
+	      //! @TODO: Work out how to handle the different stresses.
+	      [&](source::VonMisesStress) {
+		write(xdrWriter, fieldSpec.typecode, dataSource.GetVonMisesStress());
+	      },
+	      [&](source::ShearStress) {
+		write(xdrWriter, fieldSpec.typecode, dataSource.GetShearStress());
+	      },
+	      [&](source::ShearRate) {
+		write(xdrWriter, fieldSpec.typecode, dataSource.GetShearRate());
+	      },
+	      [&](source::StressTensor) {
+		util::Matrix3D tensor = dataSource.GetStressTensor();
+		// Only the upper triangular part of the symmetric
+		// tensor is stored. Storage is row-wise.
+		write(xdrWriter, fieldSpec.typecode,
+		      tensor[0][0], tensor[0][1], tensor[0][2],
+				    tensor[1][1], tensor[1][2],
+						  tensor[2][2]);
+	      },
+	      [&](source::Traction) {
+		auto&& t = dataSource.GetTraction();
+		write(xdrWriter, fieldSpec.typecode, t.x(), t.y(), t.z());
+	      },
+	      [&](source::TangentialProjectionTraction) {
+		auto&& t = dataSource.GetTangentialProjectionTraction();
+		write(xdrWriter, fieldSpec.typecode, t.x(), t.y(), t.z());
+	      },
+	      [&](source::Distributions) {
+		unsigned numComponents = dataSource.GetNumVectors();
+		distribn_t const* d_ptr = dataSource.GetDistribution();
+		for (auto i = 0U; i < numComponents; i++)
+		{
+		  write(xdrWriter, fieldSpec.typecode, d_ptr[i]);
+		}
+	      },
+	      [&](source::MpiRank) {
+		write(xdrWriter, fieldSpec.typecode, comms.Rank());
+	      }
+	    );
 	  }
 	}
 
 	// Actually do the MPI writing.
-	outputFile.WriteAt(local_write_start, to_const_span(buffer));
+	slot.request = outputFile.IWriteAt(local_write_start, to_const_span(slot.buffer));
+      }
+
+      // Statistics start again after each write
+      for (auto& accumulator: accumulators)
+      {
+	if (accumulator)
+	  accumulator->Reset();
+      }
+
+      if (outputSpec.queue_depth == 0)
+      {
+	Complete(slot);
       }
 
       overload_visit(
         outputSpec.ts_mode,
 	[this](multi_timestep_file) {
 	  // Set the offset to the right place for writing on the next
-	  // iteration.
+	  // iteration. Compressed records keep track themselves.
 	  local_write_start += global_data_write_length;
 	},
 	[this](single_timestep_files) {
@@ -364,6 +865,50 @@ namespace hemelb::extraction
       );
     }
 
+    void LocalPropertyOutput::Complete(PendingWrite& write)
+    {
+      if (write.request != MPI_REQUEST_NULL)
+      {
+	int done;
+	net::MpiCall{MPI_Test}(&write.request, &done, MPI_STATUS_IGNORE);
+	if (!done)
+	{
+	  // The file system is not keeping up
+	  ++stall_count;
+	  auto const start = MPI_Wtime();
+	  net::MpiCall{MPI_Wait}(&write.request, MPI_STATUS_IGNORE);
+	  stall_time += MPI_Wtime() - start;
+	}
+      }
+      write.file.Close();
+    }
+
+    void LocalPropertyOutput::Flush()
+    {
+      // Oldest first, so that files are closed in the same order on
+      // every rank
+      for (std::size_t i = 0; i < pending_writes.size(); ++i)
+      {
+	Complete(pending_writes[(next_write + i) % pending_writes.size()]);
+      }
+#ifdef HEMELB_USE_HDF5
+      if (hdf5_file)
+      {
+	hdf5_file->Flush();
+      }
+#endif
+    }
+
+    std::uint64_t LocalPropertyOutput::GetStallCount() const
+    {
+      return stall_count;
+    }
+
+    double LocalPropertyOutput::GetStallTime() const
+    {
+      return stall_time;
+    }
+
     // Write the offset file.
     void LocalPropertyOutput::WriteOffsetFile() {
       namespace fmt = io::formats;
@@ -395,6 +940,105 @@ namespace hemelb::extraction
       }
     }
 
+    bool LocalPropertyOutput::HasStatistics() const
+    {
+      return std::any_of(accumulators.begin(), accumulators.end(),
+			 [](auto const& accumulator) { return accumulator.has_value(); });
+    }
+
+    void LocalPropertyOutput::Accumulate(unsigned long timestepNumber)
+    {
+      for (auto& accumulator: accumulators)
+      {
+	if (accumulator)
+	  accumulator->StartStep(timestepNumber);
+      }
+
+      std::vector<double> sample;
+      for (std::size_t i_site = 0; i_site < selected_sites.size(); ++i_site)
+      {
+	for (std::size_t i_field = 0; i_field < outputSpec.fields.size(); ++i_field)
+	{
+	  if (auto& accumulator = accumulators[i_field])
+	  {
+	    ReadSiteSample(i_site, i_field, sample);
+	    accumulator->Add(i_site, sample);
+	  }
+	}
+      }
+    }
+
+    void LocalPropertyOutput::ReadSample(OutputField const& field, std::vector<double>& sample) const
+    {
+      sample.clear();
+      overload_visit(
+        field.src,
+	[&](source::Pressure) {
+	  sample.push_back(dataSource.GetPressure() - (field.noffsets ? field.offset[0] : 0.0));
+	},
+	[&](source::Velocity) {
+	  auto&& v = dataSource.GetVelocity();
+	  sample.insert(sample.end(), {v.x(), v.y(), v.z()});
+	},
+	[&](source::VonMisesStress) {
+	  sample.push_back(dataSource.GetVonMisesStress());
+	},
+	[&](source::ShearStress) {
+	  sample.push_back(dataSource.GetShearStress());
+	},
+	[&](source::ShearRate) {
+	  sample.push_back(dataSource.GetShearRate());
+	},
+	[&](source::StressTensor) {
+	  util::Matrix3D tensor = dataSource.GetStressTensor();
+	  sample.insert(sample.end(), {tensor[0][0], tensor[0][1], tensor[0][2],
+				       tensor[1][1], tensor[1][2], tensor[2][2]});
+	},
+	[&](source::Traction) {
+	  auto&& t = dataSource.GetTraction();
+	  sample.insert(sample.end(), {t.x(), t.y(), t.z()});
+	},
+	[&](source::TangentialProjectionTraction) {
+	  auto&& t = dataSource.GetTangentialProjectionTraction();
+	  sample.insert(sample.end(), {t.x(), t.y(), t.z()});
+	},
+	[&](source::Distributions) {
+	  distribn_t const* d_ptr = dataSource.GetDistribution();
+	  sample.insert(sample.end(), d_ptr, d_ptr + dataSource.GetNumVectors());
+	},
+	[&](source::MpiRank) {
+	  sample.push_back(comms.Rank());
+	}
+      );
+    }
+
+    void LocalPropertyOutput::ReadSiteSample(std::size_t i_site, std::size_t i_field,
+					     std::vector<double>& sample) const
+    {
+      if (!IsBoxFiltered())
+      {
+	dataSource.SetSite(selected_sites[i_site].index);
+	ReadSample(outputSpec.fields[i_field], sample);
+	return;
+      }
+
+      // The block's means are those of every field in turn
+      std::size_t start = 0, length = 0;
+      for (std::size_t i = 0; i < outputSpec.fields.size(); ++i)
+      {
+	if (i == i_field)
+	  start = length;
+	length += GetFieldLength(outputSpec.fields[i].src);
+      }
+      auto const begin = box_means.begin() + i_site * length + start;
+      sample.assign(begin, begin + GetFieldLength(outputSpec.fields[i_field].src));
+    }
+
+    unsigned LocalPropertyOutput::GetFieldLength(OutputField const& field) const
+    {
+      return GetStatisticLength(field.statistic, GetFieldLength(field.src));
+    }
+
     unsigned LocalPropertyOutput::GetFieldLength(source::Type src) const
     {
       return overload_visit(src,
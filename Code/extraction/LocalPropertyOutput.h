@@ -6,6 +6,13 @@
 #ifndef HEMELB_EXTRACTION_LOCALPROPERTYOUTPUT_H
 #define HEMELB_EXTRACTION_LOCALPROPERTYOUTPUT_H
 
+#include <memory>
+#include <optional>
+
+#include "extraction/FieldAccumulator.h"
+#ifdef HEMELB_USE_HDF5
+#include "extraction/Hdf5FieldWriter.h"
+#endif
 #include "extraction/IterableDataSource.h"
 #include "extraction/PropertyOutputFile.h"
 #include "lb/Lattices.h"
@@ -29,6 +36,12 @@ namespace hemelb
       // const reference types. Collective on the communicator.
       LocalPropertyOutput(IterableDataSource& dataSource, const PropertyOutputFile& outputSpec,
 			  const net::IOCommunicator& ioComms);
+      LocalPropertyOutput(const LocalPropertyOutput&) = delete;
+      LocalPropertyOutput& operator=(const LocalPropertyOutput&) = delete;
+
+      // Completes any writes still in flight. Collective on the
+      // communicator.
+      ~LocalPropertyOutput();
 
       // True if this property output should be written on the current iteration.
       bool ShouldWrite(unsigned long timestepNumber) const;
@@ -37,28 +50,110 @@ namespace hemelb
       const PropertyOutputFile& GetOutputSpec() const;
 
       // Write this core's section of the data file. Only writes if
-      // appropriate for the current iteration number
+      // appropriate for the current iteration number.
+      //
+      // The data are encoded into one of a ring of buffers and
+      // written with non-blocking MPI-IO, so this returns before they
+      // reach the file. If all the buffers are still being written,
+      // this waits for the oldest one.
       void Write(unsigned long timestepNumber, unsigned long totalSteps);
 
+      // Wait for all writes in flight to complete and close their
+      // files. Collective on the communicator.
+      void Flush();
+
+      // How many times, and for how long in seconds, Write had to wait
+      // for an earlier write to complete before it could reuse its
+      // buffer.
+      std::uint64_t GetStallCount() const;
+      double GetStallTime() const;
+
       // Write the offset file. Collective on the communicator.
       void WriteOffsetFile();
 
-      // Returns the number of items written for the field.
+      // True if written in the compressed format.
+      bool IsCompressed() const;
+
+      // True if written as HDF5 rather than XTR.
+      bool IsHdf5() const;
+
+      // True if each site written is the mean of a block of sites.
+      bool IsBoxFiltered() const;
+
+      // The voxel size and origin of the grid written, which is
+      // coarser than the lattice's for sub-sampled or box filtered
+      // output.
+      PhysicalDistance GetGridVoxelSize() const;
+      PhysicalPosition GetGridOrigin() const;
+
+      // Returns the number of items of the source.
       unsigned GetFieldLength(source::Type) const;
+      // Returns the number of items written for the field, which
+      // differs from its source's for some statistics.
+      unsigned GetFieldLength(OutputField const&) const;
+
+      // True if any field is a statistic, accumulated every time step.
+      bool HasStatistics() const;
 
     private:
-      // How many sites does this MPI process write?
-      std::uint64_t CountWrittenSitesOnRank();
+      // Find the sites this MPI process writes, in iteration order,
+      // and store them in selected_sites. Collective when box
+      // filtering, to agree which rank writes each block.
+      void SelectWrittenSitesOnRank();
+
+      // When box filtering, sum each field's source over the sites of
+      // each block on this rank, add up the sums of blocks split
+      // between ranks on the rank that writes them and store the
+      // means in box_means. Collective.
+      void ReduceBoxSamples();
 
       // How many bytes are written for a single site?
       std::uint64_t CalcSiteWriteLen(std::vector<OutputField> const& fields) const;
 
+      // Add the current values to the statistics
+      void Accumulate(unsigned long timestepNumber);
+
+      // Get the current value of the field's source at the data
+      // source's current site, less any offset
+      void ReadSample(OutputField const& field, std::vector<double>& sample) const;
+
+      // Get the value of a field's source at a selected site, or its
+      // mean over the site's block, as last reduced, when box
+      // filtering. Moves the data source.
+      void ReadSiteSample(std::size_t i_site, std::size_t i_field,
+			  std::vector<double>& sample) const;
+
       // Make the XTR header
       std::vector<char> PrepareHeader() const;
 
       // Open the file specified and write the header. Collective.
       void StartFile(std::string const& fn);
 
+      // A write that may still be in flight: the data, which must not
+      // change until it completes, the file it goes to and the request
+      // to wait on.
+      struct PendingWrite {
+        std::vector<char> buffer;
+        net::MpiFile file;
+        MPI_Request request = MPI_REQUEST_NULL;
+      };
+
+      // Wait for the write, if any, and release its file. Collective
+      // since it may close the file.
+      void Complete(PendingWrite& write);
+
+      // For the compressed format, write the site coordinates after
+      // the headers. Collective.
+      void WriteSiteSection();
+
+      // For the compressed format, start writing one time step's
+      // record from the buffer. Collective.
+      void WriteCompressedRecord(unsigned long timestepNumber, PendingWrite& slot);
+
+      // For the HDF5 format, gather the values of each field at our
+      // sites and write them. Collective.
+      void WriteHdf5Record(unsigned long timestepNumber);
+
       // Our communicator
       const net::IOCommunicator& comms;
 
@@ -75,6 +170,38 @@ namespace hemelb
       // PropertyOutputFile spec.
       PropertyOutputFile outputSpec;
 
+      // The sites this process writes: their index in the data
+      // source and their position. Geometry selections do not change
+      // so this is worked out once, rather than running the selector
+      // over every site each time we write.
+      struct SelectedSite {
+        site_t index;
+        util::Vector3D<std::uint32_t> position;
+      };
+      std::vector<SelectedSite> selected_sites;
+
+      // When box filtering, the data source indices of this rank's
+      // sites in each block: those of block i are from box_starts[i]
+      // up to box_starts[i + 1]. The first blocks are those of the
+      // selected sites, in order; the selected site's index is the
+      // first of its block's and its position is the block's. The
+      // rest are blocks written by other ranks.
+      std::vector<std::size_t> box_starts;
+      std::vector<site_t> box_sites;
+      // A block split between ranks is written by the lowest of them.
+      // For each rank, the blocks whose sums we send to it, and the
+      // selected sites whose blocks the sums received from it are of.
+      std::vector<std::vector<std::size_t>> box_sends;
+      std::vector<std::vector<std::size_t>> box_receives;
+      // The number of sites in each selected site's block, on all ranks
+      std::vector<std::uint64_t> box_counts;
+      // The means of the fields' sources over each selected site's
+      // block, field after field, from the last ReduceBoxSamples
+      std::vector<double> box_means;
+
+      // For each field that is a statistic, its accumulator
+      std::vector<std::optional<FieldAccumulator>> accumulators;
+
       // How many local/global sites will be written
       std::uint64_t local_site_count;
       std::uint64_t global_site_count;
@@ -91,11 +218,24 @@ namespace hemelb
       // Where, in bytes, to begin writing into the file.
       std::uint64_t local_write_start;
 
-      // Buffer to serialise into before writing to disk.
-      std::vector<char> buffer;
+      // For the compressed format, where the next record begins.
+      std::uint64_t record_start = 0;
+
+      // Buffers to serialise into before writing to disk, used in turn.
+      std::vector<PendingWrite> pending_writes;
+      std::size_t next_write = 0;
+
+      std::uint64_t stall_count = 0;
+      double stall_time = 0;
 
       // The MPI file to write the offsets into.
       std::string offset_file_name;
+
+#ifdef HEMELB_USE_HDF5
+      // For the HDF5 format, the file being written. Writes are
+      // collective and complete before Write returns.
+      std::unique_ptr<Hdf5FieldWriter> hdf5_file;
+#endif
     };
   }
 }
@@ -9,6 +9,7 @@
 #include <variant>
 
 #include "Exception.h"
+#include "units.h"
 #include "io/formats/extraction.h"
 #include "util/variant.h"
 
@@ -44,6 +45,35 @@ namespace hemelb::extraction
     >;
   }
 
+  // Namespace holding tag types and variant for statistics of a
+  // source accumulated over time, instead of its current value.
+  namespace statistic {
+    // The current value
+    struct None {};
+    struct Mean {};
+    struct Variance {};
+    struct Minimum {};
+    struct Maximum {};
+    // Oscillatory shear index of a vector source (usually traction)
+    struct Osi {};
+    // Mean over each of a number of equal phases of a periodic
+    // signal (e.g. the cardiac cycle)
+    struct PhaseMean {
+      LatticeTimeStep period;
+      unsigned bins;
+    };
+
+    using Type = std::variant<
+      None,
+      Mean,
+      Variance,
+      Minimum,
+      Maximum,
+      Osi,
+      PhaseMean
+    >;
+  }
+
   // Namespace holding variant and helpers for the type to be saved to
   // the file.
   namespace code {
@@ -109,6 +139,9 @@ namespace hemelb::extraction
     // Data sources are double so do subtraction at full precision
     // before converting.
     std::vector<double> offset;
+    // Statistic written, accumulated at every time step between
+    // writes and reset after each write
+    statistic::Type statistic;
   };
 }
 
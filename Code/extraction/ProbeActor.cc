@@ -0,0 +1,314 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "extraction/ProbeActor.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "Exception.h"
+#include "extraction/PlaneGeometrySelector.h"
+#include "extraction/PropertyActor.h"
+#include "log/Logger.h"
+#include "reporting/Timers.h"
+
+namespace hemelb::extraction
+{
+    namespace
+    {
+      // Number of values of a source at each site, for the sources
+      // that probes can reduce
+      unsigned GetSampleLength(source::Type const& src)
+      {
+	return overload_visit(src,
+	  [](source::Pressure) { return 1U; },
+	  [](source::Velocity) { return 3U; },
+	  [](source::ShearStress) { return 1U; },
+	  [](source::VonMisesStress) { return 1U; },
+	  [](source::ShearRate) { return 1U; },
+	  [](source::Traction) { return 3U; },
+	  [](source::TangentialProjectionTraction) { return 3U; },
+	  [](auto) -> unsigned {
+	    throw Exception() << "Probes can only reduce scalar and vector sources";
+	  }
+	);
+      }
+
+      void ReadSample(IterableDataSource const& data, source::Type const& src,
+		      std::vector<double>& sample)
+      {
+	sample.clear();
+	overload_visit(src,
+	  [&](source::Pressure) {
+	    sample.push_back(data.GetPressure());
+	  },
+	  [&](source::Velocity) {
+	    auto&& v = data.GetVelocity();
+	    sample.insert(sample.end(), {v.x(), v.y(), v.z()});
+	  },
+	  [&](source::ShearStress) {
+	    sample.push_back(data.GetShearStress());
+	  },
+	  [&](source::VonMisesStress) {
+	    sample.push_back(data.GetVonMisesStress());
+	  },
+	  [&](source::ShearRate) {
+	    sample.push_back(data.GetShearRate());
+	  },
+	  [&](source::Traction) {
+	    auto&& t = data.GetTraction();
+	    sample.insert(sample.end(), {t.x(), t.y(), t.z()});
+	  },
+	  [&](source::TangentialProjectionTraction) {
+	    auto&& t = data.GetTangentialProjectionTraction();
+	    sample.insert(sample.end(), {t.x(), t.y(), t.z()});
+	  },
+	  [](auto) {
+	  }
+	);
+      }
+
+      bool IsDifference(ProbeQuantity const& quantity)
+      {
+	return std::holds_alternative<reduction::Difference>(quantity.reduction);
+      }
+    }
+
+    ProbeActor::ProbeActor(const lb::SimulationState& simulationState,
+			   const std::vector<ProbeFile>& probeSpecs,
+			   IterableDataSource& dataSource, reporting::Timers& timers,
+			   const net::IOCommunicator& ioComms) :
+      simulationState(simulationState), dataSource(dataSource), timers(timers), comms(ioComms)
+    {
+      // Quantities point into the specs, so the probes must not move
+      probes.reserve(probeSpecs.size());
+      for (auto const& spec: probeSpecs)
+      {
+	auto& probe = probes.emplace_back();
+	probe.spec = spec;
+	for (auto const& quantitySpec: probe.spec.quantities)
+	{
+	  auto& quantity = probe.quantities.emplace_back();
+	  quantity.spec = &quantitySpec;
+	  quantity.sampleLength = GetSampleLength(quantitySpec.src);
+
+	  auto const needsPlane = overload_visit(quantitySpec.reduction,
+	    [](reduction::Integral) { return true; },
+	    [](reduction::Flux) { return true; },
+	    [](auto const&) { return false; }
+	  );
+	  auto const plane = dynamic_cast<PlaneGeometrySelector const*>(quantitySpec.geometry.get());
+	  if (needsPlane && !plane)
+	    throw Exception() << "Probe quantity '" << quantitySpec.name << "' needs a plane geometry";
+	  if (std::holds_alternative<reduction::Flux>(quantitySpec.reduction))
+	  {
+	    if (quantity.sampleLength != 3)
+	      throw Exception() << "Probe flux '" << quantitySpec.name << "' needs a vector source";
+	    quantity.normal = plane->GetNormal().as<double>();
+	  }
+	}
+
+	// Select every quantity's sites in one pass
+	site_t index = 0;
+	dataSource.Reset();
+	while (dataSource.ReadNext())
+	{
+	  auto const position = dataSource.GetPosition();
+	  for (auto& quantity: probe.quantities)
+	  {
+	    if (quantity.spec->geometry->Include(dataSource, position))
+	      quantity.sites[0].push_back(index);
+	    if (auto diff = std::get_if<reduction::Difference>(&quantity.spec->reduction))
+	      if (diff->other->Include(dataSource, position))
+		quantity.sites[1].push_back(index);
+	  }
+	  ++index;
+	}
+
+	// Warn about empty selections, which give NaN means
+	std::vector<site_t> counts;
+	for (auto const& quantity: probe.quantities)
+	  for (auto const& sites: quantity.sites)
+	    counts.push_back(sites.size());
+	counts = comms.AllReduce(counts, MPI_SUM);
+	if (comms.OnIORank())
+	{
+	  auto count = counts.begin();
+	  for (auto const& quantity: probe.quantities)
+	  {
+	    auto const nSelections = IsDifference(*quantity.spec) ? 2 : 1;
+	    if (std::any_of(count, count + nSelections, [](site_t n) { return n == 0; }))
+	      log::Logger::Log<log::Warning, log::Singleton>("Probe quantity '%s' in %s selects no sites",
+							     quantity.spec->name.c_str(),
+							     probe.spec.filename.c_str());
+	    count += 2;
+	  }
+
+	  // Header row
+	  probe.file.open(probe.spec.filename);
+	  if (!probe.file)
+	    throw Exception() << "Could not open probe file " << probe.spec.filename;
+	  probe.file << "step,time";
+	  for (auto const& quantity: probe.quantities)
+	  {
+	    auto const& name = quantity.spec->name;
+	    auto const length = std::holds_alternative<reduction::Flux>(quantity.spec->reduction) ?
+	      1U : quantity.sampleLength;
+	    if (length == 1)
+	      probe.file << ',' << name;
+	    else
+	      probe.file << ',' << name << "_x," << name << "_y," << name << "_z";
+	  }
+	  probe.file << '\n';
+	  probe.file.precision(std::numeric_limits<double>::max_digits10);
+	}
+      }
+    }
+
+    ProbeActor::~ProbeActor()
+    {
+      try
+      {
+	Flush();
+      }
+      catch (std::exception const& e)
+      {
+	log::Logger::Log<log::Error, log::OnePerCore>("Could not complete probe output: %s", e.what());
+      }
+    }
+
+    bool ProbeActor::ShouldWrite(const LocalProbe& probe, LatticeTimeStep timestep) const
+    {
+      return timestep % probe.spec.frequency == 0;
+    }
+
+    void ProbeActor::SetRequiredProperties(lb::MacroscopicPropertyCache& propertyCache,
+                                           LatticeTimeStep timestep) const
+    {
+      for (auto const& probe: probes)
+      {
+	if (!ShouldWrite(probe, timestep))
+	  continue;
+	for (auto const& quantity: probe.quantities)
+	  SetRefreshFlag(propertyCache, quantity.spec->src);
+      }
+    }
+
+    void ProbeActor::EndIteration()
+    {
+      auto const timestep = simulationState.GetTimeStep();
+      if (std::none_of(probes.begin(), probes.end(),
+		       [&](LocalProbe const& probe) { return ShouldWrite(probe, timestep); }))
+	return;
+
+      timers[reporting::Timers::extractionWriting].Start();
+      // The previous reduction has had the whole time since to complete
+      Flush();
+
+      for (auto& probe: probes)
+      {
+	if (!ShouldWrite(probe, timestep))
+	  continue;
+	pending.push_back(&probe);
+	for (auto const& quantity: probe.quantities)
+	  AddPartials(quantity);
+      }
+      pendingStep = timestep;
+      pendingTime = simulationState.GetTime();
+
+      if (comms.OnIORank())
+	totals.resize(partials.size());
+      net::MpiCall{MPI_Ireduce}(partials.data(), totals.data(), int(partials.size()),
+				net::MpiDataType<double>(), MPI_SUM, comms.GetIORank(),
+				comms, &request);
+      timers[reporting::Timers::extractionWriting].Stop();
+    }
+
+    void ProbeActor::AddPartials(const LocalQuantity& quantity)
+    {
+      auto const flux = std::holds_alternative<reduction::Flux>(quantity.spec->reduction);
+      auto const nSelections = IsDifference(*quantity.spec) ? 2 : 1;
+      std::vector<double> sample;
+      for (int k = 0; k < nSelections; ++k)
+      {
+	// Number of sites, then the sum of each value
+	partials.push_back(quantity.sites[k].size());
+	auto const start = partials.size();
+	partials.resize(start + (flux ? 1 : quantity.sampleLength), 0.0);
+	for (auto const site: quantity.sites[k])
+	{
+	  dataSource.SetSite(site);
+	  ReadSample(dataSource, quantity.spec->src, sample);
+	  if (flux)
+	  {
+	    partials[start] += sample[0] * quantity.normal.x() + sample[1] * quantity.normal.y()
+	      + sample[2] * quantity.normal.z();
+	  }
+	  else
+	  {
+	    for (unsigned j = 0; j < quantity.sampleLength; ++j)
+	      partials[start + j] += sample[j];
+	  }
+	}
+      }
+    }
+
+    void ProbeActor::Flush()
+    {
+      if (request == MPI_REQUEST_NULL)
+	return;
+      net::MpiCall{MPI_Wait}(&request, MPI_STATUS_IGNORE);
+
+      if (comms.OnIORank())
+      {
+	double const* next = totals.data();
+	for (auto probe: pending)
+	  WriteRow(*probe, pendingStep, pendingTime, next);
+      }
+      pending.clear();
+      partials.clear();
+    }
+
+    void ProbeActor::WriteRow(LocalProbe& probe, LatticeTimeStep timestep, PhysicalTime time,
+			      const double*& next) const
+    {
+      // Plane selections are one voxel thick, so each site stands for
+      // one voxel face of area
+      auto const voxelSize = dataSource.GetVoxelSize();
+      auto const area = voxelSize * voxelSize;
+
+      probe.file << timestep << ',' << time;
+      for (auto const& quantity: probe.quantities)
+      {
+	auto const flux = std::holds_alternative<reduction::Flux>(quantity.spec->reduction);
+	auto const length = flux ? 1U : quantity.sampleLength;
+	auto const nSelections = IsDifference(*quantity.spec) ? 2 : 1;
+	std::array<double, 2> counts;
+	std::array<double const*, 2> sums;
+	for (int k = 0; k < nSelections; ++k)
+	{
+	  counts[k] = *next++;
+	  sums[k] = next;
+	  next += length;
+	}
+
+	for (unsigned j = 0; j < length; ++j)
+	{
+	  auto const value = overload_visit(quantity.spec->reduction,
+	    [&](reduction::Sum) { return sums[0][j]; },
+	    [&](reduction::Mean) { return sums[0][j] / counts[0]; },
+	    [&](reduction::Integral) { return sums[0][j] * area; },
+	    [&](reduction::Flux) { return sums[0][j] * area; },
+	    [&](reduction::Difference const&) {
+	      return sums[0][j] / counts[0] - sums[1][j] / counts[1];
+	    }
+	  );
+	  probe.file << ',' << value;
+	}
+      }
+      // Rows are small, and worth seeing while the simulation runs
+      probe.file << std::endl;
+    }
+}
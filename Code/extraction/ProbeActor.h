@@ -0,0 +1,111 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_EXTRACTION_PROBEACTOR_H
+#define HEMELB_EXTRACTION_PROBEACTOR_H
+
+#include <array>
+#include <fstream>
+#include <vector>
+
+#include "extraction/IterableDataSource.h"
+#include "extraction/ProbeFile.h"
+#include "lb/MacroscopicPropertyCache.h"
+#include "lb/SimulationState.h"
+#include "net/IOCommunicator.h"
+#include "net/IteratedAction.h"
+#include "reporting/timers_fwd.h"
+
+namespace hemelb::extraction
+{
+    /**
+     * Writes probe files: small time series of quantities reduced over
+     * selections of sites, such as the flow rate through an outlet or
+     * the pressure drop across a stenosis, instead of the fields at
+     * every site.
+     *
+     * Sites are selected once, on construction. On each output step,
+     * every rank reduces the quantities of all the files due over its
+     * own sites, and a single non-blocking reduction combines them
+     * onto the IO rank. That completes on the next output step, or on
+     * Flush, when the IO rank appends a row to each file.
+     */
+    class ProbeActor : public net::IteratedAction
+    {
+      public:
+        /**
+         * @param simulationState
+         * @param probes files to write; names are used as is
+         * @param dataSource
+         */
+        ProbeActor(const lb::SimulationState& simulationState,
+                   const std::vector<ProbeFile>& probes,
+                   IterableDataSource& dataSource, reporting::Timers& timers,
+                   const net::IOCommunicator& ioComms);
+        ProbeActor(const ProbeActor&) = delete;
+        ProbeActor& operator=(const ProbeActor&) = delete;
+        //! Completes the pending reduction, if any. Collective.
+        ~ProbeActor() override;
+
+        /**
+         * Set which properties will be required by the probes at a
+         * time step.
+         * @param propertyCache
+         * @param timestep
+         */
+        void SetRequiredProperties(lb::MacroscopicPropertyCache& propertyCache, LatticeTimeStep timestep) const;
+
+        //! Reduces the quantities of the files due this step.
+        void EndIteration() override;
+
+        //! Waits for the pending reduction, if any, and writes its rows. Collective.
+        void Flush();
+
+      private:
+        // A quantity, with the local sites of its selections
+        struct LocalQuantity
+        {
+            const ProbeQuantity* spec;
+            // Number of values of the source at each site
+            unsigned sampleLength;
+            // Only the second is used, by differences
+            std::array<std::vector<site_t>, 2> sites;
+            // Plane normal, for fluxes
+            util::Vector3D<double> normal;
+        };
+
+        struct LocalProbe
+        {
+            ProbeFile spec;
+            std::vector<LocalQuantity> quantities;
+            // Only open on the IO rank
+            std::ofstream file;
+        };
+
+        bool ShouldWrite(const LocalProbe& probe, LatticeTimeStep timestep) const;
+        //! Adds the sums over the local sites of a quantity to partials
+        void AddPartials(const LocalQuantity& quantity);
+        //! Writes a row to a probe file from the reduced sums starting at totals
+        void WriteRow(LocalProbe& probe, LatticeTimeStep timestep, PhysicalTime time,
+                      const double*& totals) const;
+
+        const lb::SimulationState& simulationState;
+        IterableDataSource& dataSource;
+        reporting::Timers& timers;
+        const net::IOCommunicator& comms;
+        std::vector<LocalProbe> probes;
+
+        // Reduction in flight: the probes it is for, and when
+        std::vector<LocalProbe*> pending;
+        LatticeTimeStep pendingStep = 0;
+        PhysicalTime pendingTime = 0;
+        // Local sums, and their totals on the IO rank. Must outlive the request.
+        std::vector<double> partials;
+        std::vector<double> totals;
+        MPI_Request request = MPI_REQUEST_NULL;
+    };
+}
+
+#endif // HEMELB_EXTRACTION_PROBEACTOR_H
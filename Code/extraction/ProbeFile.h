@@ -0,0 +1,64 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_EXTRACTION_PROBEFILE_H
+#define HEMELB_EXTRACTION_PROBEFILE_H
+
+#include <filesystem>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "util/clone_ptr.h"
+#include "extraction/GeometrySelector.h"
+#include "extraction/OutputField.h"
+
+namespace hemelb::extraction
+{
+  // Namespace holding tag types and variant for the reduction of a
+  // source over the sites of a selection.
+  namespace reduction {
+    struct Sum {};
+    struct Mean {};
+    // Integral over the area of a plane selection
+    struct Integral {};
+    // Flow rate of the velocity through a plane selection, along its
+    // normal
+    struct Flux {};
+    // Mean over the selection minus the mean over a second one,
+    // e.g. the pressure drop across a stenosis
+    struct Difference {
+      util::clone_ptr<GeometrySelector> other;
+    };
+
+    using Type = std::variant<
+      Sum,
+      Mean,
+      Integral,
+      Flux,
+      Difference
+    >;
+  }
+
+  // One column (or one per component, for vector sources) of a probe
+  // file.
+  struct ProbeQuantity
+  {
+    std::string name;
+    source::Type src;
+    util::clone_ptr<GeometrySelector> geometry;
+    reduction::Type reduction;
+  };
+
+  // A text file with a row of reduced quantities per output step.
+  struct ProbeFile
+  {
+    std::filesystem::path filename;
+    unsigned long frequency;
+    std::vector<ProbeQuantity> quantities;
+  };
+}
+
+#endif // HEMELB_EXTRACTION_PROBEFILE_H
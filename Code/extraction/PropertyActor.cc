@@ -4,10 +4,48 @@
 // license in the file LICENSE.
 
 #include "extraction/PropertyActor.h"
+#include "log/Logger.h"
 #include "reporting/Timers.h"
 
 namespace hemelb::extraction
 {
+    void SetRefreshFlag(lb::MacroscopicPropertyCache& propertyCache, source::Type const& src)
+    {
+        overload_visit(
+                src,
+                [&](source::Pressure) {
+                    propertyCache.densityCache.SetRefreshFlag();
+                },
+                [&](source::Velocity) {
+                    propertyCache.velocityCache.SetRefreshFlag();
+                },
+                [&](source::ShearStress) {
+                    propertyCache.wallShearStressMagnitudeCache.SetRefreshFlag();
+                },
+                [&](source::VonMisesStress) {
+                    propertyCache.vonMisesStressCache.SetRefreshFlag();
+                },
+                [&](source::ShearRate) {
+                    propertyCache.shearRateCache.SetRefreshFlag();
+                },
+                [&](source::StressTensor) {
+                    propertyCache.stressTensorCache.SetRefreshFlag();
+                },
+                [&](source::Traction) {
+                    propertyCache.tractionCache.SetRefreshFlag();
+                },
+                [&](source::TangentialProjectionTraction) {
+                    propertyCache.tangentialProjectionTractionCache.SetRefreshFlag();
+                },
+                [](source::Distributions) {
+                    // We don't actually have to cache anything to get the distribution.
+                },
+                [](source::MpiRank) {
+                    // We don't actually have to cache anything to get the rank.
+                }
+        );
+    }
+
     PropertyActor::PropertyActor(const lb::SimulationState& simulationState,
                                  const std::vector<PropertyOutputFile>& propertyOutputs,
                                  IterableDataSource& dataSource, reporting::Timers& timers,
@@ -17,9 +55,17 @@ namespace hemelb::extraction
       propertyWriter = std::make_unique<PropertyWriter>(dataSource, propertyOutputs, ioComms);
     }
 
-    PropertyActor::~PropertyActor() = default;
+    PropertyActor::~PropertyActor()
+    {
+      if (auto const stalls = propertyWriter->GetStallCount())
+      {
+        log::Logger::Log<log::Info, log::OnePerCore>("Extraction waited %lu times for earlier output to be written",
+                                                     (unsigned long) stalls);
+      }
+    }
 
-    void PropertyActor::SetRequiredProperties(lb::MacroscopicPropertyCache& propertyCache)
+    void PropertyActor::SetRequiredProperties(lb::MacroscopicPropertyCache& propertyCache,
+                                              LatticeTimeStep timestep)
     {
         const std::vector<LocalPropertyOutput*>& propertyOutputs =
                 propertyWriter->GetPropertyOutputs();
@@ -27,48 +73,21 @@ namespace hemelb::extraction
         // Iterate over each property output spec.
         for (auto propertyOutput : propertyOutputs)
         {
-            // Only consider the ones that are being written this iteration.
-            if (propertyOutput->ShouldWrite(simulationState.GetTimeStep()))
+            // Only consider the ones that are being written this
+            // iteration, or that accumulate statistics.
+            auto const writing = propertyOutput->ShouldWrite(timestep);
+            if (writing || propertyOutput->HasStatistics())
             {
                 auto& outputFile = propertyOutput->GetOutputSpec();
 
                 // Iterate over each field.
                 for (auto&& fieldSpec: outputFile.fields)
                 {
-                    // Set the cache to calculate each required field.
-                    overload_visit(
-                            fieldSpec.src,
-                            [&](source::Pressure) {
-                                propertyCache.densityCache.SetRefreshFlag();
-                            },
-                            [&](source::Velocity) {
-                                propertyCache.velocityCache.SetRefreshFlag();
-                            },
-                            [&](source::ShearStress) {
-                                propertyCache.wallShearStressMagnitudeCache.SetRefreshFlag();
-                            },
-                            [&](source::VonMisesStress) {
-                                propertyCache.vonMisesStressCache.SetRefreshFlag();
-                            },
-                            [&](source::ShearRate) {
-                                propertyCache.shearRateCache.SetRefreshFlag();
-                            },
-                            [&](source::StressTensor) {
-                                propertyCache.stressTensorCache.SetRefreshFlag();
-                            },
-                            [&](source::Traction) {
-                                propertyCache.tractionCache.SetRefreshFlag();
-                            },
-                            [&](source::TangentialProjectionTraction) {
-                                propertyCache.tangentialProjectionTractionCache.SetRefreshFlag();
-                            },
-                            [](source::Distributions) {
-                                // We don't actually have to cache anything to get the distribution.
-                            },
-                            [](source::MpiRank) {
-                                // We don't actually have to cache anything to get the rank.
-                            }
-                    );
+                    if (!writing && std::holds_alternative<statistic::None>(fieldSpec.statistic))
+                    {
+                        continue;
+                    }
+                    SetRefreshFlag(propertyCache, fieldSpec.src);
 
                 }
             }
@@ -80,6 +99,8 @@ namespace hemelb::extraction
       timers[reporting::Timers::extractionWriting].Start();
       propertyWriter->Write(simulationState.GetTimeStep(), simulationState.GetTotalTimeSteps());
       timers[reporting::Timers::extractionWriting].Stop();
+      // Part of the writing time, when the file system cannot keep up
+      timers[reporting::Timers::extractionWaiting].Set(propertyWriter->GetStallTime());
     }
 
 }
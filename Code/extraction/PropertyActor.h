@@ -15,6 +15,13 @@
 
 namespace hemelb::extraction
 {
+    /**
+     * Set the cache to calculate a source.
+     * @param propertyCache
+     * @param src
+     */
+    void SetRefreshFlag(lb::MacroscopicPropertyCache& propertyCache, source::Type const& src);
+
     class PropertyActor : public net::IteratedAction
     {
       public:
@@ -33,10 +40,12 @@ namespace hemelb::extraction
         ~PropertyActor() override;
 
         /**
-         * Set which properties will be required this iteration.
+         * Set which properties will be required by the outputs at a
+         * time step.
          * @param propertyCache
+         * @param timestep
          */
-        void SetRequiredProperties(lb::MacroscopicPropertyCache& propertyCache);
+        void SetRequiredProperties(lb::MacroscopicPropertyCache& propertyCache, LatticeTimeStep timestep);
 
         /**
          * Override the iterated actor end of iteration method to perform writing.
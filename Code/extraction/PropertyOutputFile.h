@@ -24,6 +24,53 @@ namespace hemelb::extraction
   // is the old behaviour).
   using file_timestep_mode = std::variant<multi_timestep_file, single_timestep_files>;
 
+  // Tag types for compression. Compressed files are written in the
+  // compressed extraction format (see io/formats/extraction.h).
+  struct no_compression {};
+  struct lossless_compression {};
+  struct lossy_compression {
+    // Absolute error bound on floating point values, in output units
+    double tolerance;
+  };
+
+  // Uncompressed first so it will be default.
+  using compression_mode = std::variant<no_compression, lossless_compression, lossy_compression>;
+
+  // Tag types for the file format.
+  struct xtr_format {};
+  // HDF5 files, see extraction/Hdf5FieldWriter.h. Only available
+  // when built with HEMELB_USE_HDF5.
+  struct hdf5_format {
+    // Number of sites per chunk of a field's dataset; zero picks
+    // chunks of about a MiB
+    unsigned chunk_sites = 0;
+    // Deflate compression level, from 0 (none) to 9
+    unsigned deflate = 0;
+  };
+
+  // XTR first so it will be default.
+  using output_format = std::variant<xtr_format, hdf5_format>;
+
+  // Tag types for the grid the fields are written on. Coarser grids
+  // are a whole factor larger than the lattice in each direction:
+  // sites are written at their coordinates on that grid and the
+  // voxel size in the header is scaled to match.
+  struct full_grid {};
+  // Only the lattice sites whose coordinates are all multiples of
+  // the factor.
+  struct subsampled_grid {
+    unsigned factor;
+  };
+  // The mean of the selected sites in each block of factor^3 lattice
+  // sites. A block split between ranks is written once, by the lowest
+  // of them, with the mean over all its sites.
+  struct box_filtered_grid {
+    unsigned factor;
+  };
+
+  // Full first so it will be default.
+  using output_grid = std::variant<full_grid, subsampled_grid, box_filtered_grid>;
+
   struct PropertyOutputFile
   {
     std::filesystem::path filename;
@@ -31,6 +78,13 @@ namespace hemelb::extraction
     util::clone_ptr<GeometrySelector> geometry;
     std::vector<OutputField> fields;
     file_timestep_mode ts_mode;
+    compression_mode compression;
+    output_format format;
+    output_grid grid;
+    // How many output steps may still be being written while the
+    // simulation carries on. Zero means every write completes before
+    // the simulation continues.
+    unsigned queue_depth = 2;
   };
 }
 
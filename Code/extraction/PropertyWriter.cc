@@ -41,5 +41,33 @@ namespace hemelb
         localPropertyOutputs[outputNumber]->Write((uint64_t) iterationNumber, totalSteps);
       }
     }
+
+    void PropertyWriter::Flush() const
+    {
+      for (auto output : localPropertyOutputs)
+      {
+        output->Flush();
+      }
+    }
+
+    std::uint64_t PropertyWriter::GetStallCount() const
+    {
+      std::uint64_t count = 0;
+      for (auto output : localPropertyOutputs)
+      {
+        count += output->GetStallCount();
+      }
+      return count;
+    }
+
+    double PropertyWriter::GetStallTime() const
+    {
+      double time = 0;
+      for (auto output : localPropertyOutputs)
+      {
+        time += output->GetStallTime();
+      }
+      return time;
+    }
   }
 }
@@ -40,6 +40,19 @@ namespace hemelb
          */
         void Write(unsigned long iterationNumber, unsigned long totalSteps) const;
 
+        /**
+         * Waits for all the writes still in flight. Collective.
+         */
+        void Flush() const;
+
+        /**
+         * Total number of times, and time in seconds, that writes had to
+         * wait for earlier writes to complete.
+         * @return
+         */
+        std::uint64_t GetStallCount() const;
+        double GetStallTime() const;
+
         /**
          * Returns a vector of all the LocalPropertyOutputs.
          * @return
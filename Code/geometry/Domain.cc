@@ -3,6 +3,12 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 
+#include <algorithm>
+#include <bit>
+#include <numeric>
+#include <optional>
+#include <unordered_map>
+
 #include "log/Logger.h"
 #include "geometry/BlockTraverser.h"
 #include "geometry/Domain.h"
@@ -19,6 +25,7 @@ namespace hemelb::geometry
                        const net::IOCommunicator& comms_) :
                 latticeInfo(latticeInfo),
                 shared_counts(comms_, 0),
+                noWallDistances(latticeInfo.GetNumVectors() - 1, -1.0),
                 neighbouringData(new neighbouring::NeighbouringDomain(latticeInfo)), comms(comms_)
         {
         }
@@ -26,6 +33,7 @@ namespace hemelb::geometry
         Domain::Domain(const lb::LatticeInfo& latticeInfo,
                        GmyReadResult& readResult, const net::IOCommunicator& comms_) :
                 latticeInfo(latticeInfo), shared_counts(comms_, 0),
+                noWallDistances(latticeInfo.GetNumVectors() - 1, -1.0),
                 neighbouringData(new neighbouring::NeighbouringDomain(latticeInfo)),
                 rank_for_site_store(std::move(readResult.block_store)),
                 comms(comms_)
@@ -59,6 +67,9 @@ namespace hemelb::geometry
 
         void Domain::SetBasicDetails(Vec16 blocksIn, U16 blockSizeIn)
         {
+            // Site offsets in blocks are stored in a byte
+            if (blockSizeIn > 256)
+                throw Exception() << "Blocks of " << blockSizeIn << " sites a side are too large; at most 256 are supported";
             blockCounts = blocksIn;
             blockSize = blockSizeIn;
             sites = blocksIn.as<site_t>() * blockSize;
@@ -309,25 +320,45 @@ namespace hemelb::geometry
             // Data about local sites.
             SiteRankIndex rank_index = {comms.Rank(), 0};
             auto& localFluidSites = rank_index[1];
+            auto const numDistances = latticeInfo.GetNumVectors() - 1;
+            auto add_site = [&](SiteData const& data, util::Vector3D<float> const& normal,
+                                float const* distances, site_t blockId, site_t siteId) {
+                siteData.push_back(data);
+                wallDataRows.push_back(NO_WALL_DATA);
+                // Only keep the wall data of sites that have some
+                bool const hasNormal = normal != util::Vector3D<float>(NO_VALUE);
+                bool const hasCut = std::any_of(distances, distances + numDistances,
+                                                [](float d) { return d != -1.0f; });
+                if (hasNormal || hasCut)
+                {
+                    auto const row = AddWallData(localFluidSites);
+                    std::copy(distances, distances + numDistances, &wallDistances[row * numDistances]);
+                    wallNormals[row] = normal.as<distribn_t>();
+                }
+
+                blocks[blockId].SetLocalContiguousIndexForSite(siteId, localFluidSites);
+                auto const global = GetGlobalCoords(blockId, GetSiteCoordsFromSiteId(siteId));
+                auto const block = global / site_t(blockSize);
+                auto const offset = global - block * site_t(blockSize);
+                globalSiteCoords.push_back({block.as<U16>(),
+                                            {std::uint8_t(offset.x()), std::uint8_t(offset.y()), std::uint8_t(offset.z())}});
+                write_my_sites(blockId)(siteId) = rank_index;
+                localFluidSites++;
+            };
             // Data about contiguous local sites. First midDomain stuff, then domainEdge.
+            // Bulk sites in direct blocks come first of all.
+            auto const bulkOrder = OrderDirectBlocks(midDomainBlockNumbers[0], midDomainSiteNumbers[0]);
             for (unsigned collisionType = 0; collisionType < COLLISION_TYPES; collisionType++)
             {
                 for (unsigned indexInType = 0; indexInType < GetMidDomainCollisionCount(collisionType);
                      indexInType++)
                 {
-                    siteData.push_back(midDomainSiteData[collisionType][indexInType]);
-                    wallNormalAtSite.emplace_back(midDomainWallNormals[collisionType][indexInType]);
-                    for (Direction direction = 1; direction < latticeInfo.GetNumVectors(); direction++)
-                    {
-                        distanceToWall.push_back(midDomainWallDistance[collisionType][indexInType
-                                                                                      * (latticeInfo.GetNumVectors() - 1) + direction - 1]);
-                    }
-                    site_t blockId = midDomainBlockNumbers[collisionType][indexInType];
-                    site_t siteId = midDomainSiteNumbers[collisionType][indexInType];
-                    blocks[blockId].SetLocalContiguousIndexForSite(siteId, localFluidSites);
-                    globalSiteCoords.push_back(GetGlobalCoords(blockId, GetSiteCoordsFromSiteId(siteId)));
-                    write_my_sites(blockId)(siteId) = rank_index;
-                    localFluidSites++;
+                    auto const i = collisionType == 0 ? bulkOrder[indexInType] : site_t(indexInType);
+                    add_site(midDomainSiteData[collisionType][i],
+                             midDomainWallNormals[collisionType][i],
+                             &midDomainWallDistance[collisionType][i * (latticeInfo.GetNumVectors() - 1)],
+                             midDomainBlockNumbers[collisionType][i],
+                             midDomainSiteNumbers[collisionType][i]);
                 }
 
             }
@@ -337,23 +368,120 @@ namespace hemelb::geometry
                 for (unsigned indexInType = 0; indexInType < GetDomainEdgeCollisionCount(collisionType);
                      indexInType++)
                 {
-                    siteData.push_back(domainEdgeSiteData[collisionType][indexInType]);
-                    wallNormalAtSite.emplace_back(domainEdgeWallNormals[collisionType][indexInType]);
-                    for (Direction direction = 1; direction < latticeInfo.GetNumVectors(); direction++)
-                    {
-                        distanceToWall.push_back(domainEdgeWallDistance[collisionType][indexInType
-                                                                                       * (latticeInfo.GetNumVectors() - 1) + direction - 1]);
-                    }
-                    site_t blockId = domainEdgeBlockNumbers[collisionType][indexInType];
-                    site_t siteId = domainEdgeSiteNumbers[collisionType][indexInType];
-                    blocks[blockId].SetLocalContiguousIndexForSite(siteId, localFluidSites);
-                    globalSiteCoords.push_back(GetGlobalCoords(blockId, GetSiteCoordsFromSiteId(siteId)));
-                    write_my_sites(blockId)(siteId) = rank_index;
-                    localFluidSites++;
+                    add_site(domainEdgeSiteData[collisionType][indexInType],
+                             domainEdgeWallNormals[collisionType][indexInType],
+                             &domainEdgeWallDistance[collisionType][indexInType * (latticeInfo.GetNumVectors() - 1)],
+                             domainEdgeBlockNumbers[collisionType][indexInType],
+                             domainEdgeSiteNumbers[collisionType][indexInType]);
                 }
 
             }
             LocalFluidSiteCount() = localFluidSites;
+            log::Logger::Log<log::Debug, log::OnePerCore>("Stored wall data for %lu of %lu sites",
+                                                          (unsigned long) wallNormals.size(), (unsigned long) localFluidSites);
+        }
+
+        std::vector<site_t> Domain::OrderDirectBlocks(const std::vector<site_t>& blockNumbers,
+                                                      const std::vector<site_t>& siteNumbers)
+        {
+            // Direct sites find their neighbours with shifts and masks,
+            // which needs a power of two block size
+            auto const directBlocks = std::has_single_bit(unsigned(blockSize));
+            directBlockShift = std::countr_zero(unsigned(blockSize));
+            directStrides.clear();
+            for (Direction direction = 0; direction < latticeInfo.GetNumVectors(); ++direction)
+            {
+                auto const& vector = latticeInfo.GetVector(direction);
+                directStrides.push_back((site_t(vector.x()) * blockSize + vector.y()) * blockSize + vector.z());
+            }
+
+            // Fully fluid blocks are those all of whose sites are
+            // mid-domain bulk sites, so on this rank with fluid neighbours
+            std::unordered_map<site_t, site_t> bulkSitesInBlock;
+            for (auto block: blockNumbers)
+                ++bulkSitesInBlock[block];
+            std::vector<site_t> fullBlocks;
+            for (auto [block, count]: bulkSitesInBlock)
+                if (count == sitesPerBlockVolumeUnit)
+                    fullBlocks.push_back(block);
+            std::sort(fullBlocks.begin(), fullBlocks.end());
+
+            std::unordered_map<site_t, site_t> fullBlockAtCoords;
+            for (auto block: fullBlocks)
+                fullBlockAtCoords[GetBlockGmyIdxFromBlockCoords(GetBlockIJK(block))] = block;
+
+            // A direct block needs all the blocks around it to be fully fluid
+            auto surrounding = [&](site_t block) {
+                std::array<site_t, 27> ans;
+                auto const centre = GetBlockIJK(block).as<int>();
+                int n = 0;
+                for (int i = -1; i <= 1; ++i)
+                    for (int j = -1; j <= 1; ++j)
+                        for (int k = -1; k <= 1; ++k, ++n)
+                        {
+                            auto const coords = centre + util::Vector3D<int>(i, j, k);
+                            if (!IsValidBlock(coords.x(), coords.y(), coords.z()))
+                                return std::optional<std::array<site_t, 27>>();
+                            auto const found = fullBlockAtCoords.find(GetBlockGmyIdxFromBlockCoords(coords.as<U16>()));
+                            if (found == fullBlockAtCoords.end())
+                                return std::optional<std::array<site_t, 27>>();
+                            ans[n] = found->second;
+                        }
+                return std::optional<std::array<site_t, 27>>(ans);
+            };
+
+            // Direct blocks, then the other fully fluid ones
+            std::unordered_map<site_t, site_t> blockPosition;
+            std::vector<std::array<site_t, 27>> directNeighbourBlocks;
+            for (auto block: fullBlocks)
+                if (auto const around = directBlocks ? surrounding(block) : std::nullopt)
+                {
+                    blockPosition.emplace(block, site_t(blockPosition.size()));
+                    directNeighbourBlocks.push_back(*around);
+                }
+            directSiteCount = site_t(blockPosition.size()) * sitesPerBlockVolumeUnit;
+            for (auto block: fullBlocks)
+                if (!blockPosition.contains(block))
+                    blockPosition.emplace(block, site_t(blockPosition.size()));
+
+            directBlockNeighbours.clear();
+            for (auto const& around: directNeighbourBlocks)
+            {
+                auto& firstSites = directBlockNeighbours.emplace_back();
+                for (int n = 0; n < 27; ++n)
+                    firstSites[n] = blockPosition.at(around[n]) * sitesPerBlockVolumeUnit;
+            }
+
+            // The remaining sites keep the order they were read in
+            std::vector<std::pair<site_t, site_t>> keys(blockNumbers.size());
+            for (std::size_t i = 0; i < keys.size(); ++i)
+            {
+                auto const found = blockPosition.find(blockNumbers[i]);
+                keys[i] = found == blockPosition.end() ? std::make_pair(site_t(blockPosition.size()), site_t(0))
+                    : std::make_pair(found->second, siteNumbers[i]);
+            }
+            std::vector<site_t> order(blockNumbers.size());
+            std::iota(order.begin(), order.end(), site_t(0));
+            std::stable_sort(order.begin(), order.end(), [&](site_t a, site_t b) {
+                return keys[a] < keys[b];
+            });
+            log::Logger::Log<log::Debug, log::OnePerCore>("%lu of %lu bulk sites are in direct blocks",
+                                                          (unsigned long) directSiteCount,
+                                                          (unsigned long) blockNumbers.size());
+            return order;
+        }
+
+        site_t Domain::AddWallData(site_t siteIndex)
+        {
+            if (auto const row = GetWallDataRow(siteIndex); row >= 0)
+                return row;
+            auto const row = wallNormals.size();
+            if (row >= NO_WALL_DATA)
+                throw Exception() << "Too many sites with wall data";
+            wallDataRows[siteIndex] = std::uint32_t(row);
+            wallDistances.insert(wallDistances.end(), noWallDistances.begin(), noWallDistances.end());
+            wallNormals.push_back(noWallNormal);
+            return row;
         }
 
         void Domain::CollectFluidSiteDistribution()
@@ -426,7 +554,16 @@ namespace hemelb::geometry
         {
             proc2neighdata ans;
             const proc_t localRank = comms.Rank();
-            neighbourIndices.resize(latticeInfo.GetNumVectors() * GetLocalFluidSiteCount());
+            // Only sites outside direct blocks have rows, but the
+            // largest index stored is that of the last shared
+            // distribution, after all the local ones and the rubbish site
+            auto const numIndices = latticeInfo.GetNumVectors() * (GetLocalFluidSiteCount() - directSiteCount);
+            auto const largestIndex = latticeInfo.GetNumVectors() * GetLocalFluidSiteCount() + totalSharedFs;
+            narrowNeighbourIndices = largestIndex <= site_t(std::numeric_limits<std::uint32_t>::max());
+            if (narrowNeighbourIndices)
+                neighbourIndices32.resize(numIndices);
+            else
+                neighbourIndices.resize(numIndices);
             for (auto leaf: rank_for_site_store->GetTree().IterLeaves()) {
                 auto const& map_block_p = blocks[leaf.index()];
                 if (map_block_p.IsEmpty())
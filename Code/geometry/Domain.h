@@ -6,6 +6,9 @@
 #ifndef HEMELB_GEOMETRY_DOMAIN_H
 #define HEMELB_GEOMETRY_DOMAIN_H
 
+#include <array>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <map>
 #include <vector>
@@ -182,6 +185,19 @@ namespace hemelb::geometry
           return shared_counts.Span()[2 * COLLISION_TYPES];
         }
 
+        /**
+         * Get the number of sites, from the first, that are in direct
+         * blocks: fully fluid blocks of mid-domain bulk sites, all of
+         * whose neighbouring blocks are fully fluid too, when the block
+         * size is a power of two. Their sites are stored block by block
+         * in site id order, so neighbours are found from the
+         * coordinates in the block, without the neighbour index table.
+         */
+        inline site_t GetDirectSiteCount() const
+        {
+          return directSiteCount;
+        }
+
         site_t GetContiguousSiteId(util::Vector3D<site_t> location) const;
         site_t GetContiguousSiteId(site_t x, site_t y, site_t z) const
         {
@@ -367,6 +383,17 @@ namespace hemelb::geometry
             const std::vector<util::Vector3D<float> > domainEdgeWallNormals[COLLISION_TYPES],
             const std::vector<float> domainEdgeWallDistance[COLLISION_TYPES]);
 
+        /**
+         * Find the direct blocks among the mid-domain bulk sites and
+         * order those sites so that the direct blocks come first,
+         * then the other fully fluid blocks, each in site id order.
+         * @param blockNumbers blocks of the mid-domain bulk sites
+         * @param siteNumbers site ids of the mid-domain bulk sites
+         * @return indices of the sites, in the order to store them
+         */
+        std::vector<site_t> OrderDirectBlocks(const std::vector<site_t>& blockNumbers,
+                                              const std::vector<site_t>& siteNumbers);
+
         void CollectFluidSiteDistribution();
         void CollectGlobalSiteExtrema();
 
@@ -396,7 +423,30 @@ namespace hemelb::geometry
         inline void SetNeighbourLocation(const site_t siteIndex, const unsigned int direction,
                                          const site_t distributionIndex)
         {
-          neighbourIndices[siteIndex * latticeInfo.GetNumVectors() + direction] = distributionIndex;
+          // Sites in direct blocks find their neighbours without the table
+          if (siteIndex < directSiteCount)
+            return;
+          auto const i = (siteIndex - directSiteCount) * latticeInfo.GetNumVectors() + direction;
+          if (narrowNeighbourIndices)
+            neighbourIndices32[i] = std::uint32_t(distributionIndex);
+          else
+            neighbourIndices[i] = distributionIndex;
+        }
+
+        /**
+         * Get the row of the site's wall data (cut distances and
+         * normal), adding one if it has none. Only sites with a cut
+         * link or a wall normal have one.
+         * @param siteIndex
+         * @return
+         */
+        site_t AddWallData(site_t siteIndex);
+
+        //! Row of the site's wall data, or -1 if it has none
+        inline site_t GetWallDataRow(site_t siteIndex) const
+        {
+          auto const row = wallDataRows[siteIndex];
+          return row == NO_WALL_DATA ? -1 : site_t(row);
         }
 
         Vec16 GetBlockIJK(site_t block) const;
@@ -405,7 +455,7 @@ namespace hemelb::geometry
         template<typename LatticeType>
         double GetCutDistance(site_t iSiteIndex, int iDirection) const
         {
-          return distanceToWall[iSiteIndex * (LatticeType::NUMVECTORS - 1) + iDirection - 1];
+          return GetCutDistances(iSiteIndex)[iDirection - 1];
         }
 
         /**
@@ -416,7 +466,8 @@ namespace hemelb::geometry
         // Method should remain protected, intent is to access this information via Site
         inline const util::Vector3D<distribn_t>& GetNormalToWall(site_t iSiteIndex) const
         {
-          return wallNormalAtSite[iSiteIndex];
+          auto const row = GetWallDataRow(iSiteIndex);
+          return row < 0 ? noWallNormal : wallNormals[row];
         }
 
 
@@ -430,7 +481,39 @@ namespace hemelb::geometry
         template<typename LatticeType>
         site_t GetStreamedIndex(site_t iSiteIndex, unsigned int iDirectionIndex) const
         {
-          return neighbourIndices[iSiteIndex * LatticeType::NUMVECTORS + iDirectionIndex];
+          if (iSiteIndex < directSiteCount)
+            return GetDirectNeighbour(iSiteIndex, iDirectionIndex, LatticeType::VECTORS[iDirectionIndex])
+              * LatticeType::NUMVECTORS + iDirectionIndex;
+          auto const i = (iSiteIndex - directSiteCount) * LatticeType::NUMVECTORS + iDirectionIndex;
+          return narrowNeighbourIndices ? site_t(neighbourIndices32[i]) : neighbourIndices[i];
+        }
+
+        /**
+         * Get the index of a neighbour of a site in a direct block.
+         * Within the block, this is a fixed stride from the site.
+         * Direct blocks have a power of two size, so the site's
+         * coordinates in its block are found by shifts and masks.
+         * @param siteIndex
+         * @param direction
+         * @param vector lattice vector to the neighbour
+         * @return
+         */
+        inline site_t GetDirectNeighbour(site_t siteIndex, Direction direction,
+                                         const util::Vector3D<int>& vector) const
+        {
+          auto const shift = directBlockShift;
+          site_t const mask = (site_t(1) << shift) - 1;
+          auto const block = siteIndex >> (3 * shift);
+          site_t const x = ((siteIndex >> (2 * shift)) & mask) + vector.x();
+          site_t const y = ((siteIndex >> shift) & mask) + vector.y();
+          site_t const z = (siteIndex & mask) + vector.z();
+          // Which neighbouring block the neighbour is in: each
+          // coordinate shifts down to -1, 0 or 1
+          auto const neighbourBlock = ((x >> shift) * 3 + (y >> shift)) * 3 + (z >> shift) + DIRECT_SAME_BLOCK;
+          if (neighbourBlock == DIRECT_SAME_BLOCK)
+            return siteIndex + directStrides[direction];
+          return directBlockNeighbours[block][neighbourBlock]
+            + ((((x & mask) << shift) | (y & mask)) << shift | (z & mask));
         }
 
         /**
@@ -456,32 +539,25 @@ namespace hemelb::geometry
           return siteData[iSiteIndex];
         }
 
-        // Method should remain protected, intent is to access this information via Site
+        // Method should remain protected, intent is to access this information via Site.
+        // Sites without wall data share a row with no cut links.
         const distribn_t * GetCutDistances(site_t iSiteIndex) const
         {
-          return &distanceToWall[iSiteIndex * (latticeInfo.GetNumVectors() - 1)];
+          auto const row = GetWallDataRow(iSiteIndex);
+          return row < 0 ? noWallDistances.data()
+            : &wallDistances[row * (latticeInfo.GetNumVectors() - 1)];
         }
 
-        distribn_t * GetCutDistances(site_t iSiteIndex)
-        {
-          return &distanceToWall[iSiteIndex * (latticeInfo.GetNumVectors() - 1)];
-        }
-
-        // Method should remain protected, intent is to access this information via Site
-        util::Vector3D<distribn_t>& GetNormalToWall(site_t iSiteIndex)
-        {
-          return wallNormalAtSite[iSiteIndex];
-        }
-
-
         /**
          * Get the global site coordinates from a contiguous site id.
          * @param siteIndex
          * @return
          */
-        inline const util::Vector3D<site_t>& GetGlobalSiteCoords(site_t siteIndex) const
+        inline util::Vector3D<site_t> GetGlobalSiteCoords(site_t siteIndex) const
         {
-          return globalSiteCoords[siteIndex];
+          auto const& packed = globalSiteCoords[siteIndex];
+          return packed.block.as<site_t>() * site_t(blockSize)
+            + util::Vector3D<site_t>(packed.offset[0], packed.offset[1], packed.offset[2]);
         }
 
         // Variables are listed here in approximate order of initialisation.
@@ -516,14 +592,47 @@ namespace hemelb::geometry
 
         std::vector<Block> blocks; //! Data where local fluid sites are stored contiguously - hold only blocks with fluid sites in octree order
 
-        std::vector<distribn_t> distanceToWall; //! Hold the distance to the wall for each fluid site.
-        std::vector<util::Vector3D<site_t> > globalSiteCoords; //! Hold the global site coordinates for each contiguous site.
-        std::vector<util::Vector3D<distribn_t> > wallNormalAtSite; //! Holds the wall normal near the fluid site, where appropriate
+        // Global site coordinates, packed as those of the site's block
+        // and its offset in the block, which needs blocks of at most
+        // 256 sites a side.
+        struct PackedSiteCoords
+        {
+            Vec16 block;
+            std::array<std::uint8_t, 3> offset;
+        };
+        static constexpr std::uint32_t NO_WALL_DATA = std::numeric_limits<std::uint32_t>::max();
+
+        // Wall data is only stored for the sites that have any, which
+        // are few away from walls and iolets: each site has a row, or
+        // NO_WALL_DATA, in the tables of cut distances (Q - 1 per row)
+        // and wall normals.
+        std::vector<std::uint32_t> wallDataRows;
+        std::vector<distribn_t> wallDistances; //! Hold the distance to the wall for each fluid site with wall data.
+        std::vector<util::Vector3D<distribn_t> > wallNormals; //! Holds the wall normal near each fluid site with wall data.
+        std::vector<distribn_t> noWallDistances; //! The cut distances of sites without wall data
+        util::Vector3D<distribn_t> noWallNormal = util::Vector3D<distribn_t>(NO_VALUE);
+        std::vector<PackedSiteCoords> globalSiteCoords; //! Hold the global site coordinates for each contiguous site.
         std::vector<SiteData> siteData; //! Holds the SiteData for each site.
         std::vector<site_t> fluidSitesOnEachProcessor; //! Array containing numbers of fluid sites on each processor.
         site_t totalFluidSites; //! The total number of fluid sites in the geometry.
         util::Vector3D<site_t> globalSiteMins, globalSiteMaxes; //! The minimal and maximal coordinates of any fluid sites.
-        std::vector<site_t> neighbourIndices; //! Data about neighbouring fluid sites.
+        // Index of the distribution each site streams to in each
+        // direction: 32 bits wide when this rank's distributions allow.
+        bool narrowNeighbourIndices = false;
+        std::vector<std::uint32_t> neighbourIndices32;
+        std::vector<site_t> neighbourIndices; //! Only for sites from directSiteCount on
+        // Sites in direct blocks come first, see GetDirectSiteCount
+        site_t directSiteCount = 0;
+        // Base 2 logarithm of the block size, when there are direct
+        // blocks, and the difference in site index to the neighbour in
+        // each direction within one
+        unsigned directBlockShift = 0;
+        std::vector<site_t> directStrides;
+        // For each direct block, the first site of each of the 3^3
+        // blocks around it, indexed by (9 * dx + 3 * dy + dz) with
+        // offsets d + 1
+        std::vector<std::array<site_t, 27>> directBlockNeighbours;
+        static constexpr int DIRECT_SAME_BLOCK = 13;
         std::vector<site_t> streamingIndicesForReceivedDistributions; //! The indices to stream to for distributions received from other processors.
         std::shared_ptr<neighbouring::NeighbouringDomain> neighbouringData;
         std::unique_ptr<octree::DistributedStore> rank_for_site_store;
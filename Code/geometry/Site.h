@@ -231,7 +231,7 @@ namespace hemelb::geometry
           return m_domain->GetSiteData(index);
         }
 
-        const LatticeVector& GetGlobalSiteCoords() const
+        LatticeVector GetGlobalSiteCoords() const
         {
           return m_domain->GetGlobalSiteCoords(index);
         }
@@ -0,0 +1,33 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "io/Compression.h"
+
+#include <zlib.h>
+
+#include "Exception.h"
+
+namespace hemelb::io {
+    std::vector<char> Deflate(std::span<char const> data, int level) {
+        auto length = compressBound(data.size());
+        std::vector<char> compressed(length);
+        auto const ret = compress2(reinterpret_cast<Bytef*>(compressed.data()), &length,
+                                   reinterpret_cast<Bytef const*>(data.data()), data.size(), level);
+        if (ret != Z_OK)
+            throw Exception() << "Compression error " << ret;
+        compressed.resize(length);
+        return compressed;
+    }
+
+    std::vector<char> Inflate(std::span<char const> compressed, std::size_t uncompressedLength) {
+        std::vector<char> uncompressed(uncompressedLength);
+        uLongf length = uncompressed.size();
+        auto const ret = uncompress(reinterpret_cast<Bytef*>(uncompressed.data()), &length,
+                                    reinterpret_cast<Bytef const*>(compressed.data()), compressed.size());
+        if (ret != Z_OK || length != uncompressedLength)
+            throw Exception() << "Decompression error " << ret;
+        return uncompressed;
+    }
+}
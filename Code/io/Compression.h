@@ -0,0 +1,21 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_IO_COMPRESSION_H
+#define HEMELB_IO_COMPRESSION_H
+
+#include <span>
+#include <vector>
+
+namespace hemelb::io {
+    // Compress with zlib's deflate, in the zlib format (as Python's
+    // zlib.compress), at zlib's compression level: from 1 (fastest) to 9
+    // (smallest), with -1 for zlib's default.
+    std::vector<char> Deflate(std::span<char const> data, int level = -1);
+
+    // Decompress zlib format data, whose uncompressed length is known.
+    std::vector<char> Inflate(std::span<char const> compressed, std::size_t uncompressedLength);
+}
+#endif
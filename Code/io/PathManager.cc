@@ -52,6 +52,11 @@ namespace hemelb::io
       return extractionDir;
     }
 
+    const fs::path& PathManager::GetRBCOutputPath() const
+    {
+      return rbcDir;
+    }
+
     fs::path PathManager::GetRBCOutputPathWithSubdir(std::string const& subdirectoryName) const
     {
       auto rbcSubdir = rbcDir / subdirectoryName;
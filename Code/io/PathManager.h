@@ -65,6 +65,12 @@ namespace hemelb
          */
         [[nodiscard]] const path& GetDataExtractionPath() const;
 
+        /**
+         * Return the path that RBC output should go to.
+         * @return
+         */
+        [[nodiscard]] const path& GetRBCOutputPath() const;
+
         /**
          * Create a subdirectory inside the RBC output directory and return its path
          * @param subdirectoryName Name of the subdirectory to be created
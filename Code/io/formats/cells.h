@@ -0,0 +1,56 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_IO_FORMATS_CELLS_H
+#define HEMELB_IO_FORMATS_CELLS_H
+
+#include "io/formats/formats.h"
+
+namespace hemelb::io::formats::cells
+{
+    /* One file per output step, holding every cell in the simulation.
+     * The format comprises a header and then a body.
+     * Header is made up of (hex file position, type, description)
+     * 00   uint       HemeLB magic number (see formats.h)
+     * 04   uint       Cells magic number (see below)
+     * 08   uint       Version number
+     * 12   uint       Length of the header (bytes)
+     * 16   ulong      Time step
+     * 24   ulong      Number of cells
+     * 32   ulong      Total number of vertices
+     * Header length = 40 bytes
+     *
+     * Body consists of one record per cell, grouped by process:
+     * string       Cell tag (uuid in canonical form)
+     * string       Template name
+     * double       Scale
+     * 3 x double   Barycentre (m)
+     * uint         Number of vertices N
+     * N x 3 x dbl  Vertex positions (m)
+     *
+     * Facets are not written: they are given by the template mesh.
+     */
+
+    enum
+    {
+      /* Identify cell files
+       * ASCII for 'rbc', then EOF
+       * Combined magic number is
+       * hex    68 6c 62 21 72 62 63 04
+       * ascii:  h  l  b  !  r  b  c EOF
+       */
+      MagicNumber = 0x72626304
+    };
+    enum
+    {
+      VersionNumber = 1
+    };
+    enum
+    {
+      HeaderLength = 40
+    };
+}
+
+#endif // HEMELB_IO_FORMATS_CELLS_H
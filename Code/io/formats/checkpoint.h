@@ -0,0 +1,192 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_IO_FORMATS_CHECKPOINT_H
+#define HEMELB_IO_FORMATS_CHECKPOINT_H
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "Exception.h"
+#include "io/Compression.h"
+#include "io/formats/formats.h"
+
+namespace hemelb::io::formats::checkpoint
+{
+    /* Native checkpoints come as a pair of files. Unlike the other
+     * formats, values are raw, in native byte order (little-endian on
+     * every platform we run on), so that they can be written straight
+     * from memory.
+     *
+     * The index file is written once per run and holds the site
+     * coordinates. Sites are grouped in blocks, one per writing
+     * process, in the order of FieldData on that process.
+     * 00   uint       HemeLB magic number (see formats.h)
+     * 04   uint       Index magic number (see below)
+     * 08   uint       Version number
+     * 12   uint       Number of blocks P
+     * 16   ulong      Total number of sites
+     * Header length = 24 bytes
+     * Then P block descriptions:
+     * ulong        Number of sites in the block
+     * ulong        Checksum of the block's coordinates
+     * Then, for each block and each site in it:
+     * 3 x uint     Site coordinates
+     *
+     * Each data file holds one checkpoint.
+     * 00   uint       HemeLB magic number (see formats.h)
+     * 04   uint       Checkpoint magic number (see below)
+     * 08   uint       Version number
+     * 12   uint       Byte order mark, 0x01020304 when written
+     * 16   ulong      Time step
+     * 24   ulong      Total number of sites
+     * 32   uint       Number of blocks P
+     * 36   uint       Number of distributions per site Q
+     * 40   ulong      Checksum of the index block descriptions
+     * 48   uint       Length of the index's file name I
+     * 52   uint       Reserved, zero
+     * Header length = 56 bytes
+     * Then the index's file name, relative to the directory of the
+     * data file, padded with zeros to a multiple of 8 bytes.
+     * Then P blocks, in the same order as the index:
+     * ulong        Checksum of the block's distributions
+     * N x Q x dbl  Distributions of the N sites of the block
+     *
+     * Delta files hold a checkpoint as its difference from a data
+     * file, the base, written earlier by the same run. The header is
+     * that of a data file, with the delta magic number, followed by:
+     * 56   ulong      Time step of the base
+     * 64   uint       Length of the base's file name L
+     * 68   uint       Reserved, zero
+     * Delta header length = 72 bytes
+     * Then the index's file name, padded as in a data file, and the
+     * base's file name, relative to the directory of the delta file
+     * and padded likewise.
+     * Then P x ulong: the length in bytes of each block.
+     * Then P blocks, in the same order as the index:
+     * ulong        Checksum of the block's distributions
+     * bytes        The distributions, encoded by EncodeDelta
+     */
+
+    enum
+    {
+      /* Identify index files
+       * ASCII for 'chi', then EOF
+       */
+      IndexMagicNumber = 0x63686904
+    };
+    enum
+    {
+      /* Identify data files
+       * ASCII for 'chk', then EOF
+       */
+      MagicNumber = 0x63686b04
+    };
+    enum
+    {
+      /* Identify delta files
+       * ASCII for 'chd', then EOF
+       */
+      DeltaMagicNumber = 0x63686404
+    };
+    enum
+    {
+      VersionNumber = 1
+    };
+    enum
+    {
+      IndexHeaderLength = 24,
+      IndexBlockLength = 16,
+      HeaderLength = 56,
+      DeltaHeaderLength = 72
+    };
+    enum
+    {
+      ByteOrderMark = 0x01020304
+    };
+
+    //! Fletcher-64 checksum over the 32-bit words of the values
+    template<typename T>
+    std::uint64_t Checksum(std::span<T const> values)
+    {
+      static_assert(sizeof(T) % sizeof(std::uint32_t) == 0);
+      std::uint64_t constexpr modulus = 0xffffffff;
+      std::uint64_t low = 0, high = 0;
+      auto const bytes = std::as_bytes(values);
+      for (std::size_t i = 0; i < bytes.size(); i += sizeof(std::uint32_t))
+      {
+        // Copied, as the values may not be read through a uint32 pointer
+        std::uint32_t word;
+        std::memcpy(&word, bytes.data() + i, sizeof(word));
+        low = (low + word) % modulus;
+        high = (high + low) % modulus;
+      }
+      return (high << 32) | low;
+    }
+
+    //! Length of a file name in a data or delta file, with its padding
+    constexpr std::uint64_t PaddedNameLength(std::uint64_t length)
+    {
+      return (length + 7) / 8 * 8;
+    }
+
+    /**
+     * Encodes values as their difference from the base values: the
+     * XOR of their 64-bit words, with the bytes regrouped by
+     * significance, then deflated. Values that changed little since
+     * the base share their sign, exponent and leading mantissa bits
+     * with it, which makes long runs of zero bytes. Lossless.
+     */
+    inline std::vector<char> EncodeDelta(std::span<double const> values, std::span<double const> base)
+    {
+      if (values.size() != base.size())
+        throw Exception() << "Delta base has " << base.size() << " values, not " << values.size();
+      auto const n = values.size();
+      std::vector<char> shuffled(8 * n);
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        auto const word = std::bit_cast<std::uint64_t>(values[i]) ^ std::bit_cast<std::uint64_t>(base[i]);
+        for (std::size_t b = 0; b < 8; ++b)
+          shuffled[b * n + i] = char(word >> (8 * b));
+      }
+      // Checkpoints are large and written often, so favour speed
+      return Deflate(shuffled, 1);
+    }
+
+    //! Decodes EncodeDelta's output. The values may be the base.
+    inline void DecodeDelta(std::span<char const> encoded, std::span<double const> base,
+                            std::span<double> values)
+    {
+      if (values.size() != base.size())
+        throw Exception() << "Delta base has " << base.size() << " values, not " << values.size();
+      auto const n = values.size();
+      auto const shuffled = Inflate(encoded, 8 * n);
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        std::uint64_t word = 0;
+        for (std::size_t b = 0; b < 8; ++b)
+          word |= std::uint64_t(static_cast<unsigned char>(shuffled[b * n + i])) << (8 * b);
+        values[i] = std::bit_cast<double>(word ^ std::bit_cast<std::uint64_t>(base[i]));
+      }
+    }
+
+    //! Index file for the pattern of a run's data files: the '%d' is
+    //! removed and the extension replaced. Data files record its name.
+    inline std::string PatternToIndex(std::string path)
+    {
+      if (auto const i_pcd = path.find("%d"); i_pcd != std::string::npos)
+        path.erase(i_pcd, 2);
+      auto const iDot = path.rfind('.');
+      if (iDot == std::string::npos)
+        throw Exception() << "Cannot split extension from checkpoint filename";
+      return path.substr(0, iDot) + ".idx";
+    }
+}
+
+#endif // HEMELB_IO_FORMATS_CHECKPOINT_H
@@ -6,6 +6,9 @@
 #ifndef HEMELB_IO_FORMATS_EXTRACTION_H
 #define HEMELB_IO_FORMATS_EXTRACTION_H
 
+#include <cstdint>
+#include <limits>
+
 namespace hemelb::io::formats::extraction
 {
   // Magic number to identify extraction data files.
@@ -19,6 +22,12 @@ namespace hemelb::io::formats::extraction
     VersionNumber = 5
   };
 
+  // The version number of the compressed file format. The headers
+  // are the same as for the uncompressed format, see below.
+  enum {
+    CompressedVersionNumber = 6
+  };
+
   // The length of the main header. Made up of:
   // uint - HemeLbMagicNumber
   // uint - ExtractionMagicNumber
@@ -48,6 +57,46 @@ namespace hemelb::io::formats::extraction
     UINT64,
   };
 
+  // In compressed files, the headers are followed by the site
+  // coordinates, stored once for all time steps. Sites are grouped
+  // in chunks, one per writing process.
+  // uint - Number of chunks P
+  // uint - Codec
+  // double - Absolute error bound (LOSSY only, else zero)
+  // uhyper[P] - Number of sites in each chunk
+  // uhyper[P] - Compressed length of each chunk's coordinates
+  // Then each chunk's coordinates, compressed: the x coordinates of
+  // all its sites, then all the y, then all the z, as uint.
+  //
+  // Then there is a record per time step:
+  // uhyper - Time step
+  // uhyper - Length of the rest of the record, after the chunk lengths
+  // uhyper[P] - Compressed length of each chunk
+  // Then the chunks, compressed. Each holds, for each field and each
+  // of its elements, that element at all the chunk's sites, in the
+  // same order as the coordinates.
+  //
+  // Everything is XDR before compression. Chunks are compressed in
+  // the zlib format.
+  enum {
+    SiteHeaderLength = 16,
+    RecordHeaderLength = 16
+  };
+
+  enum class Codec : std::uint32_t {
+    // Lossless
+    DEFLATE = 1,
+    // Floating point values v are stored as hyper round(v / (2 *
+    // error bound)) before compression, so they are accurate to
+    // within the error bound, or as LossyNotANumber. Integers are
+    // stored exactly.
+    LOSSY = 2,
+  };
+
+  // LOSSY stores this for floating point values it cannot quantise,
+  // as they are not finite or too large for a hyper. Readers give NaN.
+  constexpr std::int64_t LossyNotANumber = std::numeric_limits<std::int64_t>::min();
+
   // Compute the length of data written by XDR for a given string.
   inline size_t GetStoredLengthOfString(std::string const& str)
   {
@@ -35,9 +35,11 @@ namespace hemelb::lb
         template<lattice_type> friend class EntropicBase;
         template<lattice_type> friend class EntropicAnsumali;
         template<lattice_type> friend class EntropicChik;
+        template<lattice_type> friend class EntropicSeries;
         template<lattice_type> friend class LBGK;
         template<class rheologyModel, lattice_type> friend class LBGKNN;
         template<moment_basis> friend class MRT;
+        template<lattice_type> friend class Regularised;
         template<lattice_type> friend class TRT;
 
         HydroVarsBase(const_span s) : f(s) {
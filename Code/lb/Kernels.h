@@ -10,10 +10,12 @@
 
 #include "lb/kernels/EntropicAnsumali.h"
 #include "lb/kernels/EntropicChik.h"
+#include "lb/kernels/EntropicSeries.h"
 #include "lb/kernels/LBGK.h"
 #include "lb/kernels/LBGKNN.h"
 #include "lb/kernels/MRT.h"
 #include "lb/kernels/GuoForcingLBGK.h"
+#include "lb/kernels/Regularised.h"
 #include "lb/kernels/TRT.h"
 #include "lb/kernels/MomentBases.h"
 #include "lb/kernels/RheologyModels.h"
@@ -29,6 +31,8 @@ namespace hemelb::lb {
                 return EntropicAnsumali<L>{i};
             } else if constexpr (KERN == "EntropicChik") {
                 return EntropicChik<L>{i};
+            } else if constexpr (KERN == "EntropicSeries") {
+                return EntropicSeries<L>{i};
             } else if constexpr (KERN == "MRT") {
                 if constexpr (std::same_as<L, D3Q15>) {
                     return MRT<DHumieresD3Q15MRTBasis>{i};
@@ -49,6 +53,10 @@ namespace hemelb::lb {
                 return LBGKNN<TruncatedPowerLawRheologyModel, L>{i};
             } else if constexpr (KERN == "GuoForcingLBGK") {
                 return GuoForcingLBGK<L>{i};
+            } else if constexpr (KERN == "Regularised") {
+                return Regularised<L>{i};
+            } else if constexpr (KERN == "GuoForcingRegularised") {
+                return GuoForcingRegularised<L>{i};
             } else {
                 throw (Exception() << "Configured with invalid KERNEL");
             }
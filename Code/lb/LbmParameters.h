@@ -113,6 +113,10 @@ namespace hemelb::lb
 
         StressTypes StressType;
 
+        // Relative error in tau allowed for non-Newtonian kernels to
+        // tabulate their rheology model, or 0 to evaluate it exactly
+        double ViscosityTableTolerance = 0;
+
       private:
         PhysicalTime timeStep = 1; // seconds
         PhysicalDistance voxelSize = 1; // metres
@@ -0,0 +1,50 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "lb/TemporalBlocking.h"
+
+namespace hemelb::lb
+{
+    TemporalBlocking::TemporalBlocking(unsigned depth, const std::vector<std::uint8_t>& distances,
+                                       const std::vector<std::vector<site_t>>& planes, site_t sitesPerBlock) :
+        depth(depth), distanceRanges(depth - 1)
+    {
+        // Appends the sites in [first, first + count) that pass to the
+        // ranges, merging adjacent ones
+        auto append = [&](std::vector<Range>& ranges, site_t first, site_t count, auto&& pass) {
+            for (site_t site = first; site < first + count; ++site)
+            {
+                if (!pass(distances[site]))
+                    continue;
+                if (!ranges.empty() && ranges.back().first + ranges.back().count == site)
+                    ++ranges.back().count;
+                else
+                    ranges.push_back({site, 1});
+            }
+        };
+
+        for (auto const& plane: planes)
+        {
+            auto& steps = planeRanges.emplace_back(depth);
+            for (unsigned ahead = 0; ahead < depth; ++ahead)
+                for (auto block: plane)
+                    append(steps[ahead], block * sitesPerBlock, sitesPerBlock,
+                           [&](unsigned distance) { return distance >= ahead; });
+        }
+        for (unsigned distance = 1; distance + 1 < depth; ++distance)
+            append(distanceRanges[distance], 0, distances.size(),
+                   [&](unsigned d) { return d == distance; });
+    }
+
+    bool TemporalBlocking::StartsCycle(LatticeTimeStep step, LatticeTimeStep lastStep) const
+    {
+        return (step - 1) % depth == 0 && step + depth - 1 <= lastStep;
+    }
+
+    LatticeTimeStep TemporalBlocking::GetNextSyncStep(LatticeTimeStep step) const
+    {
+        return (step + depth - 1) / depth * depth;
+    }
+}
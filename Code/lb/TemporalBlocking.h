@@ -0,0 +1,166 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_LB_TEMPORALBLOCKING_H
+#define HEMELB_LB_TEMPORALBLOCKING_H
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "geometry/Domain.h"
+#include "units.h"
+
+namespace hemelb::lb
+{
+    /**
+     * Schedule to advance the direct sites of a domain (those of fully
+     * fluid blocks whose neighbouring blocks are all fully fluid, see
+     * geometry::Domain::GetDirectSiteCount) several time steps per
+     * sweep, so that their distributions are reused from cache.
+     *
+     * A cycle is `depth` time steps, from a step t with
+     * (t - 1) % depth == 0 to a synchronisation step, a multiple of
+     * depth. The other sites still take one step per time step. A
+     * direct site d links from the nearest other site may run up to d
+     * steps ahead of them, so in the first step of a cycle each direct
+     * site takes min(d, depth - 1) + 1 steps, and in later steps those
+     * that still have steps left take one more. Only at
+     * synchronisation steps are all sites at the same time.
+     *
+     * In the first step of a cycle the planes of direct blocks along x
+     * are swept as a wavefront, step s of a plane following step s - 1
+     * of the next, so only about depth planes are in use at once.
+     *
+     * A site s steps ahead of the others reads and writes the
+     * distribution arrays swapped if s is odd.
+     */
+    class TemporalBlocking
+    {
+    public:
+        //! A range of contiguous site indices
+        struct Range
+        {
+            site_t first;
+            site_t count;
+        };
+
+        /**
+         * Builds the schedule for a domain.
+         * @param domain
+         * @param depth time steps per cycle, from 2 to 255
+         */
+        template <typename LatticeType>
+        static TemporalBlocking Build(const geometry::Domain& domain, unsigned depth);
+
+        unsigned GetDepth() const
+        {
+            return depth;
+        }
+
+        //! Whether a cycle starts at the step, and ends by the last step
+        bool StartsCycle(LatticeTimeStep step, LatticeTimeStep lastStep) const;
+
+        //! The first synchronisation step at or after the step
+        LatticeTimeStep GetNextSyncStep(LatticeTimeStep step) const;
+
+        //! Calls f(range, ahead) for the sites to take a step ahead of the
+        //! others, in order, for the first step of a cycle
+        template <typename F>
+        void ForEachFirstStepRange(F&& f) const;
+
+        //! As ForEachFirstStepRange, for a later step (phase > 0) of a cycle
+        template <typename F>
+        void ForEachLaterStepRange(unsigned phase, F&& f) const;
+
+    private:
+        TemporalBlocking(unsigned depth, const std::vector<std::uint8_t>& distances,
+                         const std::vector<std::vector<site_t>>& planes, site_t sitesPerBlock);
+
+        unsigned depth;
+        // For each plane of blocks, for each number of steps ahead s, its
+        // sites at a distance of at least s from the other sites
+        std::vector<std::vector<std::vector<Range>>> planeRanges;
+        // For each distance below depth - 1, the sites at that distance
+        std::vector<std::vector<Range>> distanceRanges;
+    };
+
+    template <typename LatticeType>
+    TemporalBlocking TemporalBlocking::Build(const geometry::Domain& domain, unsigned depth)
+    {
+        auto const directSites = domain.GetDirectSiteCount();
+        auto const sitesPerBlock = domain.GetSitesPerBlockVolumeUnit();
+        auto neighbour = [&](site_t site, Direction direction) {
+            return domain.GetSite(site).template GetStreamedIndex<LatticeType>(direction)
+                / LatticeType::NUMVECTORS;
+        };
+
+        // Distance in links to the nearest other site, by breadth first
+        // search, but no further than depth - 1
+        std::uint8_t const furthest = depth - 1;
+        std::vector<std::uint8_t> distances(directSites, furthest);
+        std::vector<site_t> front;
+        for (site_t site = 0; site < directSites; ++site)
+            for (Direction direction = 1; direction < LatticeType::NUMVECTORS; ++direction)
+                if (neighbour(site, direction) >= directSites)
+                {
+                    distances[site] = 1;
+                    front.push_back(site);
+                    break;
+                }
+        for (unsigned distance = 1; distance + 1 < furthest && !front.empty(); ++distance)
+        {
+            std::vector<site_t> next;
+            for (auto site: front)
+                for (Direction direction = 1; direction < LatticeType::NUMVECTORS; ++direction)
+                {
+                    auto const n = neighbour(site, direction);
+                    if (n < directSites && distances[n] > distance + 1)
+                    {
+                        distances[n] = distance + 1;
+                        next.push_back(n);
+                    }
+                }
+            front.swap(next);
+        }
+
+        // Group the direct blocks by x coordinate
+        std::map<site_t, std::vector<site_t>> byX;
+        for (site_t block = 0; block * sitesPerBlock < directSites; ++block)
+            byX[domain.GetSite(block * sitesPerBlock).GetGlobalSiteCoords().x() / domain.GetBlockSize()]
+                .push_back(block);
+        std::vector<std::vector<site_t>> planes;
+        for (auto& [x, blocks]: byX)
+            planes.push_back(std::move(blocks));
+
+        return {depth, distances, planes, sitesPerBlock};
+    }
+
+    template <typename F>
+    void TemporalBlocking::ForEachFirstStepRange(F&& f) const
+    {
+        // Step s of plane q at wave q + s, after step s - 1 of plane q + 1
+        auto const planes = planeRanges.size();
+        for (std::size_t wave = 0; wave + 1 < planes + depth; ++wave)
+            for (unsigned ahead = 0; ahead < depth && ahead <= wave; ++ahead)
+            {
+                auto const plane = wave - ahead;
+                if (plane >= planes)
+                    continue;
+                for (auto const& range: planeRanges[plane][ahead])
+                    f(range, ahead);
+            }
+    }
+
+    template <typename F>
+    void TemporalBlocking::ForEachLaterStepRange(unsigned phase, F&& f) const
+    {
+        for (unsigned distance = 1; distance + phase < depth; ++distance)
+            for (auto const& range: distanceRanges[distance])
+                f(range, distance);
+    }
+}
+
+#endif // HEMELB_LB_TEMPORALBLOCKING_H
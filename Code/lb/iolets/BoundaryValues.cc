@@ -28,6 +28,7 @@ namespace hemelb::lb
           // First create a copy of all iolets
           auto iolet = incoming_iolets[ioletIndex].clone();
 
+          iolet->ReadInputFiles(bcComms);
           iolet->Initialise(&unitConverter);
 
           bool isIoletOnThisProc = IsIoletOnThisProc(latticeData, ioletIndex);
@@ -99,6 +99,16 @@ namespace hemelb::lb
            */
           virtual void DoComms(const BoundaryCommunicator& bcComms, const LatticeTimeStep timeStep);
 
+          /***
+           * Read any input files of the Iolet, on the BC proc, sharing
+           * them with the others. Collective: called on all procs for
+           * every Iolet, before Initialise.
+           * @param bcComms the boundary communicator
+           */
+          virtual void ReadInputFiles(const BoundaryCommunicator& bcComms)
+          {
+          }
+
           /***
            * Set up the Iolet.
            * @param units a UnitConverter instance.
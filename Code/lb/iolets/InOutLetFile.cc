@@ -4,16 +4,15 @@
 // license in the file LICENSE.
 
 #include <algorithm>
-#include <fstream>
+#include <cmath>
 
 #include "lb/iolets/InOutLetFile.h"
-#include "log/Logger.h"
-#include "configuration/SimConfig.h"
+#include "lb/iolets/BoundaryCommunicator.h"
 
 namespace hemelb::lb
 {
       InOutLetFile::InOutLetFile() :
-          InOutLet(), densityTable(0)
+          InOutLet(), densityMin(0), densityMax(0), totalTimeSteps(0)
       {
 
       }
@@ -23,92 +22,49 @@ namespace hemelb::lb
         return new InOutLetFile(*this);
       }
 
-        auto less_time = [](std::pair<LatticeTime, LatticeDensity> const& l, std::pair<LatticeTime, LatticeDensity>  const& r) {
-            return l.first < r.first;
-        };
-
-      // This reads the file and converts to lattice units
-        void InOutLetFile::Initialise(const util::UnitConverter* unitConverter)
-        {
-            if (!std::filesystem::exists(pressureFilePath))
-                throw (Exception() << "File does not exist: " << pressureFilePath);
-
-            // First read in values from file, keeping sorted by time and unique for time.
-            std::ifstream datafile(pressureFilePath);
-            log::Logger::Log<log::Debug, log::OnePerCore>("Reading iolet values from file: %s", pressureFilePath.c_str());
-
-
-            while (datafile.good())
-            {
-                double t_s, p_mmHg;
-                datafile >> t_s >> p_mmHg;
-                log::Logger::Log<log::Trace, log::OnePerCore>("Time: %f s. Value: %f mmHg.", t_s, p_mmHg);
-                auto t_lat = unitConverter->ConvertTimeToLatticeUnits(t_s);
-                auto rho_lat = unitConverter->ConvertPressureToLatticeUnits(p_mmHg) / Cs2;
-                auto it = std::lower_bound(file_data_lat.begin(), file_data_lat.end(), DataPair{t_lat, rho_lat}, less_time);
-                if (it->first == t_lat) {
-                    *it = {t_lat, rho_lat};
-                } else {
-                    file_data_lat.insert(it, std::make_pair(t_lat, rho_lat));
-                }
-            }
-            datafile.close();
-
-            auto less_density = [](DataPair const& l, DataPair const& r) {
-                return l.second < r.second;
-            };
-            densityMin = std::min_element(file_data_lat.begin(), file_data_lat.end(), less_density)->second;
-            densityMax = std::min_element(file_data_lat.begin(), file_data_lat.end(), less_density)->second;
+      void InOutLetFile::ReadInputFiles(const BoundaryCommunicator& bcComms)
+      {
+        pressures = IoletTimeSeries::Read(pressureFilePath, bcComms, bcComms.GetBCProcRank());
+      }
 
-            // Check if last point's value matches the first
-            if (file_data_lat.back().second != file_data_lat.front().second)
-                throw (Exception() << "Last point's value does not match the first point's value in "
-                                   << pressureFilePath);
-        }
+      // This converts the file's values to lattice units, reading it
+      // here if ReadInputFiles was not called
+      void InOutLetFile::Initialise(const util::UnitConverter* unitConverter)
+      {
+        if (!pressures)
+          pressures = IoletTimeSeries::Read(pressureFilePath);
 
-        // This interpolates between points to generate a cycle
-        // IMPORTANT: to allow reading in data taken at irregular intervals the user
-        // needs to make sure that the last point in the file coincides with the first
-        // point of a new cycle for a continuous trace.
-        void InOutLetFile::Reset(SimulationState &state)
+        std::vector<LatticeTime> times;
+        std::vector<LatticeDensity> values;
+        for (std::size_t i = 0; i < pressures->GetTimes().size(); ++i)
         {
-            auto totalTimeSteps = state.GetTotalTimeSteps();
-            // If the time values in the input file end BEFORE the planned
-            // end of the simulation, then loop the profile afterwards
-            // (using %TimeStepsInInletPressureProfile).
-            // int TimeStepsInInletPressureProfile = times.back() / timeStepLength;
-            // throw Exception() << "Finding Time steps: " << times.back() << " " << timeStepLength << " " << TimeStepsInInletPressureProfile;
-
-            // extend the table to one past the total time steps, so that
-            // the table is valid in the end-state, where the zero indexed
-            // time step is equal to the limit.
-            densityTable.resize(totalTimeSteps + 1);
-            // Now convert these vectors into arrays using linear
-            // interpolation
-
-            auto const& t_0 = file_data_lat.front().first;
-            auto const& t_1 = file_data_lat.back().first;
-
-            // To speed up the search, track the iterators that bracket the current time
-
-            // Let lower be the iterator to the last element less than or equal to x
-            auto lower = file_data_lat.begin();
-            // Let upper be the iterator to the first element greater than x
-            auto upper = lower + 1;
-            // These are always one apart
-            for (unsigned int timeStep = 0; timeStep <= totalTimeSteps; timeStep++)
-            {
-                LatticeTime x = std::lerp(t_0, t_1, LatticeTime(timeStep) / LatticeTime(totalTimeSteps));
-                // First element strictly greater than t_0
-                upper = std::find_if(upper, file_data_lat.end(), [&](DataPair const& p) {
-                    return p.first > x;
-                });
-                // Last element less than or equal to t_0
-                lower = upper - 1;
-                auto [x0, y0] = *lower;
-                auto [x1, y1] = *upper;
-                densityTable[timeStep] = std::lerp(y0, y1, (x - x0) / (x1 - x0));
-            }
+          times.push_back(unitConverter->ConvertTimeToLatticeUnits(pressures->GetTimes()[i]));
+          values.push_back(unitConverter->ConvertPressureToLatticeUnits(pressures->GetValues()[i]) / Cs2);
         }
+        densityMin = *std::min_element(values.begin(), values.end());
+        densityMax = *std::max_element(values.begin(), values.end());
+
+        // Check if last point's value matches the first
+        if (values.back() != values.front())
+          throw (Exception() << "Last point's value does not match the first point's value in "
+                             << pressureFilePath);
+        densities.emplace(std::move(times), std::move(values));
+      }
 
-    }
+      void InOutLetFile::Reset(SimulationState &state)
+      {
+        totalTimeSteps = state.GetTotalTimeSteps();
+      }
+
+      // IMPORTANT: to allow reading in data taken at irregular intervals the user
+      // needs to make sure that the last point in the file coincides with the first
+      // point of a new cycle for a continuous trace.
+      LatticeDensity InOutLetFile::GetDensity(LatticeTimeStep timeStep) const
+      {
+        // The trace is stretched over the run, including its end state,
+        // where the zero indexed time step is equal to the limit
+        auto const& times = densities->GetTimes();
+        return densities->Interpolate(std::lerp(times.front(), times.back(),
+                                                LatticeTime(timeStep) / LatticeTime(totalTimeSteps)));
+      }
+}
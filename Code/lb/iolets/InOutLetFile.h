@@ -7,21 +7,20 @@
 #define HEMELB_LB_IOLETS_INOUTLETFILE_H
 
 #include <filesystem>
-#include <utility>
+#include <optional>
 
 #include "lb/iolets/InOutLet.h"
+#include "lb/iolets/IoletTimeSeries.h"
 
 namespace hemelb::lb
 {
 
       /*
-       * Template values are chosen to be tUpdatePeriod = 0 and tComms = false
-       * If a trace is read from a file it should be done once and then stored
-       * on each relevant proc. If memory is a concern tComms can be set to true
-       * and then only the BCproc will keep the entire trace in memory
-       * WARNING: - be cautious of setting tUpdatePeriod to something else other than
-       * zero, because it may not be what you expect - see comments on CalculateCycle in
-       * cc file.
+       * Pressure iolet following a trace read from a file, of time (s)
+       * and pressure (mmHg) per line. The file is read once, on the BC
+       * proc, and its samples shared with the others, which interpolate
+       * between them as needed. The trace is stretched over the whole
+       * run.
        */
       class InOutLetFile : public InOutLet
       {
@@ -48,19 +47,19 @@ namespace hemelb::lb
           {
             return densityMax;
           }
-          inline LatticeDensity GetDensity(LatticeTimeStep timeStep) const override
-          {
-            return densityTable[timeStep];
-          }
+          LatticeDensity GetDensity(LatticeTimeStep timeStep) const override;
+          void ReadInputFiles(const BoundaryCommunicator& bcComms) override;
           void Initialise(const util::UnitConverter* unitConverter) override;
 
         private:
-          std::vector<LatticeDensity> densityTable;
           LatticeDensity densityMin;
           LatticeDensity densityMax;
           std::filesystem::path pressureFilePath;
-          using DataPair = std::pair<LatticeTime, LatticeDensity>;
-          std::vector<DataPair> file_data_lat;
+          // As read, in physical units
+          std::optional<IoletTimeSeries> pressures;
+          // In lattice units
+          std::optional<IoletTimeSeries> densities;
+          LatticeTimeStep totalTimeSteps;
       };
 
 }
@@ -7,15 +7,15 @@
 #include <algorithm>
 #include <fstream>
 #include "hassert.h"
+#include "lb/iolets/BoundaryCommunicator.h"
 #include "log/Logger.h"
-#include "util/utilityFunctions.h"
 #include "configuration/SimConfig.h"
 #include <cmath>
 
 namespace hemelb::lb
 {
     InOutLetFileVelocity::InOutLetFileVelocity() :
-            units(nullptr)
+            units(nullptr), totalTimeSteps(0), timeStepsInCycle(0)
     {
     }
 
@@ -25,88 +25,62 @@ namespace hemelb::lb
         return copy;
     }
 
-    void InOutLetFileVelocity::CalculateTable(LatticeTimeStep totalTimeSteps, PhysicalTime timeStepLength)
+    void InOutLetFileVelocity::ReadInputFiles(const BoundaryCommunicator& bcComms)
     {
-        // First read in values from file
-        // Used to be complex code here to keep a vector unique, but this is just achieved by using a map.
-        std::map<PhysicalTime, PhysicalSpeed> timeValuePairs;
-
-        double timeTemp, valueTemp;
-
-        if (!std::filesystem::exists(velocityFilePath))
-            throw Exception() << "File does not exist: " << velocityFilePath;
-
-        std::ifstream datafile(velocityFilePath);
-        log::Logger::Log<log::Debug, log::OnePerCore>("Reading iolet values from file:");
-        while (datafile.good())
-        {
-          datafile >> timeTemp >> valueTemp;
-          log::Logger::Log<log::Trace, log::OnePerCore>("Time: %f Value: %f", timeTemp, valueTemp);
-          timeValuePairs[timeTemp] = valueTemp;
-        }
+        velocities = IoletTimeSeries::Read(velocityFilePath, bcComms, bcComms.GetBCProcRank());
+    }
 
-        datafile.close();
-        // the default iterator for maps traverses in key order, so no sort is needed.
+    void InOutLetFileVelocity::CalculateCycle(LatticeTimeStep totalTimeSteps, PhysicalTime timeStepLength)
+    {
+        // The file is read here if ReadInputFiles was not called
+        if (!velocities)
+          velocities = IoletTimeSeries::Read(velocityFilePath);
 
         std::vector<PhysicalTime> times(0);
-        std::vector<PhysicalSpeed> values(0);
-
-        // Must convert into vectors since LinearInterpolate works on a pair of vectors
-        // Determine min and max pressure on the way
-//        PhysicalPressure pMin = timeValuePairs.begin()->second;
-//        PhysicalPressure pMax = timeValuePairs.begin()->second;
-        for (std::map<PhysicalTime, PhysicalSpeed>::iterator entry = timeValuePairs.begin();
-            entry != timeValuePairs.end(); entry++)
+        std::vector<LatticeSpeed> values(0);
+        PhysicalTime const endTime = totalTimeSteps * timeStepLength;
+        for (std::size_t i = 0; i < velocities->GetTimes().size(); ++i)
         {
+          PhysicalTime const time = velocities->GetTimes()[i];
+          PhysicalSpeed const value = velocities->GetValues()[i];
 
           /* If the time value in the input file stretches BEYOND the end of the simulation, then insert an interpolated end value and exit the loop. */
-          if(entry->first > totalTimeSteps*timeStepLength) {
-  
-            PhysicalTime time_diff = totalTimeSteps*timeStepLength - times.back();
-
-            PhysicalTime time_diff_ratio = time_diff / (entry->first - times.back());
-            PhysicalSpeed vel_diff = entry->second - values.back();
-
-            PhysicalSpeed final_velocity = values.back() + time_diff_ratio * vel_diff;
-
-            times.push_back(totalTimeSteps*timeStepLength);
-            values.push_back(final_velocity);
+          if (time > endTime && !times.empty())
+          {
+            times.push_back(endTime);
+            values.push_back(units->ConvertVelocityToLatticeUnits(velocities->Interpolate(endTime)));
             break;
           }
 
-          times.push_back(entry->first);
-          values.push_back(entry->second);
+          times.push_back(time);
+          values.push_back(units->ConvertVelocityToLatticeUnits(value));
         }
-//        densityMin = units->ConvertPressureToLatticeUnits(pMin) / Cs2;
-//        densityMax = units->ConvertPressureToLatticeUnits(pMax) / Cs2;
 
-        /* If the time values in the input file end BEFORE the planned end of the simulation, then loop the profile afterwards (using %TimeStepsInInletVelocityProfile). */
-        int TimeStepsInInletVelocityProfile = times.back() / timeStepLength;
+        /* If the time values in the input file end BEFORE the planned end of the simulation, then loop the profile afterwards (using timeStepsInCycle). */
+        timeStepsInCycle = times.back() / timeStepLength;
+        if (timeStepsInCycle == 0)
+          throw Exception() << "Velocities in " << velocityFilePath << " last less than a time step";
 
         // Check if last point's value matches the first
         if (values.back() != values.front())
           throw Exception() << "Last point's value does not match the first point's value in "
               << velocityFilePath;
 
-        // extend the table to one past the total time steps, so that the table is valid in the end-state, where the zero indexed time step is equal to the limit.
-        velocityTable.resize(totalTimeSteps + 1);
-        // Now convert these vectors into arrays using linear interpolation
-        for (unsigned int timeStep = 0; timeStep <= totalTimeSteps; timeStep++)
-        {
-          // The "% TimeStepsInInletVelocityProfile" here is to prevent profile stretching (it will loop instead).
-          double point = times.front()
-              + (static_cast<double>(timeStep % TimeStepsInInletVelocityProfile) / static_cast<double>(totalTimeSteps))
-                  * (times.back() - times.front());
-
-          PhysicalSpeed vel = util::NumericalFunctions::LinearInterpolate(times, values, point);
-
-          velocityTable[timeStep] = units->ConvertVelocityToLatticeUnits(vel);
-        }
+        this->totalTimeSteps = totalTimeSteps;
+        cycle.emplace(std::move(times), std::move(values));
+      }
 
+      InOutLetVelocity::Complex InOutLetFileVelocity::GetTimeFactor(const LatticeTimeStep t) const
+      {
+        // The "% timeStepsInCycle" here is to prevent profile stretching (it will loop instead).
+        auto const& times = cycle->GetTimes();
+        double point = times.front()
+            + (static_cast<double>(t % timeStepsInCycle) / static_cast<double>(totalTimeSteps))
+                * (times.back() - times.front());
+        return cycle->Interpolate(point);
       }
 
-      LatticeVelocity InOutLetFileVelocity::GetVelocity(const LatticePosition& x,
-                                                        const LatticeTimeStep t) const
+      InOutLetVelocity::Complex InOutLetFileVelocity::GetProfile(const LatticePosition& x) const
       {
 
         if (!useWeightsFromFile)
@@ -118,11 +92,7 @@ namespace hemelb::lb
           Dimensionless rSqOverASq = (displ.GetMagnitudeSquared() - z * z) / (radius * radius);
           HASSERT(rSqOverASq <= 1.0);
 
-          // Get the max velocity
-          LatticeSpeed max = velocityTable[t];
-
-          // Brackets to ensure that the scalar multiplies are done before vector * scalar.
-          return normal * (max * (1. - rSqOverASq));
+          return 1. - rSqOverASq;
         }
         else
         {
@@ -172,19 +142,13 @@ namespace hemelb::lb
               }
           }
 
-	  auto v_tot = LatticeVelocity::Zero();
           int iterations = 0;
 
           while (iterations < 3)
           {
             if (weights_table.count(xyz) > 0)
             {
-              v_tot = normal * weights_table.at(xyz) * velocityTable[t];
-              //log::Logger::Log<log::Warning, log::OnePerCore>("%f %f %f %f",
-              //                                                              x.x,
-              //                                                              x.y,
-              //                                                              x.z, v_tot);
-              return v_tot;
+              return weights_table.at(xyz);
             }
 
             /*if (logging)
@@ -251,7 +215,7 @@ namespace hemelb::lb
            * If you are unsure, you can increase the log level of this, run HemeLb
            * for 1 time step, and plot these points out. */
           log::Logger::Log<log::Trace, log::OnePerCore>("%f %f %f", x.x(), x.y(), x.z());
-          return normal * 0.0;
+          return 0.0;
         }
 
       }
@@ -6,7 +6,9 @@
 #define HEMELB_LB_IOLETS_INOUTLETFILEVELOCITY_H
 
 #include <map>
+#include <optional>
 #include "lb/iolets/InOutLetVelocity.h"
+#include "lb/iolets/IoletTimeSeries.h"
 
 namespace hemelb::lb
 {
@@ -22,7 +24,7 @@ namespace hemelb::lb
 
 	  void Reset(SimulationState &state) override
           {
-            CalculateTable(state.GetTotalTimeSteps(), state.GetTimeStepLength());
+            CalculateCycle(state.GetTotalTimeSteps(), state.GetTimeStepLength());
           }
 
           const std::string& GetFilePath()
@@ -34,10 +36,10 @@ namespace hemelb::lb
             velocityFilePath = path;
           }
 
-          LatticeVelocity GetVelocity(const LatticePosition& x, const LatticeTimeStep t) const override;
-          /*LatticeVelocity GetVelocity2(const util::Vector3D<int64_t> globalCoordinates,
-                                                                  const LatticeTimeStep t) const;*/
+          Complex GetProfile(const LatticePosition& x) const override;
+          Complex GetTimeFactor(const LatticeTimeStep t) const override;
 
+          void ReadInputFiles(const BoundaryCommunicator& bcComms) override;
           void Initialise(const util::UnitConverter* unitConverter) override;
 
           bool useWeightsFromFile;
@@ -45,9 +47,14 @@ namespace hemelb::lb
         private:
           std::string velocityFilePath;
           std::string velocityWeightsFilePath;
-          void CalculateTable(LatticeTimeStep totalTimeSteps, PhysicalTime timeStepLength);
-          std::vector<LatticeSpeed> velocityTable;
+          void CalculateCycle(LatticeTimeStep totalTimeSteps, PhysicalTime timeStepLength);
           const util::UnitConverter* units;
+          // As read, in physical units
+          std::optional<IoletTimeSeries> velocities;
+          // Up to the end of the run, with speeds in lattice units
+          std::optional<IoletTimeSeries> cycle;
+          LatticeTimeStep totalTimeSteps;
+          LatticeTimeStep timeStepsInCycle;
 
           std::map<std::vector<int>, double> weights_table;
 
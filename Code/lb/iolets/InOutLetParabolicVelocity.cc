@@ -20,8 +20,7 @@ namespace hemelb::lb
         return copy;
       }
 
-      LatticeVelocity InOutLetParabolicVelocity::GetVelocity(const LatticePosition& x,
-                                                             const LatticeTimeStep t) const
+      InOutLetVelocity::Complex InOutLetParabolicVelocity::GetProfile(const LatticePosition& x) const
       {
         // v(r) = vMax (1 - r**2 / a**2)
         // where r is the distance from the centreline
@@ -30,6 +29,11 @@ namespace hemelb::lb
         Dimensionless rSq = (displ.GetMagnitudeSquared() - z * z) / (radius * radius);
         HASSERT(rSq <= 1.0);
 
+        return 1. - rSq;
+      }
+
+      InOutLetVelocity::Complex InOutLetParabolicVelocity::GetTimeFactor(const LatticeTimeStep t) const
+      {
         // Get the max velocity
         LatticeSpeed max = maxSpeed;
         // If we're in the warm-up phase, scale down the imposed velocity
@@ -37,8 +41,6 @@ namespace hemelb::lb
         {
           max *= t / double(warmUpLength);
         }
-
-        // Brackets to ensure that the scalar multiplies are done before vector * scalar.
-        return normal * (max * (1. - rSq));
+        return max;
       }
 }
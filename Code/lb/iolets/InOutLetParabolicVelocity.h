@@ -15,7 +15,8 @@ namespace hemelb::lb
           InOutLetParabolicVelocity();
           ~InOutLetParabolicVelocity() override = default;
           [[nodiscard]] InOutLet* clone() const override;
-          LatticeVelocity GetVelocity(const LatticePosition& x, const LatticeTimeStep t) const override;
+          Complex GetProfile(const LatticePosition& x) const override;
+          Complex GetTimeFactor(const LatticeTimeStep t) const override;
 
           const LatticeSpeed& GetMaxSpeed() const
           {
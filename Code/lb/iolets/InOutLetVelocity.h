@@ -5,13 +5,25 @@
 
 #ifndef HEMELB_LB_IOLETS_INOUTLETVELOCITY_H
 #define HEMELB_LB_IOLETS_INOUTLETVELOCITY_H
+#include <complex>
 #include "lb/iolets/InOutLet.h"
 
 namespace hemelb::lb
 {
+      /**
+       * Base class for iolets that impose a velocity. The velocity is
+       *
+       *   normal * Re(GetProfile(x) * GetTimeFactor(t))
+       *
+       * so boundary conditions can find the spatial profile once for
+       * each point they need, and the time factor once per time step
+       * (see IoletVelocityProfiles).
+       */
       class InOutLetVelocity : public InOutLet
       {
         public:
+          using Complex = std::complex<double>;
+
           InOutLetVelocity();
           ~InOutLetVelocity() override = default;
           LatticeDensity GetDensityMin() const override;
@@ -36,11 +48,33 @@ namespace hemelb::lb
             radius = r;
           }
 
-          virtual LatticeVelocity GetVelocity(const LatticePosition& x,
-                                              const LatticeTimeStep t) const = 0;
+          /**
+           * Get the velocity for a given time and position.
+           *
+           * @param x lattice site position
+           * @param t time
+           * @return velocity
+           */
+          LatticeVelocity GetVelocity(const LatticePosition& x, const LatticeTimeStep t) const
+          {
+            return normal * std::real(GetProfile(x) * GetTimeFactor(t));
+          }
+
+          /**
+           * Get the spatial part of the velocity at a position.
+           *
+           * @param x lattice site position
+           * @return profile
+           */
+          virtual Complex GetProfile(const LatticePosition& x) const = 0;
 
-          //virtual LatticeVelocity GetVelocity2(const util::Vector3D<site_t> globalCoordinates,
-          //                                                          const LatticeTimeStep t) const = 0;
+          /**
+           * Get the temporal part of the velocity at a time.
+           *
+           * @param t time
+           * @return time factor
+           */
+          virtual Complex GetTimeFactor(const LatticeTimeStep t) const = 0;
 
         protected:
           LatticeDistance radius;
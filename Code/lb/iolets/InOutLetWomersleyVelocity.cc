@@ -18,23 +18,25 @@ namespace hemelb::lb
         return copy;
       }
 
-      LatticeVelocity InOutLetWomersleyVelocity::GetVelocity(const LatticePosition& x,
-                                                             const LatticeTimeStep t) const
+      InOutLetVelocity::Complex InOutLetWomersleyVelocity::GetProfile(const LatticePosition& x) const
       {
         LatticePosition displ = x - position;
         LatticeDistance z = Dot(displ, normal);
         Dimensionless r = sqrt(displ.GetMagnitudeSquared() - z * z);
 
-        double omega = 2.0 * PI / period;
-        LatticeDensity density = 1.0;
-
         Complex besselNumer = util::BesselJ0ComplexArgument(iPowThreeHalves * womersleyNumber * r
             / radius);
         Complex besselDenom = util::BesselJ0ComplexArgument(iPowThreeHalves * womersleyNumber);
-        LatticeSpeed velocityMagnitude = std::real(pressureGradientAmplitude / (density * omega)
-            * (1.0 - besselNumer / besselDenom) * exp(i * omega * double(t)));
+        return 1.0 - besselNumer / besselDenom;
+      }
+
+      InOutLetVelocity::Complex InOutLetWomersleyVelocity::GetTimeFactor(const LatticeTimeStep t) const
+      {
+        double omega = 2.0 * PI / period;
+        LatticeDensity density = 1.0;
 
-        return normal * -velocityMagnitude;
+        // The velocity is against the normal when the pressure gradient is positive
+        return -pressureGradientAmplitude / (density * omega) * exp(i * omega * double(t));
       }
 
       const LatticePressureGradient& InOutLetWomersleyVelocity::GetPressureGradientAmplitude() const
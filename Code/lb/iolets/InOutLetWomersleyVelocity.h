@@ -38,13 +38,22 @@ namespace hemelb::lb
           [[nodiscard]] InOutLet* clone() const override;
 
           /**
-           * Get Womersley velocity for a given time and position.
+           * Get the Womersley mode shape, 1 - J0(i^(3/2) alpha r / R) / J0(i^(3/2) alpha),
+           * at a position.
            *
            * @param x lattice site position
+           * @return profile
+           */
+          Complex GetProfile(const LatticePosition& x) const override;
+
+          /**
+           * Get the oscillation, -pressureGradientAmplitude / omega * exp(i omega t),
+           * at a time.
+           *
            * @param t time
-           * @return velocity
+           * @return time factor
            */
-          LatticeVelocity GetVelocity(const LatticePosition& x, const LatticeTimeStep t) const override;
+          Complex GetTimeFactor(const LatticeTimeStep t) const override;
 
           /**
            * Get the amplitude of the zero average pressure gradient sine wave imposed.
@@ -89,7 +98,6 @@ namespace hemelb::lb
           void SetWomersleyNumber(const Dimensionless& womNumber);
 
         private:
-          typedef std::complex<double> Complex;
           static const Complex i;
           static const Complex iPowThreeHalves;
           LatticePressureGradient pressureGradientAmplitude; ///< See class documentation
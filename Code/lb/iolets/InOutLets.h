@@ -13,5 +13,6 @@
 #include "lb/iolets/InOutLetParabolicVelocity.h"
 #include "lb/iolets/InOutLetWomersleyVelocity.h"
 #include "lb/iolets/InOutLetFileVelocity.h"
+#include "lb/iolets/IoletTimeSeries.h"
 
 #endif /* HEMELB_LB_IOLETS_INOUTLETS_H */
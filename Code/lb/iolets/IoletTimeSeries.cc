@@ -0,0 +1,112 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "lb/iolets/IoletTimeSeries.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <span>
+#include <string>
+
+#include "Exception.h"
+#include "log/Logger.h"
+#include "net/MpiCommunicator.h"
+
+namespace hemelb::lb
+{
+      IoletTimeSeries::IoletTimeSeries(std::vector<double> times, std::vector<double> values) :
+          times(std::move(times)), values(std::move(values))
+      {
+        if (this->times.size() != this->values.size())
+          throw Exception() << "Iolet time series has " << this->times.size() << " times but "
+                            << this->values.size() << " values";
+        if (this->times.size() < 2)
+          throw Exception() << "Iolet time series needs at least two samples, not " << this->times.size();
+        if (std::adjacent_find(this->times.begin(), this->times.end(), std::greater_equal<>()) != this->times.end())
+          throw Exception() << "Iolet time series times are not strictly increasing";
+      }
+
+      IoletTimeSeries IoletTimeSeries::Read(const std::filesystem::path& path)
+      {
+        if (!std::filesystem::exists(path))
+          throw Exception() << "File does not exist: " << path;
+
+        std::ifstream datafile(path);
+        log::Logger::Log<log::Debug, log::OnePerCore>("Reading iolet values from file: %s", path.c_str());
+
+        // The map keeps the times sorted and unique
+        std::map<double, double> samples;
+        double time, value;
+        while (datafile >> time >> value)
+        {
+          log::Logger::Log<log::Trace, log::OnePerCore>("Time: %f Value: %f", time, value);
+          samples[time] = value;
+        }
+        if (!datafile.eof())
+          throw Exception() << "Could not parse iolet values in " << path;
+
+        std::vector<double> times, values;
+        times.reserve(samples.size());
+        values.reserve(samples.size());
+        for (auto [t, v]: samples)
+        {
+          times.push_back(t);
+          values.push_back(v);
+        }
+        return {std::move(times), std::move(values)};
+      }
+
+      IoletTimeSeries IoletTimeSeries::Read(const std::filesystem::path& path,
+                                            const net::MpiCommunicator& comms, int root)
+      {
+        std::vector<double> times, values;
+        // Negative if the root could not read the file, so that all throw
+        int count = 0;
+        std::string error;
+        if (comms.Rank() == root)
+        {
+          try
+          {
+            auto series = Read(path);
+            times = std::move(series.times);
+            values = std::move(series.values);
+            count = int(times.size());
+          }
+          catch (const std::exception& e)
+          {
+            error = e.what();
+            count = -1;
+          }
+        }
+
+        comms.Broadcast(count, root);
+        if (count < 0)
+        {
+          comms.Broadcast(error, root);
+          throw Exception() << error;
+        }
+
+        times.resize(count);
+        values.resize(count);
+        comms.Broadcast(std::span<double>(times), root);
+        comms.Broadcast(std::span<double>(values), root);
+        return {std::move(times), std::move(values)};
+      }
+
+      double IoletTimeSeries::Interpolate(double t) const
+      {
+        if (!(t > times.front()))
+          return values.front();
+        if (!(t < times.back()))
+          return values.back();
+
+        // The first sample after t, and the one before it
+        auto const upper = std::size_t(std::upper_bound(times.begin(), times.end(), t) - times.begin());
+        auto const lower = upper - 1;
+        return std::lerp(values[lower], values[upper], (t - times[lower]) / (times[upper] - times[lower]));
+      }
+}
@@ -0,0 +1,66 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_LB_IOLETS_IOLETTIMESERIES_H
+#define HEMELB_LB_IOLETS_IOLETTIMESERIES_H
+
+#include <filesystem>
+#include <vector>
+
+namespace hemelb::net { class MpiCommunicator; }
+
+namespace hemelb::lb
+{
+      /**
+       * The samples of a file driven iolet: times, sorted and unique,
+       * and the value at each, interpolated linearly between them on
+       * demand. This replaces tables with an entry per time step of
+       * the run, which for long runs with many iolets cost far more
+       * memory (and time to fill) than the handful of samples in the
+       * file.
+       *
+       * Files are text, with a time and value per line. Where a time
+       * appears more than once, the last value is kept.
+       */
+      class IoletTimeSeries
+      {
+        public:
+          IoletTimeSeries(std::vector<double> times, std::vector<double> values);
+
+          /**
+           * Read the samples from a file on this process alone.
+           * @param path
+           */
+          static IoletTimeSeries Read(const std::filesystem::path& path);
+
+          /**
+           * Read the samples from a file on the root process and
+           * broadcast them to the others. Collective.
+           * @param path
+           * @param comms
+           * @param root
+           */
+          static IoletTimeSeries Read(const std::filesystem::path& path,
+                                      const net::MpiCommunicator& comms, int root);
+
+          const std::vector<double>& GetTimes() const
+          {
+            return times;
+          }
+          const std::vector<double>& GetValues() const
+          {
+            return values;
+          }
+
+          //! The value at time t, held constant beyond the first and last samples
+          double Interpolate(double t) const;
+
+        private:
+          std::vector<double> times;
+          std::vector<double> values;
+      };
+}
+
+#endif /* HEMELB_LB_IOLETS_IOLETTIMESERIES_H */
@@ -7,6 +7,7 @@
 #define HEMELB_LB_KERNELS_LBGKNN_H
 
 #include <cmath>
+#include <optional>
 
 #include "hassert.h"
 #include "units.h"
@@ -14,6 +15,7 @@
 #include "lb/HydroVars.h"
 #include "lb/LbmParameters.h"
 #include "lb/SimulationState.h"
+#include "lb/kernels/ViscosityTable.h"
 
 namespace hemelb::lb
 {
@@ -61,6 +63,13 @@ namespace hemelb::lb
                   mLbParams(*initParams.lbmParams),
                   mRheo(initParams)
         {
+            if (mLbParams.ViscosityTableTolerance > 0)
+            {
+                mTauTable.emplace([this](PhysicalRate shearRate) {
+                                      return mRheo.CalculateTauForShearRate(shearRate, 1.0, mLbParams);
+                                  },
+                                  mLbParams.ViscosityTableTolerance);
+            }
         }
 
         void CalculateDensityMomentumFeq(VarsType& hydroVars, site_t index)
@@ -138,6 +147,9 @@ namespace hemelb::lb
         // Our rheology model
         tRheologyModel mRheo;
 
+        // Tabulated tau, if enabled. The models ignore the density.
+        std::optional<ViscosityTable> mTauTable;
+
         /**
          *  Helper method to update the value of local relaxation time (tau) from a given hydrodynamic
          *  configuration. It requires values of f_neq and density at the current time step and it will
@@ -157,10 +169,13 @@ namespace hemelb::lb
                                                                 hydroVars.f_neq,
                                                                 hydroVars.density) / mLbParams.GetTimeStep();
 
-            // Update tau
-            localTau = mRheo.CalculateTauForShearRate(shear_rate,
-						      hydroVars.density,
-						      mLbParams);
+            // Update tau, from the table if it covers this shear rate
+            std::optional<LatticeTime> tabulated;
+            if (mTauTable)
+                tabulated = mTauTable->Lookup(shear_rate);
+            localTau = tabulated ? *tabulated : mRheo.CalculateTauForShearRate(shear_rate,
+                                                                               hydroVars.density,
+                                                                               mLbParams);
 
             // In some rheology models viscosity tends to infinity as shear rate goes to zero.
             HASSERT(!std::isinf(localTau));
@@ -7,6 +7,7 @@
 #define HEMELB_LB_KERNELS_MRT_H
 
 #include "lb/SimulationState.h"
+#include "lb/kernels/basis_helpers.h"
 #include <cassert>
 #include <cmath>
 
@@ -73,36 +74,34 @@ namespace hemelb::lb
         void CalculateFeq(VarsType& hydroVars, site_t index)
         {
             LatticeType::CalculateFeq(hydroVars.density,
-                                               hydroVars.momentum,
-                                               hydroVars.f_eq.f);
+                                      hydroVars.momentum,
+                                      hydroVars.f_eq);
 
             for (unsigned int ii = 0; ii < NUMVECTORS; ++ii)
             {
-              hydroVars.f_neq.f[ii] = hydroVars.f[ii] - hydroVars.f_eq.f[ii];
+                hydroVars.f_neq[ii] = hydroVars.f[ii] - hydroVars.f_eq[ii];
             }
 
             /** @todo #222 consider computing m_neq directly in the moment space. See d'Humieres 2002. */
-            MomentType::ProjectVelsIntoMomentSpace(hydroVars.f_neq.f, hydroVars.m_neq);
-          }
+            ProjectVelsIntoMomentSpace(hydroVars.f_neq, hydroVars.m_neq);
+        }
 
         void Collide(const LbmParameters* const lbmParams, VarsType& hydroVars)
         {
+            // Relax the non-equilibrium moments, then take them back to
+            // velocity space with the (compile time) normalised basis
+            std::array<distribn_t, NUMMOMENTS> relaxed;
+            for (unsigned momentIndex = 0; momentIndex < NUMMOMENTS; ++momentIndex)
+            {
+                relaxed[momentIndex] = collisionMatrixDiagonals[momentIndex] * hydroVars.m_neq[momentIndex];
+            }
+            std::array<distribn_t, NUMVECTORS> collision;
+            unrolled_product<collisionBasis>::Apply(relaxed, collision);
             for (Direction direction = 0; direction < NUMVECTORS; ++direction)
             {
-              /** @todo #222 many optimisations possible (and necessary!).
-               *  - Compute the loop below as a matrix product in DoCalculate*, alternatively we could consider reimplementing DoCollide to work with whole arrays (consider libraries boost::ublas or Armadillo)
-               */
-              distribn_t collision = 0.;
-              for (unsigned momentIndex = 0; momentIndex < NUMMOMENTS;
-                  momentIndex++)
-              {
-                collision += collisionMatrixDiagonals[momentIndex]
-                             * normalisedReducedMomentBasis[momentIndex][direction]
-                             * hydroVars.m_neq[momentIndex];
-              }
-              hydroVars.SetFPostCollision(direction, hydroVars.f[direction] - collision);
+                hydroVars.SetFPostCollision(direction, hydroVars.f[direction] - collision[direction]);
             }
-          }
+        }
 
         /**
          *  This method is used in unit testing in order to make an MRT kernel behave as LBGK, regardless of the
@@ -123,15 +122,9 @@ namespace hemelb::lb
         static void ProjectVelsIntoMomentSpace(ConstDistSpan<NUMVECTORS> velDistributions,
                                                MutDistSpan<NUMMOMENTS> moments)
         {
-            for (unsigned momentIndex = 0; momentIndex < NUMMOMENTS; momentIndex++)
-            {
-                moments[momentIndex] = 0.;
-                for (Direction velocityIndex = 0; velocityIndex < NUMVECTORS; velocityIndex++)
-                {
-                    moments[momentIndex] +=
-                            MomentType::REDUCED_MOMENT_BASIS[momentIndex][velocityIndex] * velDistributions[velocityIndex];
-                }
-            }
+            // The basis is a small integer matrix, so unroll the product
+            // with its zeros dropped and its +-1s as adds
+            unrolled_product<MomentType::REDUCED_MOMENT_BASIS>::Apply(velDistributions, moments);
         }
 
         /** MRT collision matrix (\hat{S}, diagonal). It corresponds to the inverse of the relaxation time for each mode. */
@@ -150,6 +143,8 @@ namespace hemelb::lb
             return ans;
         }
         static constexpr MatrixType normalisedReducedMomentBasis = Normalise();
+        // Its transpose, to take relaxed moments to velocity space
+        static constexpr auto collisionBasis = MomentType::Traits::Transpose(normalisedReducedMomentBasis);
       };
 }
 
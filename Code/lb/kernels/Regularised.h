@@ -0,0 +1,208 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_LB_KERNELS_REGULARISED_H
+#define HEMELB_LB_KERNELS_REGULARISED_H
+
+#include <array>
+
+#include "constants.h"
+#include "lb/concepts.h"
+#include "lb/HydroVars.h"
+#include "lb/LbmParameters.h"
+#include "lb/kernels/basis_helpers.h"
+#include "lb/kernels/GuoForcingLBGK.h"
+
+namespace hemelb::lb
+{
+    /**
+     * Regularised: the regularised LBGK kernel of Latt and Chopard (2006)
+     * Lattice Boltzmann method with regularized pre-collision
+     * distribution functions. Math. Comput. Simul. 72, 165-168.
+     *
+     * Before relaxing, the non-equilibrium distribution is replaced by
+     * its projection onto the first and second order Hermite
+     * polynomials,
+     *
+     *   f_neq_i -> w_i (c_i . J / cs^2 + (c_i c_i - cs^2 I) : Pi / (2 cs^4)),
+     *
+     * where J and Pi are its first and second moments. This keeps the
+     * hydrodynamics of LBGK but discards the higher order (ghost)
+     * moments, which LBGK relaxes at the same rate as the stress and
+     * which are what become unstable as tau approaches 0.5. Lattices
+     * can then be coarser for the same viscosity and flow.
+     */
+    template<lattice_type L>
+    class Regularised
+    {
+    public:
+        using LatticeType = L;
+        using VarsType = HydroVars<Regularised>;
+        using const_span = typename LatticeType::const_span;
+        using mut_span = typename LatticeType::mut_span;
+
+        Regularised(InitParams& initParams)
+        {
+        }
+
+        void CalculateDensityMomentumFeq(VarsType& hydroVars, site_t index)
+        {
+            LatticeType::CalculateDensityMomentumFEq(hydroVars.f,
+                                                     hydroVars.density,
+                                                     hydroVars.momentum,
+                                                     hydroVars.velocity,
+                                                     hydroVars.f_eq);
+
+            for (unsigned int ii = 0; ii < LatticeType::NUMVECTORS; ++ii)
+            {
+                hydroVars.f_neq[ii] = hydroVars.f[ii] - hydroVars.f_eq[ii];
+            }
+        }
+
+        void CalculateFeq(VarsType& hydroVars, site_t index)
+        {
+            LatticeType::CalculateFeq(hydroVars.density, hydroVars.momentum, hydroVars.f_eq);
+
+            for (unsigned int ii = 0; ii < LatticeType::NUMVECTORS; ++ii)
+            {
+                hydroVars.f_neq[ii] = hydroVars.f[ii] - hydroVars.f_eq[ii];
+            }
+        }
+
+        void Collide(const LbmParameters* const lbmParams, VarsType& hydroVars)
+        {
+            FVector<LatticeType> regularised;
+            Regularise(hydroVars.f_neq, regularised);
+
+            for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+            {
+                hydroVars.SetFPostCollision(direction,
+                                            hydroVars.f_eq[direction]
+                                                + (1.0 + lbmParams->GetOmega()) * regularised[direction]);
+            }
+        }
+
+        /**
+         * Projects a non-equilibrium distribution onto the first and
+         * second order Hermite polynomials.
+         * @param f_neq
+         * @param regularised
+         */
+        static void Regularise(const_span f_neq, mut_span regularised)
+        {
+            std::array<distribn_t, MOMENTS> moments;
+            unrolled_product<MOMENT_BASIS>::Apply(f_neq, moments);
+            unrolled_product<PROJECTION>::Apply(moments, regularised);
+        }
+
+    private:
+        // J and the upper triangle of Pi
+        static constexpr std::size_t MOMENTS = 9;
+
+        // Rows c_x, c_y, c_z, c_x c_x, c_y c_y, c_z c_z, c_x c_y, c_x c_z, c_y c_z
+        static constexpr auto MOMENT_BASIS = [] {
+            std::array<std::array<distribn_t, LatticeType::NUMVECTORS>, MOMENTS> ans{};
+            for (std::size_t i = 0; i < LatticeType::NUMVECTORS; ++i)
+            {
+                std::array<distribn_t, 3> const c = {LatticeType::CXD[i], LatticeType::CYD[i], LatticeType::CZD[i]};
+                ans[0][i] = c[0];
+                ans[1][i] = c[1];
+                ans[2][i] = c[2];
+                ans[3][i] = c[0] * c[0];
+                ans[4][i] = c[1] * c[1];
+                ans[5][i] = c[2] * c[2];
+                ans[6][i] = c[0] * c[1];
+                ans[7][i] = c[0] * c[2];
+                ans[8][i] = c[1] * c[2];
+            }
+            return ans;
+        }();
+
+        // The Hermite series of the moments: row i is
+        // w_i (c_i / cs^2, (c_i c_i - cs^2 I) / (2 cs^4)) in the same order,
+        // the off-diagonal terms counted twice
+        static constexpr auto PROJECTION = [] {
+            constexpr auto invCs2 = 1.0 / Cs2;
+            constexpr auto halfInvCs4 = 0.5 * invCs2 * invCs2;
+            std::array<std::array<distribn_t, MOMENTS>, LatticeType::NUMVECTORS> ans{};
+            for (std::size_t i = 0; i < LatticeType::NUMVECTORS; ++i)
+            {
+                auto const w = LatticeType::EQMWEIGHTS[i];
+                for (std::size_t m = 0; m < 3; ++m)
+                    ans[i][m] = w * invCs2 * MOMENT_BASIS[m][i];
+                for (std::size_t m = 3; m < 6; ++m)
+                    ans[i][m] = w * halfInvCs4 * (MOMENT_BASIS[m][i] - Cs2);
+                for (std::size_t m = 6; m < MOMENTS; ++m)
+                    ans[i][m] = w * halfInvCs4 * 2.0 * MOMENT_BASIS[m][i];
+            }
+            return ans;
+        }();
+    };
+
+    /**
+     * GuoForcingRegularised: the regularised kernel with Guo forcing,
+     * as GuoForcingLBGK. The half force included in the equilibrium
+     * momentum appears as a first moment of f_neq, which the
+     * regularisation keeps, so the momentum gained is the force.
+     */
+    template<lattice_type L>
+    class GuoForcingRegularised
+    {
+    public:
+        using LatticeType = L;
+        using VarsType = HydroVars<GuoForcingRegularised>;
+
+        GuoForcingRegularised(InitParams& initParams)
+        {
+        }
+
+        void CalculateDensityMomentumFeq(VarsType& hydroVars, site_t index)
+        {
+            LatticeType::CalculateDensityMomentumFEq(hydroVars.f,
+                                                     hydroVars.force,
+                                                     hydroVars.density,
+                                                     hydroVars.momentum,
+                                                     hydroVars.velocity,
+                                                     hydroVars.f_eq);
+
+            for (unsigned int ii = 0; ii < LatticeType::NUMVECTORS; ++ii)
+                hydroVars.f_neq[ii] = hydroVars.f[ii] - hydroVars.f_eq[ii];
+        }
+
+        void CalculateFeq(VarsType& hydroVars, site_t index)
+        {
+            LatticeType::CalculateFeq(hydroVars.density, hydroVars.momentum, hydroVars.f_eq);
+
+            for (unsigned int ii = 0; ii < LatticeType::NUMVECTORS; ++ii)
+                hydroVars.f_neq[ii] = hydroVars.f[ii] - hydroVars.f_eq[ii];
+        }
+
+        void Collide(const LbmParameters* const lbmParams, VarsType& hydroVars)
+        {
+            LatticeType::CalculateForceDistribution(lbmParams->GetTau(),
+                                                    hydroVars.velocity,
+                                                    hydroVars.force,
+                                                    hydroVars.forceDist);
+
+            FVector<LatticeType> regularised;
+            Regularised<LatticeType>::Regularise(hydroVars.f_neq, regularised);
+
+            for (Direction dir = 0; dir < LatticeType::NUMVECTORS; ++dir)
+                hydroVars.SetFPostCollision(dir,
+                                            hydroVars.f_eq[dir]
+                                            + (1.0 + lbmParams->GetOmega()) * regularised[dir]
+                                            + hydroVars.forceDist[dir]);
+        }
+    };
+
+    template<lattice_type LatticeType>
+    struct HydroVars<GuoForcingRegularised<LatticeType> > : HydroVars<GuoForcingLBGK<LatticeType> >
+    {
+        friend class GuoForcingRegularised<LatticeType>;
+        using HydroVars<GuoForcingLBGK<LatticeType> >::HydroVars;
+    };
+}
+
+#endif /* HEMELB_LB_KERNELS_REGULARISED_H */
@@ -0,0 +1,137 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_LB_KERNELS_VISCOSITYTABLE_H
+#define HEMELB_LB_KERNELS_VISCOSITYTABLE_H
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "Exception.h"
+#include "units.h"
+
+namespace hemelb::lb
+{
+    /**
+     * Piecewise linear table of the relaxation time as a function of
+     * shear rate, to spare non-Newtonian kernels evaluating their
+     * rheology model (pow, sqrt, ...) at every site and step.
+     *
+     * Each octave of shear rates [2^e, 2^(e+1)) from MIN_RATE to
+     * MAX_RATE is split into the same power of two number of equal
+     * segments, so a segment is found from the bits of the shear rate
+     * alone. The segments are refined at construction until the
+     * relative error in tau, sampled within each segment, is within
+     * the tolerance in all but a few of them. Those few, e.g. at a
+     * kink where the model is bounded, are left to the exact model.
+     */
+    class ViscosityTable
+    {
+    public:
+        // Shear rates (s^-1) covered by the table
+        static constexpr double MIN_RATE = 0x1p-24;
+        static constexpr double MAX_RATE = 0x1p24;
+
+        /**
+         * Tabulates tau for shear rates from MIN_RATE to MAX_RATE.
+         * @param tau callable giving the exact tau for a shear rate (s^-1)
+         * @param tolerance maximum relative error in tau
+         */
+        template <typename F>
+        ViscosityTable(F&& tau, double tolerance);
+
+        //! The tabulated tau for the shear rate (s^-1), or nothing if
+        //! it is outside the table or in a segment left to the model
+        std::optional<LatticeTime> Lookup(PhysicalRate shearRate) const
+        {
+            if (!(shearRate >= MIN_RATE && shearRate < MAX_RATE))
+                return std::nullopt;
+            auto const& segment = segments[(std::bit_cast<std::uint64_t>(shearRate) >> shift) - offset];
+            if (std::isnan(segment.slope))
+                return std::nullopt;
+            return segment.intercept + segment.slope * shearRate;
+        }
+
+        //! Segments per octave of shear rate
+        unsigned GetSegmentsPerOctave() const
+        {
+            return 1U << (MANTISSA_BITS - shift);
+        }
+
+    private:
+        static constexpr unsigned MANTISSA_BITS = 52;
+        static constexpr unsigned EXPONENT_BIAS = 1023;
+        static constexpr int MIN_EXPONENT = -24;
+        static constexpr unsigned OCTAVES = 48;
+        static constexpr unsigned MAX_SEGMENTS_LOG2 = 12;
+        // Segments that may be left to the exact model
+        static constexpr std::size_t MAX_EXACT_SEGMENTS = 8;
+
+        // A NaN slope leaves the segment to the exact model
+        struct Segment
+        {
+            double intercept;
+            double slope;
+        };
+
+        std::vector<Segment> segments;
+        // The segment of a shear rate is its bits >> shift, less offset
+        unsigned shift;
+        std::uint64_t offset;
+    };
+
+    template <typename F>
+    ViscosityTable::ViscosityTable(F&& tau, double tolerance)
+    {
+        for (unsigned segmentsLog2 = 2; segmentsLog2 <= MAX_SEGMENTS_LOG2; ++segmentsLog2)
+        {
+            unsigned const perOctave = 1U << segmentsLog2;
+            shift = MANTISSA_BITS - segmentsLog2;
+            offset = std::uint64_t(MIN_EXPONENT + EXPONENT_BIAS) << segmentsLog2;
+
+            // The ends of segment i are the nodes i and i + 1
+            std::vector<double> rates(OCTAVES * perOctave + 1);
+            std::vector<double> taus(rates.size());
+            for (std::size_t node = 0; node < rates.size(); ++node)
+            {
+                rates[node] = std::ldexp(1.0 + double(node % perOctave) / perOctave,
+                                         MIN_EXPONENT + int(node / perOctave));
+                taus[node] = tau(rates[node]);
+            }
+
+            segments.resize(OCTAVES * perOctave);
+            std::vector<std::size_t> inexact;
+            for (std::size_t i = 0; i < segments.size(); ++i)
+            {
+                auto const slope = (taus[i + 1] - taus[i]) / (rates[i + 1] - rates[i]);
+                segments[i] = {taus[i] - slope * rates[i], slope};
+                for (int sample = 1; sample < 8; ++sample)
+                {
+                    auto const rate = rates[i] + (rates[i + 1] - rates[i]) * sample / 8;
+                    auto const exact = tau(rate);
+                    // Written so that a NaN fails
+                    if (!(std::abs(segments[i].intercept + slope * rate - exact) <= tolerance * std::abs(exact)))
+                    {
+                        inexact.push_back(i);
+                        break;
+                    }
+                }
+            }
+            if (inexact.size() <= MAX_EXACT_SEGMENTS)
+            {
+                for (auto i: inexact)
+                    segments[i].slope = std::nan("");
+                return;
+            }
+        }
+        throw Exception() << "Cannot tabulate the rheology model to a relative error of " << tolerance
+                          << " with " << (1U << MAX_SEGMENTS_LOG2) << " segments per octave";
+    }
+}
+
+#endif // HEMELB_LB_KERNELS_VISCOSITYTABLE_H
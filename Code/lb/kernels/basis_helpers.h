@@ -8,6 +8,7 @@
 
 #include <array>
 #include <numeric>
+#include <utility>
 
 namespace hemelb::lb {
 
@@ -23,7 +24,72 @@ namespace hemelb::lb {
             }
             return ans;
         }
+
+        static constexpr auto Transpose(MatrixType const &mat) {
+            std::array<std::array<T, NUM_MOMS>, NUM_VELS> ans;
+            for (unsigned i = 0; i < NUM_MOMS; ++i)
+                for (unsigned j = 0; j < NUM_VELS; ++j)
+                    ans[j][i] = mat[i][j];
+            return ans;
+        }
     };
 
+    // Product of a constexpr matrix with a vector, unrolled at compile
+    // time: zero entries are dropped and entries of +-1 need no
+    // multiply, so it costs only as much as the matrix is dense.
+    template<auto const &MAT>
+    struct unrolled_product {
+        static constexpr std::size_t ROWS = MAT.size();
+        static constexpr std::size_t COLS = MAT[0].size();
+
+        // Columns of the non-zero entries of a row
+        template<std::size_t ROW>
+        static constexpr auto NonZeros() {
+            constexpr auto n = [] {
+                std::size_t count = 0;
+                for (auto x: MAT[ROW])
+                    count += x != 0;
+                return count;
+            }();
+            std::array<std::size_t, n> ans{};
+            std::size_t j = 0;
+            for (std::size_t col = 0; col < COLS; ++col)
+                if (MAT[ROW][col] != 0)
+                    ans[j++] = col;
+            return ans;
+        }
+        template<std::size_t ROW>
+        static constexpr auto NON_ZEROS = NonZeros<ROW>();
+
+        template<std::size_t ROW, std::size_t COL, typename V>
+        static auto Term(V const &v) {
+            constexpr auto coeff = MAT[ROW][COL];
+            if constexpr (coeff == 1)
+                return v[COL];
+            else if constexpr (coeff == -1)
+                return -v[COL];
+            else
+                return coeff * v[COL];
+        }
+
+        template<std::size_t ROW, typename V>
+        static auto Row(V const &v) {
+            constexpr auto &nz = NON_ZEROS<ROW>;
+            if constexpr (nz.empty())
+                return decltype(Term<ROW, 0>(v)){0};
+            else
+                return [&]<std::size_t... K>(std::index_sequence<K...>) {
+                    return (... + Term<ROW, nz[K]>(v));
+                }(std::make_index_sequence<nz.size()>{});
+        }
+
+        // out = MAT * in
+        template<typename In, typename Out>
+        static void Apply(In const &in, Out &&out) {
+            [&]<std::size_t... R>(std::index_sequence<R...>) {
+                ((out[R] = Row<R>(in)), ...);
+            }(std::make_index_sequence<ROWS>{});
+        }
+    };
 }
 #endif
\ No newline at end of file
@@ -13,9 +13,11 @@
 #include "lb/InitialCondition.h"
 #include "lb/iolets/BoundaryValues.h"
 #include "lb/MacroscopicPropertyCache.h"
+#include "lb/TemporalBlocking.h"
 #include "util/UnitConverter.h"
 #include "reporting/Timers.h"
 #include "Traits.h"
+#include <optional>
 #include <typeinfo>
 
 /**
@@ -82,8 +84,22 @@ namespace hemelb::lb
         hemelb::lb::LbmParameters *GetLbmParams();
         lb::MacroscopicPropertyCache& GetPropertyCache();
 
+        /**
+         * Advance the direct sites of the domain several time steps at
+         * a time, between synchronisation steps; see TemporalBlocking.
+         * A depth of 1 steps all sites together.
+         * @param depth time steps per cycle
+         */
+        void SetTemporalBlocking(unsigned depth);
+
+        //! The first step at or after the step when all sites are at the same time
+        [[nodiscard]] LatticeTimeStep GetNextSyncTimeStep(LatticeTimeStep step) const;
+
       private:
 
+        // Stream and collide the direct sites as due this step
+        void StreamAndCollideDirectSites();
+
         void InitCollisions();
         // The following function pair simplify initialising the site ranges for each collider object.
         void InitInitParamsSiteRanges(InitParams& initParams, unsigned& state);
@@ -138,6 +154,10 @@ namespace hemelb::lb
 
         MacroscopicPropertyCache propertyCache;
 
+        std::optional<TemporalBlocking> temporalBlocking;
+        // Step within the current temporal blocking cycle, if in one
+        std::optional<unsigned> blockingPhase;
+
         geometry::neighbouring::NeighbouringDataManager *neighbouringDataManager;
     };
 
@@ -229,7 +229,10 @@ namespace hemelb::lb
       site_t offset = 0;
 
       log::Logger::Log<log::Debug, log::OnePerCore>("LBM - PreReceive - StreamAndCollide");
-      StreamAndCollide(*mMidFluidCollision, offset, dom.GetMidDomainCollisionCount(0));
+      // With temporal blocking, the direct sites (which come first) go
+      // last, as they may step ahead of their neighbours
+      auto const direct = temporalBlocking ? dom.GetDirectSiteCount() : 0;
+      StreamAndCollide(*mMidFluidCollision, offset + direct, dom.GetMidDomainCollisionCount(0) - direct);
       offset += dom.GetMidDomainCollisionCount(0);
 
       StreamAndCollide(*mWallCollision, offset, dom.GetMidDomainCollisionCount(1));
@@ -246,10 +249,40 @@ namespace hemelb::lb
 
       StreamAndCollide(*mOutletWallCollision, offset, dom.GetMidDomainCollisionCount(5));
 
+      if (temporalBlocking)
+        StreamAndCollideDirectSites();
+
       timings[hemelb::reporting::Timers::lb_calc].Stop();
       timings[hemelb::reporting::Timers::lb].Stop();
     }
 
+    template<class TRAITS>
+    void LBM<TRAITS>::StreamAndCollideDirectSites()
+    {
+      if (!blockingPhase && temporalBlocking->StartsCycle(mState->GetTimeStep(), mState->GetTotalTimeSteps()))
+        blockingPhase = 0;
+
+      if (!blockingPhase)
+      {
+        StreamAndCollide(*mMidFluidCollision, 0, mLatDat->GetDomain().GetDirectSiteCount());
+        return;
+      }
+
+      // Sites an odd number of steps ahead have the distribution arrays
+      // the other way round
+      auto advance = [&](TemporalBlocking::Range const& range, unsigned ahead) {
+        if (ahead % 2)
+          mLatDat->SwapOldAndNew();
+        StreamAndCollide(*mMidFluidCollision, range.first, range.count);
+        if (ahead % 2)
+          mLatDat->SwapOldAndNew();
+      };
+      if (*blockingPhase == 0)
+        temporalBlocking->ForEachFirstStepRange(advance);
+      else
+        temporalBlocking->ForEachLaterStepRange(*blockingPhase, advance);
+    }
+
     template<class TRAITS>
     void LBM<TRAITS>::PostReceive()
     {
@@ -311,6 +344,24 @@ namespace hemelb::lb
     template<class TRAITS>
     void LBM<TRAITS>::EndIteration()
     {
+      if (blockingPhase && ++*blockingPhase == temporalBlocking->GetDepth())
+        blockingPhase.reset();
+    }
+
+    template<class TRAITS>
+    void LBM<TRAITS>::SetTemporalBlocking(unsigned depth)
+    {
+      if (depth > 1)
+        temporalBlocking = TemporalBlocking::Build<LatticeType>(mLatDat->GetDomain(), depth);
+      else
+        temporalBlocking.reset();
+      blockingPhase.reset();
+    }
+
+    template<class TRAITS>
+    LatticeTimeStep LBM<TRAITS>::GetNextSyncTimeStep(LatticeTimeStep step) const
+    {
+      return temporalBlocking ? temporalBlocking->GetNextSyncStep(step) : step;
     }
 }
 
@@ -8,6 +8,7 @@
 
 #include "lb/iolets/BoundaryValues.h"
 #include "lb/iolets/InOutLetVelocity.h"
+#include "lb/streamers/IoletVelocityProfiles.h"
 #include "geometry/neighbouring/RequiredSiteInformation.h"
 #include "geometry/neighbouring/NeighbouringDataManager.h"
 #include "util/Vector3D.h"
@@ -31,7 +32,7 @@ namespace hemelb::lb
         GuoZhengShiLink(CollisionType& delegatorCollider, InitParams& initParams) :
                 collider(delegatorCollider),
                 neighbouringLatticeData(initParams.latDat->GetNeighbouringData()),
-                bValues(initParams.boundaryObject), bbDelegate(delegatorCollider, initParams)
+                profiles(initParams, 1.0), bbDelegate(delegatorCollider, initParams)
         {
             // Want to loop over each site this streamer is responsible for,
             // as specified in the siteRanges.
@@ -164,9 +165,7 @@ namespace hemelb::lb
             {
               if (site.HasIolet(i))
               {
-                int boundaryId = site.GetIoletId();
-                auto iolet = dynamic_cast<InOutLetVelocity*>(bValues->GetLocalIolet(boundaryId));
-                if (iolet == nullptr)
+                if (profiles.GetIolet(site.GetIoletId()) == nullptr)
                 {
                   // SBB
                   return bbDelegate.StreamLink(lbmParams, latDat, site, hydroVars, iPrime);
@@ -176,13 +175,7 @@ namespace hemelb::lb
                   // Modified GZS - there is a velocity iolet blocking the neighbouring
                   // site who's data we would use for the second extrapolation.
                   // Use the imposed condition instead.
-                  LatticePosition sitePos(site.GetGlobalSiteCoords());
-
-                  LatticePosition neighPos(sitePos);
-                  neighPos += LatticeType::CD[i];
-
-                  LatticeVelocity neighbourVelocity(iolet->GetVelocity(neighPos,
-                                                                       bValues->GetTimeStep()));
+                  LatticeVelocity neighbourVelocity(profiles.GetVelocity(site, i));
 
                   // Obtain a second estimate, this time ignoring the fluid site closest to
                   // the wall. Interpolating the next site away and the site within the wall
@@ -316,7 +309,8 @@ namespace hemelb::lb
         // the collision
         CollisionType collider;
         const geometry::neighbouring::NeighbouringDomain& neighbouringLatticeData;
-        BoundaryValues* bValues;
+        // The iolet velocity at the far end of each link
+        IoletVelocityProfiles<LatticeType> profiles;
         BounceBackLink<CollisionType> bbDelegate;
     };
 
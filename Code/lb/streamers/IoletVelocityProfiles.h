@@ -0,0 +1,155 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_LB_STREAMERS_IOLETVELOCITYPROFILES_H
+#define HEMELB_LB_STREAMERS_IOLETVELOCITYPROFILES_H
+
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "lb/concepts.h"
+#include "lb/LbmParameters.h"
+#include "lb/iolets/BoundaryValues.h"
+#include "lb/iolets/InOutLetVelocity.h"
+
+namespace hemelb::lb
+{
+    /**
+     * The velocities imposed by velocity iolets at the point a given
+     * fraction of the way along each iolet link of a streamer's sites.
+     *
+     * The spatial profile at each point (see InOutLetVelocity) is found
+     * on construction, after the iolets have been initialised, and the
+     * time factor once per iolet per time step, so each velocity is
+     * then a complex multiply. This spares, e.g., the two Bessel
+     * functions of a Womersley iolet for every link at every step.
+     */
+    template<lattice_type LatticeType>
+    class IoletVelocityProfiles
+    {
+        using Complex = InOutLetVelocity::Complex;
+
+    public:
+        /**
+         * @param initParams the sites and boundary values of the streamer
+         * @param linkFraction how far along each link the velocity is wanted
+         */
+        IoletVelocityProfiles(InitParams& initParams, LatticeDistance linkFraction) :
+                bValues(initParams.boundaryObject), linkFraction(linkFraction)
+        {
+            // Ranges without iolet links (e.g. of a wall streamer) are left out
+            for (auto [first, last]: initParams.siteRanges)
+            {
+                Range const range{first, last, profiles.size()};
+                for (site_t siteIndex = first; siteIndex < last; ++siteIndex)
+                {
+                    auto const site = initParams.latDat->GetSite(siteIndex);
+                    for (Direction i = 0; i < LatticeType::NUMVECTORS; ++i)
+                    {
+                        // Only sites with iolet links are sure to have an iolet
+                        if (!site.HasIolet(i))
+                            continue;
+                        if (profiles.size() == range.offset)
+                        {
+                            profiles.resize(range.offset + (last - first) * LatticeType::NUMVECTORS, UNKNOWN);
+                            ranges.push_back(range);
+                        }
+                        if (auto iolet = GetIolet(site.GetIoletId()))
+                            profiles[range.offset + (siteIndex - first) * LatticeType::NUMVECTORS + i] =
+                                    iolet->GetProfile(GetLinkPoint(site.GetGlobalSiteCoords(), i));
+                    }
+                }
+            }
+        }
+
+        //! The local iolet, if it imposes a velocity, else nullptr
+        InOutLetVelocity const* GetIolet(int ioletId)
+        {
+            return GetState(ioletId).iolet;
+        }
+
+        /**
+         * The velocity imposed by the site's iolet at the point on the
+         * link in direction i, at the current time step. The site must
+         * have a link to a velocity iolet in that direction.
+         *
+         * Sites or links that were not iolet links of the streamer's
+         * sites on construction have their profile found every call.
+         */
+        template<typename SiteType>
+        LatticeVelocity GetVelocity(const SiteType& site, Direction i)
+        {
+            auto& state = GetState(site.GetIoletId());
+            auto const timeStep = bValues->GetTimeStep();
+            if (state.timeStep != timeStep)
+            {
+                state.timeFactor = state.iolet->GetTimeFactor(timeStep);
+                state.timeStep = timeStep;
+            }
+
+            Complex profile = GetProfile(site.GetIndex(), i);
+            if (std::isnan(profile.real()))
+                profile = state.iolet->GetProfile(GetLinkPoint(site.GetGlobalSiteCoords(), i));
+
+            return state.iolet->GetNormal() * std::real(profile * state.timeFactor);
+        }
+
+    private:
+        static constexpr Complex UNKNOWN{std::numeric_limits<double>::quiet_NaN(), 0.0};
+
+        // A range of site indices, and where its profiles start
+        struct Range
+        {
+            site_t first;
+            site_t last;
+            std::size_t offset;
+        };
+
+        struct IoletState
+        {
+            InOutLetVelocity const* iolet = nullptr;
+            // The time factor, and the time step it is for
+            std::optional<LatticeTimeStep> timeStep;
+            Complex timeFactor;
+        };
+
+        LatticePosition GetLinkPoint(const LatticeVector& siteCoords, Direction i) const
+        {
+            return LatticePosition(siteCoords) + LatticeType::CD[i] * linkFraction;
+        }
+
+        Complex GetProfile(site_t siteIndex, Direction i) const
+        {
+            for (auto const& range: ranges)
+                if (siteIndex >= range.first && siteIndex < range.last)
+                    return profiles[range.offset + (siteIndex - range.first) * LatticeType::NUMVECTORS + i];
+            return UNKNOWN;
+        }
+
+        // The boundary values are only looked at for sites with iolet
+        // links: other streamers may not have any
+        IoletState& GetState(int ioletId)
+        {
+            if (std::size_t(ioletId) >= iolets.size())
+                iolets.resize(ioletId + 1);
+            auto& state = iolets[ioletId];
+            if (!state)
+                state = IoletState{dynamic_cast<InOutLetVelocity const*>(bValues->GetLocalIolet(ioletId))};
+            return *state;
+        }
+
+        BoundaryValues* bValues;
+        LatticeDistance linkFraction;
+        std::vector<Range> ranges;
+        // For each site of each range, the profile along each link
+        std::vector<Complex> profiles;
+        // By local iolet id
+        std::vector<std::optional<IoletState>> iolets;
+    };
+}
+
+#endif // HEMELB_LB_STREAMERS_IOLETVELOCITYPROFILES_H
@@ -7,6 +7,7 @@
 #define HEMELB_LB_STREAMERS_LADDIOLET_H
 
 #include "lb/concepts.h"
+#include "lb/streamers/IoletVelocityProfiles.h"
 #include "lb/streamers/SimpleBounceBack.h"
 
 namespace hemelb::lb
@@ -22,7 +23,7 @@ namespace hemelb::lb
 
         LaddIoletLink(CollisionType& delegatorCollider, InitParams& initParams) :
                 BounceBackLink<CollisionType>(delegatorCollider, initParams),
-                bValues(initParams.boundaryObject)
+                profiles(initParams, 0.5)
         {
         }
 
@@ -42,15 +43,7 @@ namespace hemelb::lb
             // where u is the velocity of the boundary half way along the
             // link and a1_i = w_1 / cs2
 
-            int boundaryId = site.GetIoletId();
-            auto iolet = dynamic_cast<InOutLetVelocity*>(bValues->GetLocalIolet(boundaryId));
-            LatticePosition sitePos(site.GetGlobalSiteCoords());
-
-            LatticePosition halfWay(sitePos);
-            halfWay += 0.5 * LatticeType::VECTORS[ii];
-
-            LatticeVelocity wallMom(iolet->GetVelocity(halfWay, bValues->GetTimeStep()));
-            //TODO: Add site.GetGlobalSiteCoords() as a first argument?
+            LatticeVelocity wallMom(profiles.GetVelocity(site, ii));
 
             if (LatticeType::IsLatticeCompressible())
             {
@@ -65,7 +58,8 @@ namespace hemelb::lb
                     hydroVars.GetFPostCollision()[ii] - correction;
         }
     private:
-        BoundaryValues* bValues;
+        // The iolet velocity half way along each link
+        IoletVelocityProfiles<LatticeType> profiles;
     };
 
 }
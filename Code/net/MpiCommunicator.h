@@ -208,6 +208,14 @@ namespace hemelb::net
         template<typename T>
         std::vector<T> AllToAll(const std::vector<T>& vals) const;
 
+        /**
+         * Performs an all to all operation with variable amounts of data
+         * @param vals data for each process, indexed by destination rank
+         * @return data from each process, indexed by source rank
+         */
+        template<typename T>
+        displaced_data<T> AllToAllV(const displaced_data<T>& vals) const;
+
         template<typename T>
         void Send(const T& val, int dest, int tag = 0) const;
         template<typename T>
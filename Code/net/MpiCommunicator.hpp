@@ -207,6 +207,21 @@ namespace hemelb::net
       return ans;
     }
 
+    template<typename T>
+    displaced_data<T> MpiCommunicator::AllToAllV(const displaced_data<T>& vals) const
+    {
+      std::vector<int> sendSizes(vals.size());
+      for (std::size_t i = 0; i < vals.size(); ++i)
+        sendSizes[i] = vals.displacements[i + 1] - vals.displacements[i];
+      auto const receiveSizes = AllToAll(sendSizes);
+      auto ans = displaced_data<T>{receiveSizes};
+      HEMELB_MPI_CALL(MPI_Alltoallv,
+                      (vals.data.data(), sendSizes.data(), vals.displacements.data(), MpiDataType<T>(),
+                       ans.data.data(), receiveSizes.data(), ans.displacements.data(), MpiDataType<T>(),
+                       *this));
+      return ans;
+    }
+
     template<typename T>
     void MpiCommunicator::Send(const T& val, int dest, int tag) const
     {
@@ -64,6 +64,23 @@ namespace hemelb::net
         template<typename T, std::size_t N>
         void WriteAt(MPI_Offset offset, std::span<T const, N> buffer, MPI_Status* stat =
                          MPI_STATUS_IGNORE);
+        template<typename T, std::size_t N>
+        void WriteAtAll(MPI_Offset offset, std::span<T const, N> buffer, MPI_Status* stat =
+                            MPI_STATUS_IGNORE);
+        /**
+         * Starts a non-blocking write with MPI_File_iwrite_at.
+         * The buffer must stay alive and unmodified until the request completes.
+         * @return The request to wait on
+         */
+        template<typename T, std::size_t N>
+        MPI_Request IWriteAt(MPI_Offset offset, std::span<T const, N> buffer);
+        /**
+         * Starts a non-blocking collective write with MPI_File_iwrite_at_all.
+         * The buffer must stay alive and unmodified until the request completes.
+         * @return The request to wait on
+         */
+        template<typename T, std::size_t N>
+        MPI_Request IWriteAtAll(MPI_Offset offset, std::span<T const, N> buffer);
     protected:
         MpiFile(const MpiCommunicator& parentComm, MPI_File fh);
 
@@ -38,6 +38,25 @@ namespace hemelb::net
     {
       MpiCall{MPI_File_write_at}(*filePtr, offset, buffer.data(), buffer.size(), MpiDataType<T>(), stat);
     }
+    template<typename T, std::size_t N>
+    void MpiFile::WriteAtAll(MPI_Offset offset, std::span<T const, N> buffer, MPI_Status* stat)
+    {
+      MpiCall{MPI_File_write_at_all}(*filePtr, offset, buffer.data(), buffer.size(), MpiDataType<T>(), stat);
+    }
+    template<typename T, std::size_t N>
+    MPI_Request MpiFile::IWriteAt(MPI_Offset offset, std::span<T const, N> buffer)
+    {
+      MPI_Request request;
+      MpiCall{MPI_File_iwrite_at}(*filePtr, offset, buffer.data(), buffer.size(), MpiDataType<T>(), &request);
+      return request;
+    }
+    template<typename T, std::size_t N>
+    MPI_Request MpiFile::IWriteAtAll(MPI_Offset offset, std::span<T const, N> buffer)
+    {
+      MPI_Request request;
+      MpiCall{MPI_File_iwrite_at_all}(*filePtr, offset, buffer.data(), buffer.size(), MpiDataType<T>(), &request);
+      return request;
+    }
 }
 
 #endif
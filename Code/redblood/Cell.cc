@@ -15,13 +15,13 @@ namespace hemelb
     LatticeEnergy Cell::operator()() const
     {
       return facetBending() // facet bending unaffected by template scale
-      + volumeEnergy(data->vertices, *data->templateMesh.GetData(), moduli.volume, data->scale)
+      + volumeEnergy(data->vertices, *GetTemplateMesh().GetData(), moduli.volume, data->scale)
           + surfaceEnergy(data->vertices,
-                          *data->templateMesh.GetData(),
+                          *GetTemplateMesh().GetData(),
                           moduli.surface,
                           data->scale)
           + strainEnergy(data->vertices,
-                         *data->templateMesh.GetData(),
+                         *GetTemplateMesh().GetData(),
                          moduli.strain,
                          moduli.dilation,
                          data->scale);
@@ -31,17 +31,17 @@ namespace hemelb
       assert(forces.size() == data->vertices.size());
       return facetBending(forces)
           + volumeEnergy(data->vertices,
-                         *data->templateMesh.GetData(),
+                         *GetTemplateMesh().GetData(),
                          moduli.volume,
                          forces,
                          data->scale)
           + surfaceEnergy(data->vertices,
-                          *data->templateMesh.GetData(),
+                          *GetTemplateMesh().GetData(),
                           moduli.surface,
                           forces,
                           data->scale)
           + strainEnergy(data->vertices,
-                         *data->templateMesh.GetData(),
+                         *GetTemplateMesh().GetData(),
                          moduli.strain,
                          moduli.dilation,
                          forces,
@@ -64,7 +64,7 @@ namespace hemelb
           if (neighbor > static_cast<std::size_t>(current_facet))
           {
             result += hemelb::redblood::facetBending(data->vertices,
-                                                     *data->templateMesh.GetData(),
+                                                     *GetTemplateMesh().GetData(),
                                                      current_facet,
                                                      neighbor,
                                                      moduli.bending);
@@ -92,7 +92,7 @@ namespace hemelb
           if (neighbor > current_facet)
           {
             result += hemelb::redblood::facetBending(data->vertices,
-                                                     *data->templateMesh.GetData(),
+                                                     *GetTemplateMesh().GetData(),
                                                      current_facet,
                                                      neighbor,
                                                      moduli.bending,
@@ -107,11 +107,8 @@ namespace hemelb
 
     std::unique_ptr<CellBase> Cell::cloneImpl() const
     {
-      std::unique_ptr<Cell> result(new Cell(GetVertices(),
-                                            GetTemplateMesh(),
-                                            GetScale(),
-                                            GetTemplateName()));
-      result->moduli = moduli;
+      // Copying shares the template and draws a new tag
+      std::unique_ptr<Cell> result(new Cell(*this));
       return std::move(result);
     }
 
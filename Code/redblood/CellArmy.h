@@ -10,6 +10,7 @@
 #include <vector>
 #include <memory>
 #include <iomanip>
+#include <optional>
 
 #include <boost/uuid/uuid_io.hpp>
 
@@ -21,6 +22,7 @@
 #include "redblood/GridAndCell.h"
 #include "redblood/FlowExtension.h"
 #include "redblood/types.h"
+#include "redblood/stencil.h"
 #include "redblood/parallel/SpreadForces.h"
 #include "redblood/parallel/IntegrateVelocities.h"
 #include "reporting/Timers.h"
@@ -52,7 +54,7 @@ namespace hemelb
                                                                      latDat.GetDomain(),
                                                                      cellTemplates,
                                                                      timings)),
-                exchangeCells(neighbourDependenciesGraph),
+                exchangeCells(neighbourDependenciesGraph, cellTemplates),
                 velocityIntegrator(neighbourDependenciesGraph),
                 forceSpreader(neighbourDependenciesGraph),
                 globalCoordsToProcMap(parallel::ComputeGlobalCoordsToProcMap(neighbourDependenciesGraph, fieldData.GetDomain())),
@@ -89,6 +91,10 @@ namespace hemelb
         {
           return cellDnC;
         }
+        CellContainer const & GetFarCells() const
+        {
+          return farCells;
+        }
 #   endif
 
         //! Sets up call for cell insertion
@@ -147,6 +153,12 @@ namespace hemelb
         //! Adds input cell to simulation
         void AddCell(CellContainer::value_type cell);
 
+        //! \brief Adds a batch of cells to the simulation
+        //! \details Must be called with the same cells, at the same positions, on all processes.
+        //! Each process keeps the cells it owns. Cells are then distributed during the next
+        //! exchange, as any other cell.
+        void AddCells(CellContainer const &newCells);
+
         //! \brief Sets cell to cell interaction forces
         //! \details Forwards arguments to Node2NodeForce constructor.
         template<class ... ARGS> void SetCell2Cell(ARGS && ... args)
@@ -164,7 +176,33 @@ namespace hemelb
                                                cell2Wall.cutoff + 1e-6);
         }
 
+        //! \brief Sets the stencils used to interpolate velocities and spread forces
+        //! \details Stencils cannot be wider than TRAITS::Stencil, which decides which processes
+        //! each node affects. The far stencil, if any, is used for cells that are not shared with
+        //! other processes and do not interact with other cells or walls.
+        void SetStencils(stencil::Variant const &near,
+                         std::optional<stencil::Variant> const &far = std::nullopt);
+
       protected:
+        //! Adds cell if its barycentre is owned by this process
+        bool AddCellIfOwned(CellContainer::value_type cell);
+        //! \brief Figures out which cells can use the far stencil
+        //! \details Called once positions are final for the step, so that spreading and the next
+        //! interpolation use the same stencil for a given cell.
+        void UpdateFarCells();
+        //! Same traits with another stencil
+        template<class STENCIL>
+        struct StencilTraits : TRAITS
+        {
+            using Stencil = STENCIL;
+        };
+        //! Calls functor with the traits for a stencil
+        template<class FUNCTOR>
+        static void VisitStencil(stencil::Variant const &choice, FUNCTOR &&functor);
+        //! Calls functor with the traits for each stencil in use and the owned cells using it
+        template<class FUNCTOR>
+        void VisitStencils(FUNCTOR &&functor);
+
         //! All lattice information and then some
         geometry::FieldData &fieldData;
         //! Contains all cells
@@ -204,6 +242,12 @@ namespace hemelb
         parallel::GlobalCoordsToProcMap globalCoordsToProcMap;
         //! Object describing how the cells affect different subdomains
         parallel::NodeDistributions nodeDistributions;
+        //! Stencil used for interpolation and spreading
+        stencil::Variant nearStencil = Stencil{};
+        //! Cheaper stencil for cells away from interactions
+        std::optional<stencil::Variant> farStencil;
+        //! Owned cells using the far stencil
+        CellContainer farCells;
 
     };
 
@@ -225,8 +269,8 @@ namespace hemelb
         return owner;
       };
       exchangeCells.PostCellMessageLength(nodeDistributions, cells, ownership);
-      exchangeCells.PostCells(nodeDistributions, cells, ownership);
-      auto const distCells = exchangeCells.ReceiveCells(cellTemplates);
+      exchangeCells.PostCells();
+      auto const distCells = exchangeCells.ReceiveCells();
       exchangeCells.Update(cells, distCells);
       exchangeCells.Update(nodeDistributions,
                            distCells,
@@ -236,8 +280,14 @@ namespace hemelb
       // Actually perform velocity integration
       timings[hemelb::reporting::Timers::computeAndPostVelocities].Start();
       velocityIntegrator.PostMessageLength(std::get<2>(distCells));
-      velocityIntegrator.ComputeLocalVelocitiesAndUpdatePositions<TRAITS>(fieldData, cells);
-      velocityIntegrator.PostVelocities<TRAITS>(fieldData, std::get<2>(distCells));
+      VisitStencils([this](auto const &traits, CellContainer &group)
+      {
+        velocityIntegrator.ComputeLocalVelocitiesAndUpdatePositions<std::decay_t<decltype(traits)>>(fieldData, group);
+      });
+      VisitStencil(nearStencil, [this, &distCells](auto const &traits)
+      {
+        velocityIntegrator.PostVelocities<std::decay_t<decltype(traits)>>(fieldData, std::get<2>(distCells));
+      });
       timings[hemelb::reporting::Timers::computeAndPostVelocities].Stop();
 
       timings[hemelb::reporting::Timers::receiveVelocitiesAndUpdate].Start();
@@ -272,6 +322,7 @@ namespace hemelb
                                                     std::get<2>(distCells).size());
       timings[hemelb::reporting::Timers::updateDNC].Start();
       cellDnC.update(distCells);
+      UpdateFarCells();
       timings[hemelb::reporting::Timers::updateDNC].Stop();
       lentCells = std::move(std::get<2>(distCells));
     }
@@ -286,20 +337,123 @@ namespace hemelb
       forceSpreader.PostMessageLength(nodeDistributions, cells);
       forceSpreader.ComputeForces(cells);
       forceSpreader.PostForcesAndNodes(nodeDistributions, cells);
-      forceSpreader.SpreadLocalForces<TRAITS>(fieldData, cells);
+      VisitStencils([this](auto const &traits, CellContainer const &group)
+      {
+        forceSpreader.SpreadLocalForces<std::decay_t<decltype(traits)>>(fieldData, group);
+      });
       timings[hemelb::reporting::Timers::computeAndPostForces].Stop();
 
       timings[hemelb::reporting::Timers::receiveForcesAndUpdate].Start();
-      forceSpreader.SpreadNonLocalForces<TRAITS>(fieldData);
+      VisitStencil(nearStencil, [this](auto const &traits)
+      {
+        forceSpreader.SpreadNonLocalForces<std::decay_t<decltype(traits)>>(fieldData);
+      });
       timings[hemelb::reporting::Timers::receiveForcesAndUpdate].Stop();
 
       //! @todo Any changes required for these lines when running in parallel?
       timings[hemelb::reporting::Timers::updateCellAndWallInteractions].Start();
-      addCell2CellInteractions<Stencil>(cellDnC, cell2Cell, fieldData);
-      addCell2WallInteractions<Stencil>(cellDnC, wallDnC, cell2Wall, fieldData);
+      VisitStencil(nearStencil, [this](auto const &traits)
+      {
+        using InteractionStencil = typename std::decay_t<decltype(traits)>::Stencil;
+        addCell2CellInteractions<InteractionStencil>(cellDnC, cell2Cell, fieldData);
+        addCell2WallInteractions<InteractionStencil>(cellDnC, wallDnC, cell2Wall, fieldData);
+      });
       timings[hemelb::reporting::Timers::updateCellAndWallInteractions].Stop();
     }
 
+    template<class TRAITS>
+    void CellArmy<TRAITS>::SetStencils(stencil::Variant const &near,
+                                       std::optional<stencil::Variant> const &far)
+    {
+      for (auto const &s : { std::optional<stencil::Variant>(near), far })
+      {
+        if (s and stencil::GetRange(*s) > Stencil::GetRange())
+        {
+          throw Exception() << "Stencil of range " << stencil::GetRange(*s)
+              << " is wider than the range " << Stencil::GetRange() << " HemeLB was built for";
+        }
+      }
+      nearStencil = near;
+      farStencil = far;
+      UpdateFarCells();
+    }
+
+    template<class TRAITS>
+    void CellArmy<TRAITS>::UpdateFarCells()
+    {
+      farCells.clear();
+      if (not farStencil)
+      {
+        return;
+      }
+
+      // Cells with at least one node within interaction range of another cell or a wall
+      CellContainer interacting;
+      for (auto range = cellDnC.pair_begin(cell2Cell.cutoff); range.is_valid(); ++range)
+      {
+        interacting.insert(range->first.GetCell());
+        interacting.insert(range->second.GetCell());
+      }
+      for (WallCellPairIterator i_pair(cellDnC, wallDnC, cell2Wall.cutoff); i_pair; ++i_pair)
+      {
+        interacting.insert(i_pair.GetCell());
+      }
+
+      // Cells affecting other processes must use the same stencil everywhere, so they keep the
+      // default one
+      auto const thisRank = neighbourDependenciesGraph.Rank();
+      for (auto const &cell : cells)
+      {
+        auto const affected = nodeDistributions.at(cell->GetTag()).AffectedProcs();
+        if (affected.size() == 1 and *affected.begin() == thisRank
+            and interacting.count(cell) == 0)
+        {
+          farCells.insert(cell);
+        }
+      }
+      log::Logger::Log<log::Debug, log::OnePerCore>("%i of %i cells use the far stencil",
+                                                    farCells.size(),
+                                                    cells.size());
+    }
+
+    template<class TRAITS>
+    template<class FUNCTOR>
+    void CellArmy<TRAITS>::VisitStencil(stencil::Variant const &choice, FUNCTOR &&functor)
+    {
+      std::visit([&functor](auto const &s)
+      {
+        functor(StencilTraits<std::decay_t<decltype(s)>>{});
+      }, choice);
+    }
+
+    template<class TRAITS>
+    template<class FUNCTOR>
+    void CellArmy<TRAITS>::VisitStencils(FUNCTOR &&functor)
+    {
+      if (farCells.empty())
+      {
+        VisitStencil(nearStencil, [this, &functor](auto const &traits)
+        {
+          functor(traits, cells);
+        });
+        return;
+      }
+
+      CellContainer nearGroup, farGroup;
+      for (auto const &cell : cells)
+      {
+        (farCells.count(cell) ? farGroup : nearGroup).insert(cell);
+      }
+      VisitStencil(nearStencil, [&functor, &nearGroup](auto const &traits)
+      {
+        functor(traits, nearGroup);
+      });
+      VisitStencil(*farStencil, [&functor, &farGroup](auto const &traits)
+      {
+        functor(traits, farGroup);
+      });
+    }
+
     template<class TRAITS>
     void CellArmy<TRAITS>::CellRemoval()
     {
@@ -333,7 +487,7 @@ namespace hemelb
     }
 
     template<class TRAITS>
-    void CellArmy<TRAITS>::AddCell(CellContainer::value_type cell)
+    bool CellArmy<TRAITS>::AddCellIfOwned(CellContainer::value_type cell)
     {
       auto const barycenter = cell->GetBarycenter();
 
@@ -357,9 +511,22 @@ namespace hemelb
               cell));
         log::Logger::Log<log::Info, log::OnePerCore>("Cell has %i edge nodes",
           nodeDistributions.find(cell->GetTag())->second.BoundaryIndices().size());
+        log::Logger::Log<log::Debug, log::OnePerCore>(
+            "Cell uses %i bytes, plus %i bytes shared with all cells of template %s",
+            cell->MemoryFootprint(),
+            cell->GetTemplate()->MemoryFootprint(),
+            cell->GetTemplateName().c_str());
       }
+      return insertAtThisRank;
+    }
+
+    template<class TRAITS>
+    void CellArmy<TRAITS>::AddCell(CellContainer::value_type cell)
+    {
+      bool const insertAtThisRank = AddCellIfOwned(cell);
 
 #ifndef NDEBUG
+      auto const barycenter = cell->GetBarycenter();
       // Check that one and only one process inserted the cell
       unsigned numCellsAdded = neighbourDependenciesGraph.AllReduce((unsigned) insertAtThisRank, MPI_SUM);
       if (numCellsAdded != 1)
@@ -375,6 +542,27 @@ namespace hemelb
 #endif
 
     }
+
+    template<class TRAITS>
+    void CellArmy<TRAITS>::AddCells(CellContainer const &newCells)
+    {
+      timings[hemelb::reporting::Timers::cellInsertion].Start();
+      std::size_t added = 0;
+      for (auto const &cell : newCells)
+      {
+        added += AddCellIfOwned(cell);
+      }
+      // Single check for the whole batch, rather than one reduction per cell
+      auto const totalAdded = neighbourDependenciesGraph.AllReduce(added, MPI_SUM);
+      if (totalAdded != newCells.size())
+      {
+        log::Logger::Log<log::Warning, log::Singleton>(
+            "Dropped %i cells of the batch with a barycenter outside the fluid domain",
+            newCells.size() - totalAdded);
+      }
+      log::Logger::Log<log::Info, log::Singleton>("Added batch of %i cells", totalAdded);
+      timings[hemelb::reporting::Timers::cellInsertion].Stop();
+    }
   }
 }
 
@@ -40,28 +40,32 @@ namespace hemelb
 
     void CellBase::operator=(Mesh const &mesh)
     {
-      data->templateMesh = mesh;
-      data->vertices = data->templateMesh.GetVertices();
+      data->cellTemplate = TemplateRegistry::Intern(GetTemplateName(), mesh);
+      data->vertices = mesh.GetVertices();
       data->scale = 1e0;
     }
 
     //! Unmodified mesh
     Mesh const &CellBase::GetTemplateMesh() const
     {
-      return data->templateMesh;
+      return data->cellTemplate->GetMesh();
+    }
+    std::shared_ptr<CellTemplate const> const &CellBase::GetTemplate() const
+    {
+      return data->cellTemplate;
     }
     std::string const & CellBase::GetTemplateName() const
     {
-      return data->templateName;
+      return data->cellTemplate->GetName();
     }
     void CellBase::SetTemplateName(std::string const& name)
     {
-      data->templateName = name;
+      data->cellTemplate = TemplateRegistry::Intern(name, GetTemplateMesh());
     }
     //! Facets for the mesh
     MeshData::Facets const &CellBase::GetFacets() const
     {
-      return data->templateMesh.GetData()->facets;
+      return GetTemplateMesh().GetFacets();
     }
     //! Vertices of the cell
     MeshData::Vertices const &CellBase::GetVertices() const
@@ -76,7 +80,7 @@ namespace hemelb
     //! Topology of the (template) mesh
     std::shared_ptr<MeshTopology const> CellBase::GetTopology() const
     {
-      return data->templateMesh.GetTopology();
+      return GetTemplateMesh().GetTopology();
     }
     site_t CellBase::GetNumberOfNodes() const
     {
@@ -149,7 +153,7 @@ namespace hemelb
     {
       std::vector<double> edgeLengths;
 
-      for (auto &facet : data->templateMesh.GetFacets())
+      for (auto &facet : GetTemplateMesh().GetFacets())
       {
         edgeLengths.push_back( (data->vertices[facet[0]] - data->vertices[facet[1]]).GetMagnitude());
         edgeLengths.push_back( (data->vertices[facet[1]] - data->vertices[facet[2]]).GetMagnitude());
@@ -159,6 +163,12 @@ namespace hemelb
       return std::accumulate(edgeLengths.begin(), edgeLengths.end(), 0.0) / edgeLengths.size();
     }
 
+    std::size_t CellBase::MemoryFootprint() const
+    {
+      return sizeof(*this) + sizeof(CellData)
+          + data->vertices.capacity() * sizeof(MeshData::Vertices::value_type);
+    }
+
 #   ifndef NDEBUG
     void checkCellDataCharacteristics()
     {
@@ -13,6 +13,7 @@
 #include <utility>
 
 #include "redblood/Mesh.h"
+#include "redblood/CellTemplate.h"
 #include "units.h"
 
 namespace hemelb
@@ -95,6 +96,8 @@ namespace hemelb
 
         //! Unmodified mesh
         Mesh const &GetTemplateMesh() const;
+        //! Template shared with all cells of the same kind
+        std::shared_ptr<CellTemplate const> const &GetTemplate() const;
         //! Unmodified mesh
         std::string const &GetTemplateName() const;
         //! Modifies template cell
@@ -166,6 +169,10 @@ namespace hemelb
         //! Computes average edge length of cell
         double GetAverageEdgeLength() const;
 
+        //! \brief Bytes owned by this cell alone
+        //! \details Excludes the template, which is shared with other cells.
+        std::size_t MemoryFootprint() const;
+
       protected:
         //! Clones: shallow copy reference mesh, deep-copy everything else
         std::unique_ptr<CellBase> virtual cloneImpl() const = 0;
@@ -203,49 +210,48 @@ namespace hemelb
       public:
         CellData(MeshData::Vertices &&verticesIn, Mesh const &origMesh, LatticeDistance scaleIn =
                      1e0,
-                 std::string templateName = "default") :
-            vertices(std::move(verticesIn)), templateMesh(origMesh), scale(scaleIn),
-                tag(boost::uuids::random_generator()()), templateName(templateName)
+                 std::string const &templateName = "default") :
+            vertices(std::move(verticesIn)),
+                cellTemplate(TemplateRegistry::Intern(templateName, origMesh)), scale(scaleIn),
+                tag(boost::uuids::random_generator()())
         {
           assert(scale > 1e-12);
         }
         CellData(MeshData::Vertices const &verticesIn, Mesh const &origMesh,
                  LatticeDistance scaleIn = 1e0, std::string const &templateName = "default") :
-            vertices(verticesIn), templateMesh(origMesh), scale(scaleIn),
-                tag(boost::uuids::random_generator()()), templateName(templateName)
+            vertices(verticesIn), cellTemplate(TemplateRegistry::Intern(templateName, origMesh)),
+                scale(scaleIn), tag(boost::uuids::random_generator()())
         {
           assert(scale > 1e-12);
         }
         CellData(CellData const& c) :
-            vertices(c.vertices), templateMesh(c.templateMesh), scale(c.scale),
-                tag(boost::uuids::random_generator()()), templateName(c.templateName)
+            vertices(c.vertices), cellTemplate(c.cellTemplate), scale(c.scale),
+                tag(boost::uuids::random_generator()())
         {
         }
         CellData(CellData && c) :
-            vertices(std::move(c.vertices)), templateMesh(std::move(c.templateMesh)),
-                scale(c.scale), tag(std::move(c.tag)), templateName(std::move(c.templateName))
+            vertices(std::move(c.vertices)), cellTemplate(std::move(c.cellTemplate)),
+                scale(c.scale), tag(std::move(c.tag))
         {
         }
         // Constructor that can copy the tag
-        CellData(Mesh const &origMesh, boost::uuids::uuid const &uuid,
-                 std::string const &templateName) :
-            templateMesh(origMesh), scale(1e0), tag(uuid), templateName(templateName)
+        CellData(std::shared_ptr<CellTemplate const> const &cellTemplate,
+                 boost::uuids::uuid const &uuid) :
+            cellTemplate(cellTemplate), scale(1e0), tag(uuid)
         {
           assert(scale > 1e-12);
         }
         //! Holds list of vertices for this cell
         MeshData::Vertices vertices;
-        //! Unmodified original mesh
-        Mesh templateMesh;
+        //! \brief Unmodified original mesh and name of the template
+        //! \details In practice, all cells are generated from a few templates. This object is
+        //! shared by all the cells created from the same template. If the name is not given on
+        //! input, then it is set to "default".
+        std::shared_ptr<CellTemplate const> cellTemplate;
         //! Scale factor for the template;
         LatticeDistance scale;
         //! Uuid tag
         boost::uuids::uuid tag;
-        //! \brief tag of the cell from which this one was cloned
-        //! \details In practice, all cells are generated from a few templates. This tag identifies
-        //! that template. If not given on input, then it is set to "default"
-        std::string templateName;
-
     };
   }
 } // namespace hemelb::redblood
@@ -8,6 +8,8 @@
 #include <boost/uuid/uuid_io.hpp>
 
 #include "io/PathManager.h"
+#include "redblood/CellSeeder.h"
+#include "redblood/CollectiveCellWriter.h"
 #include "redblood/FaderCell.h"
 #include "redblood/MeshIO.h"
 
@@ -308,6 +310,37 @@ namespace hemelb::redblood {
                results.front();
     }
 
+    CellContainer CellControllerBuilder::build_seeded_cells(
+            std::vector<configuration::IoletConfig> const& inlet_confs,
+            CountedIoletView const& inlets,
+            TemplateCellContainer const& templateCells
+    ) const {
+        CellContainer result;
+        for (auto [i, inlet_conf]: util::enumerate(inlet_confs)) {
+            auto seed_conf = std::visit([](auto&& ic) -> std::optional<configuration::CellSeedingConfig> {
+                using T = std::decay_t<decltype(ic)>;
+                if constexpr (std::is_same_v<T, std::monostate>) {
+                    return std::nullopt;
+                } else {
+                    return ic.cell_seeding;
+                }
+            }, inlet_conf);
+            if (!seed_conf)
+                continue;
+
+            auto const& flowExtension = *inlets.GetIolet(i)->GetFlowExtension();
+            SeedingParameters parameters;
+            parameters.haematocrit = seed_conf->haematocrit;
+            parameters.separation = unit_converter->ConvertDistanceToLatticeUnits(seed_conf->separation_m);
+            parameters.seed = seed_conf->seed;
+            auto cells = SeedCells(*templateCells.at(seed_conf->template_name),
+                                   SeedingRegion::FromCylinder(flowExtension),
+                                   parameters);
+            result.merge(cells);
+        }
+        return result;
+    }
+
     std::vector<FlowExtension> CellControllerBuilder::build_outlets(
             std::vector<configuration::IoletConfig> const& inlet_confs,
             CountedIoletView const& inlets,
@@ -350,10 +383,13 @@ namespace hemelb::redblood {
 
     struct cell_outputter {
         LatticeTimeStep period;
+        configuration::CellOutputFormat format;
         std::shared_ptr<util::UnitConverter const> unitConverter;
         std::shared_ptr<lb::SimulationState const> simState;
         std::shared_ptr<io::PathManager const> fileManager;
         net::IOCommunicator ioComms;
+        //! Shared between copies of this functor, only used for the XDR format
+        std::shared_ptr<CollectiveCellWriter> writer;
 
         void operator()(CellContainer const& cells) {
             auto timestep = simState->Get0IndexedTimeStep();
@@ -362,6 +398,13 @@ namespace hemelb::redblood {
 
             log::Logger::Log<log::Info, log::OnePerCore>("printstep %d, num cells %d", timestep, cells.size());
 
+            if (std::holds_alternative<configuration::XDRCellOutputFormat>(format)) {
+                auto const filename = fileManager->GetRBCOutputPath()
+                        / ("cells_" + std::to_string(timestep) + ".xdr");
+                writer->Write(filename, timestep, cells);
+                return;
+            }
+
             // Create output directory for current writing step. Requires syncing to
             // ensure no process goes ahead before directory is created.
             auto rbcOutputDir = fileManager->GetRBCOutputPathWithSubdir(std::to_string(timestep));
@@ -391,10 +434,14 @@ namespace hemelb::redblood {
 
     CellChangeListener CellControllerBuilder::build_cell_output(
             LatticeTimeStep output_period,
+            configuration::CellOutputFormat const& output_format,
             std::shared_ptr<lb::SimulationState const> simState,
             std::shared_ptr<io::PathManager const> fileManager,
             net::IOCommunicator const& ioComms
     ) const {
-        return cell_outputter{output_period, unit_converter, simState, fileManager, ioComms};
+        auto writer = std::holds_alternative<configuration::XDRCellOutputFormat>(output_format) ?
+                std::make_shared<CollectiveCellWriter>(ioComms, unit_converter) :
+                nullptr;
+        return cell_outputter{output_period, output_format, unit_converter, simState, fileManager, ioComms, writer};
     }
 }
\ No newline at end of file
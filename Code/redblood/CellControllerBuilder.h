@@ -16,6 +16,7 @@
 #include "redblood/types.h"
 #include "redblood/CellController.h"
 #include "redblood/RBCInserter.h"
+#include "redblood/stencil.h"
 
 namespace hemelb::io { class PathManager; }
 
@@ -66,6 +67,11 @@ namespace hemelb::redblood {
         Cell::Moduli build_cell_moduli(configuration::CellModuli const& conf) const;
         std::unique_ptr<CellBase> build_cell(configuration::TemplateCellConfig const& tc_conf) const;
         Node2NodeForce build_node2node_force(configuration::NodeForceConfig const&) const;
+        //! Stencil from its name, or the one HemeLB was built with
+        template <typename Traits>
+        stencil::Variant build_stencil(std::optional<std::string> const& name) const {
+            return name ? stencil::FromName(*name) : stencil::Variant{typename Traits::Stencil{}};
+        }
         CompositeRBCInserter build_single_inlet_rbc_inserter(
                 std::vector<configuration::CellInserterConfig> const& ci_confs,
                 lb::InOutLet const& inlet,
@@ -78,6 +84,13 @@ namespace hemelb::redblood {
                 TemplateCellContainer const& templateCells
         ) const;
 
+        //! Cells seeded into the flow extensions of inlets that ask for it
+        CellContainer build_seeded_cells(
+                std::vector<configuration::IoletConfig> const& inlet_confs,
+                CountedIoletView const& inlets,
+                TemplateCellContainer const& templateCells
+        ) const;
+
         std::vector<FlowExtension> build_outlets(
                 std::vector<configuration::IoletConfig> const& inlet_confs,
                 CountedIoletView const& inlets,
@@ -85,6 +98,7 @@ namespace hemelb::redblood {
         ) const;
         CellChangeListener build_cell_output(
                 LatticeTimeStep output_period,
+                configuration::CellOutputFormat const& output_format,
                 std::shared_ptr<lb::SimulationState const> simState,
                 std::shared_ptr<io::PathManager const> fileManager,
                 net::IOCommunicator const& ioComms
@@ -118,11 +132,19 @@ namespace hemelb::redblood {
 
             controller->SetCellInsertion(build_cell_inserters(config.GetInlets(), inlets, *meshes));
 
+            controller->SetStencils(
+                    build_stencil<Traits>(rbcConfig.stencil),
+                    rbcConfig.far_stencil ?
+                        std::optional(build_stencil<Traits>(rbcConfig.far_stencil)) :
+                        std::nullopt
+            );
             controller->SetOutlets(build_outlets(config.GetInlets(), inlets, outlets));
+            controller->AddCells(build_seeded_cells(config.GetInlets(), inlets, *meshes));
 //            cellController = std::static_pointer_cast<hemelb::net::IteratedAction>(controller);
 
             controller->AddCellChangeListener(build_cell_output(
                     rbcConfig.output_period,
+                    rbcConfig.output_format,
                     simState,
                     fileManager,
                     ioComms
@@ -0,0 +1,145 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "redblood/CellSeeder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+#include "log/Logger.h"
+#include "redblood/CellBase.h"
+#include "redblood/DivideConquer.h"
+#include "util/Matrix3D.h"
+
+namespace hemelb::redblood
+{
+    namespace
+    {
+        //! Whether any vertex is closer than the separation to a vertex already in the grid
+        bool overlaps(DivideConquer<LatticePosition> const &grid,
+                      MeshData::Vertices const &vertices, LatticeDistance separation)
+        {
+            auto const separation2 = separation * separation;
+            for (auto const &vertex : vertices)
+            {
+                auto const key = grid.DowngradeKey(vertex);
+                for (LatticeCoordinate i(-1); i <= 1; ++i)
+                    for (LatticeCoordinate j(-1); j <= 1; ++j)
+                        for (LatticeCoordinate k(-1); k <= 1; ++k)
+                        {
+                            auto const range = grid.equal_range(key + LatticeVector(i, j, k));
+                            for (auto i_node = range.first; i_node != range.second; ++i_node)
+                            {
+                                if ((i_node->second - vertex).GetMagnitudeSquared() < separation2)
+                                {
+                                    return true;
+                                }
+                            }
+                        }
+            }
+            return false;
+        }
+    }
+
+    SeedingRegion SeedingRegion::FromCylinder(Cylinder const &cylinder)
+    {
+        auto const end = cylinder.origin + cylinder.normal * cylinder.length;
+        // Extent of the end discs along each axis
+        LatticePosition const halo(
+                cylinder.radius * std::sqrt(std::max(0e0, 1e0 - cylinder.normal.x() * cylinder.normal.x())),
+                cylinder.radius * std::sqrt(std::max(0e0, 1e0 - cylinder.normal.y() * cylinder.normal.y())),
+                cylinder.radius * std::sqrt(std::max(0e0, 1e0 - cylinder.normal.z() * cylinder.normal.z())));
+        return {
+            LatticePosition(std::min(cylinder.origin.x(), end.x()),
+                            std::min(cylinder.origin.y(), end.y()),
+                            std::min(cylinder.origin.z(), end.z())) - halo,
+            LatticePosition(std::max(cylinder.origin.x(), end.x()),
+                            std::max(cylinder.origin.y(), end.y()),
+                            std::max(cylinder.origin.z(), end.z())) + halo,
+            std::numbers::pi * cylinder.radius * cylinder.radius * cylinder.length,
+            [cylinder](LatticePosition const &point)
+            {
+                return redblood::contains(cylinder, point);
+            }
+        };
+    }
+
+    CellContainer SeedCells(CellBase const &templateCell, SeedingRegion const &region,
+                            SeedingParameters const &parameters)
+    {
+        auto const cellVolume = templateCell.GetVolume();
+        if (cellVolume <= 0e0)
+        {
+            throw Exception() << "Cannot seed cells with non-positive volume " << cellVolume;
+        }
+        auto const target = static_cast<std::size_t>(std::round(parameters.haematocrit
+                * region.volume / cellVolume));
+        auto const separation = std::max(parameters.separation,
+                                         templateCell.GetAverageEdgeLength());
+
+        std::default_random_engine randomGenerator(parameters.seed);
+        std::uniform_real_distribution<double> uniform(0e0, 1e0);
+        auto const randomPosition = [&]()
+        {
+            return LatticePosition(region.lower.x() + uniform(randomGenerator) * (region.upper.x() - region.lower.x()),
+                                   region.lower.y() + uniform(randomGenerator) * (region.upper.y() - region.lower.y()),
+                                   region.lower.z() + uniform(randomGenerator) * (region.upper.z() - region.lower.z()));
+        };
+        // Uniform orientation: uniform direction for the cell's z axis, then uniform spin around it
+        auto const randomRotation = [&]()
+        {
+            auto const cosTheta = 2e0 * uniform(randomGenerator) - 1e0;
+            auto const sinTheta = std::sqrt(1e0 - cosTheta * cosTheta);
+            auto const phi = 2e0 * std::numbers::pi * uniform(randomGenerator);
+            LatticePosition const axis(sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta);
+            auto const spin = 2e0 * std::numbers::pi * uniform(randomGenerator);
+            return rotationMatrix(axis, spin) * rotationMatrix(LatticePosition(0, 0, 1), axis);
+        };
+
+        CellContainer result;
+        DivideConquer<LatticePosition> grid(separation);
+        auto const templateBarycenter = templateCell.GetBarycenter();
+        std::size_t rejected = 0;
+        while (result.size() < target and rejected < parameters.maxAttemptsPerCell)
+        {
+            std::shared_ptr<CellBase> candidate = templateCell.clone();
+            *candidate *= randomRotation();
+            *candidate += randomPosition() - templateBarycenter;
+
+            auto const &vertices = candidate->GetVertices();
+            if (not std::all_of(vertices.begin(), vertices.end(), region.contains)
+                or overlaps(grid, vertices, separation))
+            {
+                ++rejected;
+                continue;
+            }
+            for (auto const &vertex : vertices)
+            {
+                grid.insert(vertex, vertex);
+            }
+            result.insert(std::move(candidate));
+            rejected = 0;
+        }
+
+        auto const haematocrit = result.size() * cellVolume / region.volume;
+        if (result.size() < target)
+        {
+            log::Logger::Log<log::Warning, log::Singleton>(
+                    "Seeded %i cells out of %i, haematocrit %f instead of %f",
+                    result.size(),
+                    target,
+                    haematocrit,
+                    parameters.haematocrit);
+        }
+        else
+        {
+            log::Logger::Log<log::Info, log::Singleton>("Seeded %i cells, haematocrit %f",
+                                                        result.size(),
+                                                        haematocrit);
+        }
+        return result;
+    }
+}
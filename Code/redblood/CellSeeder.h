@@ -0,0 +1,63 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_REDBLOOD_CELLSEEDER_H
+#define HEMELB_REDBLOOD_CELLSEEDER_H
+
+#include <functional>
+#include <random>
+
+#include "units.h"
+#include "redblood/FlowExtension.h"
+#include "redblood/types.h"
+
+namespace hemelb::redblood
+{
+    //! \brief Region cells are seeded into
+    //! \details Must be the same on all processes: every process seeds the whole region, and only
+    //! keeps the cells it owns.
+    struct SeedingRegion
+    {
+        //! Lower corner of the bounding box
+        LatticePosition lower;
+        //! Upper corner of the bounding box
+        LatticePosition upper;
+        //! Volume of the region
+        LatticeVolume volume;
+        //! Whether a point is inside the region
+        std::function<bool(LatticePosition const &)> contains;
+
+        //! Region covered by a cylinder, e.g. an inlet flow extension
+        static SeedingRegion FromCylinder(Cylinder const &cylinder);
+    };
+
+    struct SeedingParameters
+    {
+        //! Fraction of the region volume to fill with cells
+        Dimensionless haematocrit;
+        //! \brief Minimum distance between vertices of different cells
+        //! \details Never smaller than the average edge length of the template, so that surfaces
+        //! cannot cross between vertices.
+        LatticeDistance separation = 1e0;
+        //! Seed of the random number generator. Must be the same on all processes.
+        std::default_random_engine::result_type seed = std::default_random_engine::default_seed;
+        //! Number of rejected candidates per cell after which seeding gives up
+        std::size_t maxAttemptsPerCell = 1000;
+    };
+
+    //! \brief Packs randomly oriented copies of a template cell into a region
+    //! \details Candidates are placed uniformly in the region and rotated uniformly at random.
+    //! They are rejected if any vertex falls outside the region or closer than the separation to
+    //! a vertex of an accepted cell. The latter test uses a spatial grid with the separation as
+    //! box size, so that each vertex is only compared to vertices in neighbouring boxes.
+    //! Seeding stops once the haematocrit is reached or too many candidates are rejected in a row.
+    //! Positions only depend on the input, so all processes obtain the same cells. Tags are
+    //! fresh and differ between processes, which is fine since only the owner keeps a cell.
+    //! \returns the seeded cells
+    CellContainer SeedCells(CellBase const &templateCell, SeedingRegion const &region,
+                            SeedingParameters const &parameters);
+}
+
+#endif
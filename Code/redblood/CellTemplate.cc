@@ -0,0 +1,66 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <algorithm>
+#include <iterator>
+
+#include "redblood/CellTemplate.h"
+
+namespace hemelb
+{
+  namespace redblood
+  {
+    std::size_t CellTemplate::MemoryFootprint() const
+    {
+      auto const data = mesh.GetData();
+      return sizeof(CellTemplate) + name.capacity()
+          + data->vertices.capacity() * sizeof(MeshData::Vertices::value_type)
+          + data->facets.capacity() * sizeof(MeshData::Facets::value_type)
+          + mesh.GetTopology()->MemoryFootprint();
+    }
+
+    std::map<TemplateRegistry::Key, std::weak_ptr<CellTemplate const>> &
+    TemplateRegistry::Registry()
+    {
+      static std::map<Key, std::weak_ptr<CellTemplate const>> registry;
+      return registry;
+    }
+
+    std::shared_ptr<CellTemplate const> TemplateRegistry::Intern(std::string const &name,
+                                                                 Mesh const &mesh)
+    {
+      auto &registry = Registry();
+      // Drops templates no longer referenced by any cell. The key pointers of such entries may
+      // have been recycled by the allocator.
+      for (auto i_entry = registry.begin(); i_entry != registry.end();)
+      {
+        i_entry = i_entry->second.expired() ?
+          registry.erase(i_entry) :
+          std::next(i_entry);
+      }
+
+      Key const key { name, mesh.GetData().get(), mesh.GetTopology().get() };
+      auto const i_found = registry.find(key);
+      if (i_found != registry.end())
+      {
+        return i_found->second.lock();
+      }
+      auto const result = std::make_shared<CellTemplate const>(name, mesh);
+      registry.emplace(key, result);
+      return result;
+    }
+
+    std::size_t TemplateRegistry::Size()
+    {
+      auto const &registry = Registry();
+      return std::count_if(registry.begin(),
+                           registry.end(),
+                           [](auto const &entry)
+                           {
+                             return not entry.second.expired();
+                           });
+    }
+  }
+} // hemelb::redblood
@@ -0,0 +1,69 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_REDBLOOD_CELLTEMPLATE_H
+#define HEMELB_REDBLOOD_CELLTEMPLATE_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+
+#include "redblood/Mesh.h"
+
+namespace hemelb
+{
+  namespace redblood
+  {
+    //! \brief Immutable data shared by all cells created from the same template
+    //! \details Holds the reference geometry and topology of the template mesh, as well as its
+    //! name. Cells only refer to this object. They own nothing but their vertex positions,
+    //! their scale and their tag.
+    class CellTemplate
+    {
+      public:
+        CellTemplate(std::string const &name, Mesh const &mesh) :
+            name(name), mesh(mesh)
+        {
+        }
+
+        //! Name of the template, as given in the input file
+        std::string const &GetName() const
+        {
+          return name;
+        }
+        //! Reference mesh
+        Mesh const &GetMesh() const
+        {
+          return mesh;
+        }
+        //! Bytes held by the reference mesh and its topology
+        std::size_t MemoryFootprint() const;
+
+      private:
+        std::string const name;
+        Mesh const mesh;
+    };
+
+    //! \brief Interns cell templates
+    //! \details All cells referring to the same mesh data, topology and name share a single
+    //! CellTemplate object. The registry only holds weak references: templates die with the
+    //! last cell referring to them.
+    class TemplateRegistry
+    {
+      public:
+        //! Template for this name and mesh, created if it does not exist yet
+        static std::shared_ptr<CellTemplate const> Intern(std::string const &name,
+                                                          Mesh const &mesh);
+        //! Number of templates currently alive
+        static std::size_t Size();
+
+      private:
+        using Key = std::tuple<std::string, MeshData const*, MeshTopology const*>;
+        static std::map<Key, std::weak_ptr<CellTemplate const>> & Registry();
+    };
+  }
+} // namespace hemelb::redblood
+#endif
@@ -0,0 +1,102 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "redblood/CollectiveCellWriter.h"
+
+#include <cstdint>
+#include <span>
+#include <boost/uuid/uuid_io.hpp>
+
+#include "io/formats/cells.h"
+#include "io/writers/XdrVectorWriter.h"
+#include "log/Logger.h"
+#include "redblood/CellBase.h"
+#include "redblood/types.h"
+
+namespace hemelb::redblood
+{
+    CollectiveCellWriter::CollectiveCellWriter(
+            net::MpiCommunicator const &comm,
+            std::shared_ptr<util::UnitConverter const> unitConverter) :
+        comm(comm), unitConverter(std::move(unitConverter))
+    {
+    }
+
+    CollectiveCellWriter::~CollectiveCellWriter()
+    {
+        try
+        {
+            Flush();
+        }
+        catch (std::exception const &e)
+        {
+            log::Logger::Log<log::Error, log::OnePerCore>("Could not complete cell output: %s",
+                                                          e.what());
+        }
+    }
+
+    void CollectiveCellWriter::Write(std::filesystem::path const &filename,
+                                     LatticeTimeStep timestep, CellContainer const &cells)
+    {
+        Flush();
+
+        std::uint64_t nVertices = 0;
+        for (auto const &cell : cells)
+        {
+            nVertices += cell->GetNumberOfNodes();
+        }
+        auto const totals = comm.Reduce(std::vector<std::uint64_t> { cells.size(), nVertices },
+                                        MPI_SUM,
+                                        0);
+
+        io::XdrVectorWriter writer;
+        if (comm.Rank() == 0)
+        {
+            writer << std::uint32_t(io::formats::HemeLbMagicNumber)
+                << std::uint32_t(io::formats::cells::MagicNumber)
+                << std::uint32_t(io::formats::cells::VersionNumber)
+                << std::uint32_t(io::formats::cells::HeaderLength) << std::uint64_t(timestep)
+                << totals[0] << totals[1];
+        }
+        auto const body = Serialise(cells, *unitConverter);
+        buffer = writer.GetBuf();
+        buffer.insert(buffer.end(), body.begin(), body.end());
+
+        // Processes write one after the other, header first
+        std::uint64_t const size = buffer.size();
+        auto const offset = comm.Scan(size, MPI_SUM) - size;
+
+        file = net::MpiFile::Open(comm, filename, MPI_MODE_EXCL | MPI_MODE_WRONLY | MPI_MODE_CREATE);
+        request = file.IWriteAtAll(offset, std::span<char const>(buffer));
+    }
+
+    void CollectiveCellWriter::Flush()
+    {
+        if (request != MPI_REQUEST_NULL)
+        {
+            net::MpiCall{MPI_Wait}(&request, MPI_STATUS_IGNORE);
+        }
+        file.Close();
+        buffer.clear();
+    }
+
+    std::vector<char> CollectiveCellWriter::Serialise(CellContainer const &cells,
+                                                      util::UnitConverter const &unitConverter)
+    {
+        io::XdrVectorWriter writer;
+        for (auto const &cell : cells)
+        {
+            writer << boost::uuids::to_string(cell->GetTag()) << cell->GetTemplateName()
+                << cell->GetScale()
+                << unitConverter.ConvertPositionToPhysicalUnits(cell->GetBarycenter())
+                << std::uint32_t(cell->GetNumberOfNodes());
+            for (auto const &vertex : cell->GetVertices())
+            {
+                writer << unitConverter.ConvertPositionToPhysicalUnits(vertex);
+            }
+        }
+        return writer.GetBuf();
+    }
+}
@@ -0,0 +1,58 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_REDBLOOD_COLLECTIVECELLWRITER_H
+#define HEMELB_REDBLOOD_COLLECTIVECELLWRITER_H
+
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "units.h"
+#include "net/MpiCommunicator.h"
+#include "net/MpiFile.h"
+#include "redblood/types_fwd.h"
+#include "util/UnitConverter.h"
+
+namespace hemelb::redblood
+{
+    //! \brief Writes all the cells of an output step to a single shared file
+    //! \details Each process serialises its cells into a memory buffer (see io/formats/cells.h
+    //! for the layout) and posts a non-blocking collective write at the offset given by a prefix
+    //! sum over the buffer sizes. The simulation carries on while MPI flushes the data. The write
+    //! is completed, and the file closed, at the start of the next output step, on Flush, or when
+    //! the writer is destroyed.
+    class CollectiveCellWriter
+    {
+    public:
+        CollectiveCellWriter(net::MpiCommunicator const &comm,
+                             std::shared_ptr<util::UnitConverter const> unitConverter);
+        CollectiveCellWriter(CollectiveCellWriter const &) = delete;
+        CollectiveCellWriter &operator=(CollectiveCellWriter const &) = delete;
+        //! Completes any pending write. Collective.
+        ~CollectiveCellWriter();
+
+        //! \brief Starts writing the cells owned by this process to a new file
+        //! \details Completes the previous write first. Collective.
+        void Write(std::filesystem::path const &filename, LatticeTimeStep timestep,
+                   CellContainer const &cells);
+        //! Waits for the pending write, if any, and closes its file. Collective.
+        void Flush();
+
+        //! Serialised body records of the given cells
+        static std::vector<char> Serialise(CellContainer const &cells,
+                                           util::UnitConverter const &unitConverter);
+
+    private:
+        net::MpiCommunicator comm;
+        std::shared_ptr<util::UnitConverter const> unitConverter;
+        net::MpiFile file;
+        //! Data being written. Must outlive the request.
+        std::vector<char> buffer;
+        MPI_Request request = MPI_REQUEST_NULL;
+    };
+}
+
+#endif
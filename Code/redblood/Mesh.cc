@@ -109,18 +109,70 @@ namespace hemelb::redblood
       }
     }
 
-    MeshTopology::MeshTopology(MeshData const &mesh) :
-            vertexToFacets(mesh.vertices.size()),
-            facetNeighbors(mesh.facets.size())
+    VertexToFacetsMap::VertexToFacetsMap(std::size_t nVertices,
+                                         std::vector<std::array<IdType, 3> > const &facetList) :
+            offsets(nVertices + 1, 0)
     {
-        // Loop over facets to create map from vertices to facets
-        for (auto [i, facet]: util::enumerate(mesh.facets))
+        // Counts facets per vertex, then turns counts into offsets.
+        for (auto const& facet: facetList)
+        {
+            for (auto vertex_id: facet)
+            {
+                if (vertex_id < 0 or std::size_t(vertex_id) >= nVertices)
+                {
+                    throw Exception() << "Facet refers to vertex " << vertex_id
+                        << " of a mesh with " << nVertices << " vertices";
+                }
+                ++offsets[vertex_id + 1];
+            }
+        }
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+        // Facets are visited in increasing order, so rows come out sorted. A facet referring
+        // to the same vertex twice is only added once.
+        facets.resize(offsets.back());
+        std::vector<IdType> filled(offsets.begin(), offsets.end() - 1);
+        for (auto [i, facet]: util::enumerate(facetList))
+        {
+            for (auto vertex_id: facet)
+            {
+                auto& current = filled[vertex_id];
+                if (current == offsets[vertex_id] or facets[current - 1] != i)
+                {
+                    facets[current++] = i;
+                }
+            }
+        }
+
+        // Compacts rows shortened by degenerate facets
+        IdType out = 0;
+        for (std::size_t vertex = 0; vertex < nVertices; ++vertex)
         {
-            vertexToFacets.at(facet[0]).insert(i);
-            vertexToFacets.at(facet[1]).insert(i);
-            vertexToFacets.at(facet[2]).insert(i);
+            auto const first = offsets[vertex];
+            offsets[vertex] = out;
+            for (auto in = first; in < filled[vertex]; ++in)
+            {
+                facets[out++] = facets[in];
+            }
         }
+        offsets.back() = out;
+        facets.resize(out);
+        facets.shrink_to_fit();
+    }
 
+    VertexToFacetsMap::Row VertexToFacetsMap::at(std::size_t vertex) const
+    {
+        if (vertex >= size())
+        {
+            throw Exception() << "Vertex " << vertex << " out of range";
+        }
+        return operator[](vertex);
+    }
+
+    MeshTopology::MeshTopology(MeshData const &mesh) :
+            vertexToFacets(mesh.vertices.size(), mesh.facets),
+            facetNeighbors(mesh.facets.size())
+    {
         // Now creates map of neighboring facets
         IdType const N_FACETS = std::ssize(mesh.facets);
         std::array<IdType, 3> default_neigh = {N_FACETS, N_FACETS, N_FACETS};
@@ -353,10 +405,7 @@ namespace hemelb::redblood
       // Create topology by hand cos we generally don't allow for this kind of
       // ambiguous self-referencing shape.
       std::shared_ptr<redblood::MeshTopology> topo(new redblood::MeshTopology);
-      MeshTopology::VertexToFacets::value_type v2f;
-      v2f.insert(0);
-      v2f.insert(1);
-      topo->vertexToFacets.resize(3, v2f);
+      topo->vertexToFacets = MeshTopology::VertexToFacets(mesh->vertices.size(), mesh->facets);
 
       MeshTopology::FacetNeighbors::value_type neighbors[2] = { { { 0, 0, 0 } }, { { 1, 1, 1 } } };
       topo->facetNeighbors.push_back(neighbors[1]);
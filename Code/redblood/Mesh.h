@@ -6,6 +6,7 @@
 #ifndef HEMELB_REDBLOOD_MESH_H
 #define HEMELB_REDBLOOD_MESH_H
 
+#include <algorithm>
 #include <memory>
 #include <array>
 #include <vector>
@@ -57,12 +58,91 @@ namespace hemelb::redblood
     //! Orients facets inwards/outwards using VTK algorithm to determining outward facing direction. MeshData object should have been constructed from vtkPolyData object. See readMeshDataFromVTKPolyData.
     unsigned orientFacets(MeshData &mesh, vtkPolyData &polydata, bool outward = true);
 
+    //! \brief Flat, read-only map from vertices to the facets they belong to
+    //! \details Compressed row storage: the facets of vertex i are held contiguously and in
+    //! ascending order. Replaces one heap-allocated set per vertex with two arrays.
+    class VertexToFacetsMap
+    {
+      public:
+        //! Facets attached to a single vertex
+        class Row
+        {
+          public:
+            using value_type = IdType;
+            using const_iterator = IdType const *;
+            using iterator = const_iterator;
+
+            Row(const_iterator first, const_iterator last) :
+                first(first), last(last)
+            {
+            }
+            const_iterator begin() const
+            {
+              return first;
+            }
+            const_iterator end() const
+            {
+              return last;
+            }
+            std::size_t size() const
+            {
+              return last - first;
+            }
+            bool empty() const
+            {
+              return first == last;
+            }
+            IdType operator[](std::size_t i) const
+            {
+              return first[i];
+            }
+            //! Number of times the facet appears (zero or one)
+            std::size_t count(IdType facet) const
+            {
+              return std::binary_search(first, last, facet) ? 1 : 0;
+            }
+          private:
+            const_iterator first;
+            const_iterator last;
+        };
+        using value_type = Row;
+
+        //! Empty map
+        VertexToFacetsMap() = default;
+        //! Creates map for nVertices vertices from a list of facets
+        VertexToFacetsMap(std::size_t nVertices, std::vector<std::array<IdType, 3> > const &facets);
+
+        //! Number of vertices
+        std::size_t size() const
+        {
+          return offsets.empty() ? 0 : offsets.size() - 1;
+        }
+        //! Facets attached to a vertex
+        Row operator[](std::size_t vertex) const
+        {
+          return {facets.data() + offsets[vertex], facets.data() + offsets[vertex + 1]};
+        }
+        //! Facets attached to a vertex, with bound checking
+        Row at(std::size_t vertex) const;
+        //! Bytes allocated on the heap
+        std::size_t MemoryFootprint() const
+        {
+          return (offsets.capacity() + facets.capacity()) * sizeof(IdType);
+        }
+
+      private:
+        //! Row i spans facets[offsets[i]:offsets[i+1]]
+        std::vector<IdType> offsets;
+        //! Facet indices, row after row
+        std::vector<IdType> facets;
+    };
+
     //! Holds raw topology data
     class MeshTopology
     {
       public:
         //! Type for map from vertices to facets
-        using VertexToFacets = std::vector<std::set<IdType> >;
+        using VertexToFacets = VertexToFacetsMap;
         //! Type for map from facets to its neighbors
         using FacetNeighbors = std::vector<std::array<IdType, 3> >;
         //! For each vertex, lists the facet indices
@@ -76,6 +156,13 @@ namespace hemelb::redblood
         MeshTopology()
         {
         }
+
+        //! Bytes allocated on the heap
+        std::size_t MemoryFootprint() const
+        {
+          return vertexToFacets.MemoryFootprint()
+              + facetNeighbors.capacity() * sizeof(FacetNeighbors::value_type);
+        }
     };
     static_assert(
         std::is_default_constructible_v<MeshTopology>
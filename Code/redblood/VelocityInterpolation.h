@@ -14,6 +14,7 @@
 #include "redblood/Interpolation.h"
 #include "redblood/stencil.h"
 #include "lb/kernels/GuoForcingLBGK.h"
+#include "lb/kernels/Regularised.h"
 
 #include <vector>
 
@@ -39,6 +40,10 @@ namespace hemelb::redblood
       struct HasForce<lb::GuoForcingLBGK<LATTICE> > : public std::true_type
       {
       };
+      template<class LATTICE>
+      struct HasForce<lb::GuoForcingRegularised<LATTICE> > : public std::true_type
+      {
+      };
 
       // Computes velocity for a given index on the lattice
       template<class KERNEL>
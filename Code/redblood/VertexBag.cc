@@ -25,26 +25,29 @@ namespace hemelb
     }
 
     VertexBag::VertexBag(std::shared_ptr<CellBase const> parent) :
-            CellBase(std::shared_ptr<CellBase::CellData>(new CellData(parent->GetTemplateMesh(),
-                                                                      parent->GetTag(),
-                                                                      parent->GetTemplateName())))
+            CellBase(std::make_shared<CellBase::CellData>(parent->GetTemplate(), parent->GetTag()))
     {
     }
     VertexBag::VertexBag(std::shared_ptr<CellBase const> parent, LatticePosition vertex) :
-            CellBase(std::shared_ptr<CellBase::CellData>(new CellData(parent->GetTemplateMesh(),
-                                                                      parent->GetTag(),
-                                                                      parent->GetTemplateName())))
+            CellBase(std::make_shared<CellBase::CellData>(parent->GetTemplate(), parent->GetTag()))
     {
       addVertex(vertex);
     }
 
     VertexBag::VertexBag(boost::uuids::uuid const &tag, std::string const &templateName) :
-            CellBase(std::make_shared<CellBase::CellData>(Mesh(std::make_shared<MeshData>(MeshData())),
-                                                          tag,
-                                                          templateName))
+            CellBase(std::make_shared<CellBase::CellData>(TemplateRegistry::Intern(templateName,
+                                                                                   EmptyMesh()),
+                                                          tag))
     {
     }
 
+    Mesh const & VertexBag::EmptyMesh()
+    {
+      // All bags created from scratch share the same empty mesh and topology
+      static Mesh const empty(std::make_shared<MeshData>());
+      return empty;
+    }
+
     template<class STENCIL>
     std::map<size_t, std::shared_ptr<VertexBag>> splitVertices(
         std::shared_ptr<CellBase const> cell, geometry::Domain const &domain,
@@ -55,6 +55,9 @@ namespace hemelb
           return std::unique_ptr<VertexBag>(static_cast<VertexBag*>(cloneImpl().release()));
         }
       private:
+        //! Mesh for bags that do not know the template of their parent
+        static Mesh const & EmptyMesh();
+
         std::unique_ptr<CellBase> cloneImpl() const override
         {
           throw Exception() << "This object cannot be cloned";
@@ -115,6 +115,13 @@ namespace hemelb
           return pointer { new value_type { *firstCellNode, firstWallNode->second.node } };
         }
 
+        //! Cell the current cell node belongs to
+        CellContainer::const_reference GetCell() const
+        {
+          assert(static_cast<bool>(*this));
+          return firstCellNode.GetCell();
+        }
+
         bool operator++();
         WallCellPairIterator operator++(int)
         {
@@ -6,10 +6,13 @@
 #include <set>
 #include <numeric>
 #include <algorithm>
+#include <cstring>
 #include <functional>
+#include <type_traits>
 
 #include "util/Iterator.h"
 #include "net/MpiError.h"
+#include "Exception.h"
 #include "redblood/parallel/CellParallelization.h"
 #include "redblood/VertexBag.h"
 
@@ -21,38 +24,47 @@ namespace hemelb
     {
       namespace
       {
-        std::vector<int> GetUUIDCounts(std::vector<int> const &cellCounts)
+        //! Appends raw bytes of a value to a message
+        template<class T>
+        void pack(std::vector<char> &buffer, T const &value)
         {
-          std::vector<int> result = cellCounts;
-          auto const uuidSize = [](int a)
-          {
-            return a * sizeof(boost::uuids::uuid);
-          };
-          std::transform(result.begin(), result.end(), result.begin(), uuidSize);
-          return result;
-        }
-
-        std::string getTemplateName(size_t index, std::vector<char> const &buffer)
-        {
-          // loop over n occurences
-          auto first = buffer.begin();
-          for (; index > 0 and first != buffer.end(); --index, ++first)
-          {
-            first = std::find(first, buffer.end(), '\0');
-          }
-          return std::string(first, std::find(first, buffer.end(), '\0'));
+          static_assert(std::is_trivially_copyable_v<T>);
+          auto const n = buffer.size();
+          buffer.resize(n + sizeof(T));
+          std::memcpy(buffer.data() + n, &value, sizeof(T));
         }
 
-        boost::uuids::uuid getTag(size_t index, std::vector<unsigned char> const &buffer)
+        //! Reads values back from a message
+        class Unpacker
         {
-          auto const n = sizeof(boost::uuids::uuid);
-          boost::uuids::uuid result;
-          std::copy(buffer.begin() + index * n, buffer.begin() + (index + 1) * n, result.begin());
-          return result;
-        }
+          public:
+            Unpacker(char const *first, char const *last) :
+                current(first), last(last)
+            {
+            }
+            template<class T>
+            T get()
+            {
+              static_assert(std::is_trivially_copyable_v<T>);
+              if (current + sizeof(T) > last)
+              {
+                throw Exception() << "Truncated cell message";
+              }
+              T result;
+              std::memcpy(&result, current, sizeof(T));
+              current += sizeof(T);
+              return result;
+            }
+            bool done() const
+            {
+              return current == last;
+            }
+          private:
+            char const *current;
+            char const *last;
+        };
 
-        std::map<boost::uuids::uuid, proc_t> getOwnership(net::MpiCommunicator const &graphComm,
-                                                          CellContainer const &owned,
+        std::map<boost::uuids::uuid, proc_t> getOwnership(CellContainer const &owned,
                                                           ExchangeCells::Ownership const &ownership)
         {
           std::map<boost::uuids::uuid, proc_t> result;
@@ -68,120 +80,116 @@ namespace hemelb
                                                 CellContainer const &owned,
                                                 Ownership const & ownership)
       {
-        PostCellMessageLength(distributions,
-                              owned,
-                              getOwnership(nodeCount.GetCommunicator(), owned, ownership));
+        PostCellMessageLength(distributions, owned, getOwnership(owned, ownership));
       }
 
       void ExchangeCells::PostCellMessageLength(
           NodeDistributions const &distributions, CellContainer const &owned,
           std::map<boost::uuids::uuid, proc_t> const &ownership)
-      {
-        auto const neighbors = cellCount.GetCommunicator().GetNeighbors();
-        cellCount.GetSendBuffer().resize(neighbors.size());
-        totalNodeCount.GetSendBuffer().resize(neighbors.size());
-        nameLengths.GetSendBuffer().resize(neighbors.size());
-        std::fill(cellCount.GetSendBuffer().begin(), cellCount.GetSendBuffer().end(), 0);
-        std::fill(totalNodeCount.GetSendBuffer().begin(), totalNodeCount.GetSendBuffer().end(), 0);
-        std::fill(nameLengths.GetSendBuffer().begin(), nameLengths.GetSendBuffer().end(), 0);
-        // Count the number of vertices and cells
-        for (auto const & cell : owned)
-        {
-          auto const dist = distributions.find(cell->GetTag())->second;
-          assert(distributions.count(cell->GetTag()) == 1);
-          auto const newOwner = ownership.find(cell->GetTag())->second;
-          for (auto item : util::enumerate(neighbors))
-          {
-            auto const nVertices = newOwner == item.value ?
-              cell->GetNumberOfNodes() :
-              dist.CountNodes(item.value);
-            if (nVertices > 0)
-            {
-              log::Logger::Log<log::Debug, log::OnePerCore>("Sending %i vertices to process %i",
-                  nVertices, item.value);
-              assert(cellCount.GetSendBuffer().size() > item.index);
-              assert(totalNodeCount.GetSendBuffer().size() > item.index);
-              assert(nameLengths.GetSendBuffer().size() > item.index);
-              ++cellCount.GetSendBuffer()[item.index];
-              totalNodeCount.GetSendBuffer()[item.index] += nVertices;
-              // Include null termination that will seperate one name from another
-              nameLengths.GetSendBuffer()[item.index] += cell->GetTemplateName().size() + 1;
-            }
-          }
-        }
-
-        // Then send message
-        cellCount.send();
-        totalNodeCount.send();
-        nameLengths.send();
-      }
-
-      void ExchangeCells::PostCells(NodeDistributions const &distributions,
-                                    CellContainer const & owned, Ownership const &ownership)
-      {
-        PostCells(distributions,
-                  owned,
-                  getOwnership(nodeCount.GetCommunicator(), owned, ownership));
-      }
-
-      void ExchangeCells::PostCells(NodeDistributions const &distributions,
-                                    CellContainer const & owned,
-                                    std::map<boost::uuids::uuid, proc_t> const &ownership)
       {
         // sets up all main messages and the disowned cells (lent back to this process)
         disowned.clear();
         formelyOwned.clear();
         SetupLocalSendBuffers(distributions, owned, ownership);
 
-        // nodeCount's receive buffer depends on the number of incoming cell from each neigbor
-        cellCount.receive();
-        nodeCount.SetReceiveCounts(cellCount.GetReceiveBuffer());
-        cellScales.SetReceiveCounts(cellCount.GetReceiveBuffer());
-        ownerIDs.SetReceiveCounts(cellCount.GetReceiveBuffer());
-        cellUUIDs.SetReceiveCounts(GetUUIDCounts(cellCount.GetReceiveBuffer()));
-
-        // Now can send messages that depend only on number of cells
-        nodeCount.send();
-        cellScales.send();
-        ownerIDs.send();
-        cellUUIDs.send();
+        auto const neighbors = messageLengths.GetCommunicator().GetNeighbors();
+        auto &lengths = messageLengths.GetSendBuffer();
+        lengths.resize(neighbors.size());
+        for (auto item : util::enumerate(neighbors))
+        {
+          lengths[item.index] = packing[item.value].size();
+        }
+        messageLengths.send();
+      }
 
-        // Need total number of nodes to prepare buffers for positions
-        totalNodeCount.receive();
-        nodePositions.SetReceiveCounts(totalNodeCount.GetReceiveBuffer());
-        nodePositions.send();
+      void ExchangeCells::PostCells()
+      {
+        auto const neighbors = cellMessages.GetCommunicator().GetNeighbors();
+        cellMessages.SetSendCounts(messageLengths.GetSendBuffer());
+        for (auto const neighbor : neighbors)
+        {
+          cellMessages.insertSend(neighbor, packing[neighbor].cbegin());
+        }
 
-        // Need template name lengths to prepare buffers for template names
-        nameLengths.receive();
-        templateNames.SetReceiveCounts(nameLengths.GetReceiveBuffer());
-        templateNames.send();
+        // receive buffer depends on the size of the incoming messages
+        messageLengths.receive();
+        cellMessages.SetReceiveCounts(messageLengths.GetReceiveBuffer());
+        cellMessages.send();
       }
 
-      ExchangeCells::ChangedCells ExchangeCells::ReceiveCells(
-          TemplateCellContainer const &templateCells)
+      ExchangeCells::ChangedCells ExchangeCells::ReceiveCells()
       {
-        nodeCount.receive();
-        cellScales.receive();
-        ownerIDs.receive();
-        cellUUIDs.receive();
-        nodePositions.receive();
-        templateNames.receive();
+        cellMessages.receive();
 
         ChangedCells result;
         std::get<1>(result) = disowned;
 
-        for (size_t i(0); i < nodeCount.GetReceiveBuffer().size(); ++i)
+        auto const thisRank = cellMessages.GetCommunicator().Rank();
+        auto const neighbors = cellMessages.GetCommunicator().GetNeighbors();
+        auto const &counts = cellMessages.GetReceiveCounts();
+        auto const *message = cellMessages.GetReceiveBuffer().data();
+        LentPositionCache nextReceivedPositions;
+        for (auto item : util::enumerate(neighbors))
         {
-          auto const ownerID = ownerIDs.GetReceiveBuffer()[i];
-          bool const isOwned = ownerID == ownerIDs.GetCommunicator().Rank();
-          auto cell = isOwned ?
-            RecreateOwnedCell(i, templateCells) :
-            RecreateLentCell(i);
-          auto & container = isOwned ?
-            std::get<0>(result) :
-            std::get<2>(result)[ownerID];
-          container.insert(cell);
+          auto const source = item.value;
+          Unpacker unpacker(message, message + counts[item.index]);
+          message += counts[item.index];
+          if (counts[item.index] == 0)
+          {
+            continue;
+          }
+
+          auto const nCells = unpacker.get<std::uint32_t>();
+          for (std::uint32_t i(0); i < nCells; ++i)
+          {
+            auto const tag = unpacker.get<boost::uuids::uuid>();
+            auto const ownerID = unpacker.get<std::int32_t>();
+            auto const &templateCell = GetTemplate(unpacker.get<std::int32_t>());
+            auto const scale = unpacker.get<LatticeDistance>();
+            auto const nVertices = unpacker.get<std::uint32_t>();
+            auto const encoding = unpacker.get<VertexEncoding>();
+            log::Logger::Log<log::Debug, log::OnePerCore>("Receiving %i vertices", nVertices);
+
+            MeshData::Vertices positions(nVertices);
+            if (encoding == VertexEncoding::Full)
+            {
+              for (auto &position : positions)
+              {
+                position = unpacker.get<LatticePosition>();
+              }
+            }
+            else
+            {
+              auto const &previous = receivedPositions.at(source).at(tag).positions;
+              assert(previous.size() == nVertices);
+              for (auto [position, old] : util::zip(positions, previous))
+              {
+                auto const delta = unpacker.get<util::Vector3D<float>>();
+                position = old + LatticePosition(delta.x(), delta.y(), delta.z());
+              }
+            }
+
+            if (ownerID == thisRank)
+            {
+              auto cell = templateCell.second->clone();
+              cell->SetTag(tag);
+              cell->SetScale(scale);
+              assert(site_t(nVertices) == cell->GetNumberOfNodes());
+              cell->GetVertices() = std::move(positions);
+              std::get<0>(result).insert(std::move(cell));
+            }
+            else
+            {
+              nextReceivedPositions[source][tag].positions = positions;
+              auto cell = std::make_shared<VertexBag>(tag, templateCell.first);
+              cell->GetVertices() = std::move(positions);
+              cell->SetScale(scale);
+              std::get<2>(result)[ownerID].insert(std::move(cell));
+            }
+          }
+          assert(unpacker.done());
         }
+        receivedPositions = std::move(nextReceivedPositions);
 
         // adds formely owned cells to lent cells
         for (auto const & item : formelyOwned)
@@ -194,70 +202,39 @@ namespace hemelb
         return result;
       }
 
-      CellContainer::value_type ExchangeCells::RecreateLentCell(size_t index)
+      std::int32_t ExchangeCells::GetTemplateId(std::string const &name) const
       {
-        // first extract tag and template name
-        auto const tag = getTag(index, cellUUIDs.GetReceiveBuffer());
-        auto const templateName = getTemplateName(index, templateNames.GetReceiveBuffer());
-
-        // create cell
-        auto result = std::make_shared<VertexBag>(tag, templateName);
-        // add nodes
-        auto const offset = std::accumulate(nodeCount.GetReceiveBuffer().cbegin(),
-                                            nodeCount.GetReceiveBuffer().cbegin() + index,
-                                            0);
-        auto i_node = nodePositions.GetReceiveBuffer().cbegin() + offset;
-        assert(nodeCount.GetReceiveBuffer().size() > index);
-        auto const Nnodes = nodeCount.GetReceiveBuffer()[index];
-        log::Logger::Log<log::Debug, log::OnePerCore>("Receiving %i vertices", Nnodes);
-        for (size_t j(0); j < Nnodes; ++j)
+        auto const i_found = templateCells->find(name);
+        if (i_found == templateCells->end())
         {
-          result->addVertex(* (i_node++));
+          throw Exception() << "Cannot send cell with unknown template " << name;
         }
-        // and set the scale
-        result->SetScale(cellScales.GetReceiveBuffer()[index]);
-        return result;
+        return std::distance(templateCells->begin(), i_found);
       }
 
-      CellContainer::value_type ExchangeCells::RecreateOwnedCell(
-          size_t index, TemplateCellContainer const &templateCells)
+      TemplateCellContainer::const_reference ExchangeCells::GetTemplate(std::int32_t id) const
       {
-        auto const templateName = getTemplateName(index, templateNames.GetReceiveBuffer());
-        assert(templateCells.count(templateName) == 1);
-        auto result = templateCells.find(templateName)->second->clone();
-        result->SetTag(getTag(index, cellUUIDs.GetReceiveBuffer()));
-        assert(cellScales.GetReceiveBuffer().size() > index);
-        result->SetScale(cellScales.GetReceiveBuffer()[index]);
-        auto const offset = std::accumulate(nodeCount.GetReceiveBuffer().cbegin(),
-                                            nodeCount.GetReceiveBuffer().cbegin() + index,
-                                            0);
-        auto i_node = nodePositions.GetReceiveBuffer().cbegin() + offset;
-        auto const Nnodes = nodeCount.GetReceiveBuffer()[index];
-        assert(site_t(Nnodes) == result->GetNumberOfNodes());
-        std::copy(i_node, i_node + Nnodes, result->GetVertices().begin());
-        return std::move(result);
+        if (id < 0 or std::size_t(id) >= templateCells->size())
+        {
+          throw Exception() << "Received cell with unknown template id " << id;
+        }
+        return *std::next(templateCells->begin(), id);
       }
 
       void ExchangeCells::SetupLocalSendBuffers(
           NodeDistributions const &distributions, CellContainer const &owned,
           std::map<boost::uuids::uuid, proc_t> const &ownership)
       {
-        // Sets up size of messages to send to neighbors
-        nodeCount.SetSendCounts(cellCount.GetSendBuffer());
-        cellScales.SetSendCounts(cellCount.GetSendBuffer());
-        ownerIDs.SetSendCounts(cellCount.GetSendBuffer());
-        cellUUIDs.SetSendCounts(GetUUIDCounts(cellCount.GetSendBuffer()));
-        nodePositions.SetSendCounts(totalNodeCount.GetSendBuffer());
-        templateNames.SetSendCounts(nameLengths.GetSendBuffer());
-        templateNames.fillSend('\0');
-
-        auto const neighbors = nodeCount.GetCommunicator().GetNeighbors();
-        auto const thisRank = nodeCount.GetCommunicator().Rank();
-        std::map<int, int> nth;
+        auto const neighbors = cellMessages.GetCommunicator().GetNeighbors();
+        auto const thisRank = cellMessages.GetCommunicator().Rank();
+        // Each message starts with the number of cells, filled in at the end
+        packing.clear();
         for (auto const &neighbor : neighbors)
         {
-          nth[neighbor] = 0;
+          pack(packing[neighbor], std::uint32_t(0));
         }
+
+        LentPositionCache nextSentPositions;
         for (auto const &cell : owned)
         {
           auto const newOwner = ownership.find(cell->GetTag())->second;
@@ -270,78 +247,68 @@ namespace hemelb
               neighbor);
             if (newOwner == neighbor and nVertices > 0)
             {
-              AddDisownedToLocalSendBuffers(neighbor,
-                                            nth[neighbor]++,
-                                            cell,
-                                            distribution[thisRank]);
+              AddDisownedToLocalSendBuffers(neighbor, cell, distribution[thisRank]);
             }
             else if (newOwner == neighbor)
             {
-              AddDisownedToLocalSendBuffers(neighbor, nth[neighbor]++, cell);
+              AddDisownedToLocalSendBuffers(neighbor, cell);
             }
             else if (nVertices > 0)
             {
               AddOwnedToLocalSendBuffers(neighbor,
-                                         nth[neighbor]++,
-                                         nVertices,
                                          newOwner,
                                          cell,
-                                         distribution[neighbor]);
+                                         distribution[neighbor],
+                                         nextSentPositions);
             }
           }
         }
+        sentPositions = std::move(nextSentPositions);
       }
 
-      void ExchangeCells::AddToLocalSendBuffersAllButNodes(int neighbor, int nth, proc_t ownerID,
-                                                           CellContainer::const_reference cell)
+      void ExchangeCells::AddToLocalSendBuffersAllButNodes(int neighbor, proc_t ownerID,
+                                                           CellContainer::const_reference cell,
+                                                           std::uint32_t nVertices,
+                                                           VertexEncoding encoding)
       {
-        // For now, onwership is left with sending process
-        cellScales.SetSend(neighbor, cell->GetScale(), nth);
-        ownerIDs.SetSend(neighbor, ownerID, nth);
-        // boost::uuids::uuid are pod structures making up an array of unsigned chars.
-        auto const & uuid = cell->GetTag();
-        for (size_t j(0); j < sizeof(boost::uuids::uuid); ++j)
-        {
-          cellUUIDs.SetSend(neighbor, * (uuid.begin() + j), nth * sizeof(boost::uuids::uuid) + j);
-        }
-        // Copy template mesh name into message buffer
-        // First, finds where out where we are in the stream.
-        auto name_offset(0);
-        for (int i(0); i < nth; ++i)
-        {
-          while (templateNames.GetSend(neighbor, name_offset++) != '\0')
-            ;
-        }
-        assert(nth == 0 or templateNames.GetSend(neighbor, name_offset - 1) == '\0');
-        for (auto const item : util::enumerate(cell->GetTemplateName()))
-        {
-          templateNames.SetSend(neighbor, item.value, name_offset + item.index);
-        }
+        auto &message = packing[neighbor];
+        // Increments number of cells at the start of the message
+        std::uint32_t nCells;
+        std::memcpy(&nCells, message.data(), sizeof(nCells));
+        ++nCells;
+        std::memcpy(message.data(), &nCells, sizeof(nCells));
+
+        pack(message, cell->GetTag());
+        pack(message, std::int32_t(ownerID));
+        pack(message, GetTemplateId(cell->GetTemplateName()));
+        pack(message, cell->GetScale());
+        pack(message, nVertices);
+        pack(message, encoding);
       }
 
-      void ExchangeCells::AddDisownedToLocalSendBuffers(int neighbor, int nth,
+      void ExchangeCells::AddDisownedToLocalSendBuffers(int neighbor,
                                                         CellContainer::const_reference cell)
       {
-        AddToLocalSendBuffersAllButNodes(neighbor, nth, neighbor, cell);
-        nodeCount.SetSend(neighbor, cell->GetNumberOfNodes(), nth);
-        size_t node_offset(0);
-        for (int j(0); j < nth; ++j)
-        {
-          node_offset += nodeCount.GetSend(neighbor, j);
-        }
-        for (auto const item : util::enumerate(cell->GetVertices()))
+        AddToLocalSendBuffersAllButNodes(neighbor,
+                                         neighbor,
+                                         cell,
+                                         cell->GetNumberOfNodes(),
+                                         VertexEncoding::Full);
+        auto &message = packing[neighbor];
+        message.reserve(message.size() + cell->GetNumberOfNodes() * sizeof(LatticePosition));
+        for (auto const &vertex : cell->GetVertices())
         {
-          nodePositions.SetSend(neighbor, item.value, node_offset + item.index);
+          pack(message, vertex);
         }
         // adds to disowned cells and to formely owned cells
         disowned.insert(cell);
       }
 
       void ExchangeCells::AddDisownedToLocalSendBuffers(
-          int neighbor, int nth, CellContainer::const_reference cell,
+          int neighbor, CellContainer::const_reference cell,
           NodeCharacterizer::Process2NodesMap::mapped_type const & indices)
       {
-        AddDisownedToLocalSendBuffers(neighbor, nth, cell);
+        AddDisownedToLocalSendBuffers(neighbor, cell);
         // create vertex bag if any nodes are lent to this object
         if (indices.size() > 0)
         {
@@ -358,21 +325,55 @@ namespace hemelb
       }
 
       void ExchangeCells::AddOwnedToLocalSendBuffers(
-          int neighbor, int nth, int nVertices, proc_t ownerID, CellContainer::const_reference cell,
-          NodeCharacterizer::Process2NodesMap::mapped_type const & indices)
+          int neighbor, proc_t ownerID, CellContainer::const_reference cell,
+          NodeCharacterizer::Process2NodesMap::mapped_type const & indices,
+          LentPositionCache &nextSentPositions)
       {
-        AddToLocalSendBuffersAllButNodes(neighbor, nth, ownerID, cell);
-        // For now, onwership is left with sending process
-        nodeCount.SetSend(neighbor, nVertices, nth);
-        size_t node_offset(0);
-        for (int j(0); j < nth; ++j)
+        // Displacements can be sent if the neighbor has the same vertices from last time
+        LentPositions const *previous = nullptr;
+        auto const i_neighbor = sentPositions.find(neighbor);
+        if (i_neighbor != sentPositions.end())
         {
-          node_offset += nodeCount.GetSend(neighbor, j);
+          auto const i_cell = i_neighbor->second.find(cell->GetTag());
+          if (i_cell != i_neighbor->second.end()
+              and std::equal(indices.begin(),
+                             indices.end(),
+                             i_cell->second.indices.begin(),
+                             i_cell->second.indices.end()))
+          {
+            previous = &i_cell->second;
+          }
         }
+
+        AddToLocalSendBuffersAllButNodes(neighbor,
+                                         ownerID,
+                                         cell,
+                                         indices.size(),
+                                         previous ?
+                                           VertexEncoding::Delta :
+                                           VertexEncoding::Full);
+
+        auto &message = packing[neighbor];
+        auto &next = nextSentPositions[neighbor][cell->GetTag()];
+        next.indices.assign(indices.begin(), indices.end());
+        next.positions.reserve(indices.size());
         for (auto const item : util::enumerate(indices))
         {
           auto const& node = cell->GetVertices()[item.value];
-          nodePositions.SetSend(neighbor, node, node_offset + item.index);
+          if (previous)
+          {
+            // Keeps track of what the neighbor reconstructs, rather than of the exact position
+            auto const &old = previous->positions[item.index];
+            auto const delta = node - old;
+            util::Vector3D<float> const single(delta.x(), delta.y(), delta.z());
+            pack(message, single);
+            next.positions.push_back(old + LatticePosition(single.x(), single.y(), single.z()));
+          }
+          else
+          {
+            pack(message, node);
+            next.positions.push_back(node);
+          }
         }
       }
 
@@ -6,7 +6,9 @@
 #define HEMELB_REDBLOOD_PARALLEL_CELLPARALLELIZATION_H
 
 #include <boost/uuid/uuid.hpp>
+#include <cstdint>
 #include <map>
+#include <vector>
 
 #include "redblood/parallel/NodeCharacterizer.h"
 #include "redblood/Cell.h"
@@ -28,13 +30,19 @@ namespace hemelb
 
       //! \brief Takes cells and distribute them over the mpi graph
       //! \details Cells can only be distributed from one neighbor to another.
-      //! At present, this is a three step operation invoking non-blocking neighberhood collectives:
+      //! At present, this is a two step operation invoking non-blocking neighberhood collectives:
       //!
-      //! 1. Send the number of cells (to be exchanged) and total number of nodes (idem) to each
-      //! neighbor
-      //! 1. Received the first message and use it to construct and send messages describing the
-      //! cells
-      //! 1. Receive the previous message and reconstruct the cells
+      //! 1. Pack all the cells going to each neighbor into a single message and send its length
+      //! 1. Receive the lengths and send the packed messages
+      //! 1. Receive the messages and reconstruct the cells
+      //!
+      //! Each cell is described by its tag, owner, scale, the id of its template and its vertices.
+      //! The template id is the position of the template in the TemplateCellContainer, which is
+      //! the same on all processes. Cells that are transferred to a new owner are sent in full.
+      //! Cells that are only lent to a neighbor (and were lent to it in the previous exchange with
+      //! the same vertices) are sent as single precision displacements since that exchange. The
+      //! sender keeps track of the positions as reconstructed by the receiver, so that rounding
+      //! errors do not accumulate over time.
       //!
       //! This class owns only data that strictly concerns receiving and sending cells (mpi
       //! communicators, buffers, etc). Anything that could be used outside the class is passed as
@@ -48,15 +56,26 @@ namespace hemelb
           //! Result of the whole messaging mess
           typedef std::tuple<CellContainer, CellContainer, LentCells> ChangedCells;
 
+          //! How vertex positions of a cell are encoded in a message
+          enum class VertexEncoding : std::uint8_t
+          {
+            //! Positions in double precision
+            Full = 0,
+            //! Single precision displacement since the previous exchange
+            Delta = 1
+          };
+
           //! \brief An object to exchange and distribute cells
           //! \param[in] graphComm: neighborhood communicator
-          ExchangeCells(net::MpiCommunicator const &graphComm) :
-              cellCount(graphComm), totalNodeCount(graphComm), nameLengths(graphComm),
-                  templateNames(graphComm), ownerIDs(graphComm), nodeCount(graphComm),
-                  cellUUIDs(graphComm), cellScales(graphComm), nodePositions(graphComm)
+          //! \param[in] templateCells: templates used to recreate cells, and to map template names
+          //! to ids. Should be the same on all processes.
+          ExchangeCells(net::MpiCommunicator const &graphComm,
+                        std::shared_ptr<TemplateCellContainer const> templateCells) :
+              messageLengths(graphComm), cellMessages(graphComm),
+                  templateCells(std::move(templateCells))
           {
           }
-          //! \brief Computes and posts length of message when sending cells
+          //! \brief Packs the cells and posts length of message when sending cells
           //! \param[in] distributions: Node distributions of the cells owned by this process
           //! \param[in] owned: Cells currently owned by this process
           //! \param[in] ownership a function to ascertain ownership. It should return the rank of
@@ -64,7 +83,7 @@ namespace hemelb
           virtual void PostCellMessageLength(NodeDistributions const& distributions,
                                              CellContainer const &owned,
                                              Ownership const & ownership);
-          //! \brief Computes and posts length of message when sending cells
+          //! \brief Packs the cells and posts length of message when sending cells
           //! \param[in] distributions: Node distributions of the cells owned by this process
           //! \param[in] owned: Cells currently owned by this process
           //! \param[in] ownership id of the process owning the cell, corresponding to the rank in
@@ -72,28 +91,12 @@ namespace hemelb
           virtual void PostCellMessageLength(
               NodeDistributions const& distributions, CellContainer const &owned,
               std::map<boost::uuids::uuid, proc_t> const & ownership);
-          //! \brief Post all owned cells and preps for receiving lent cells
-          //! \param[in] distributions tells us for each proc the list of nodes it requires
-          //! \param[in] cells a container of cells owned and managed by this process
-          //! \param[in] ownership a function to ascertain ownership. It should return the rank of
-          //! the owning process in the graph communicator, according to the position of the cell.
-          virtual void PostCells(NodeDistributions const &distributions, CellContainer const &cells,
-                                 Ownership const & ownership);
-          //! \brief Post all owned cells and preps for receiving lent cells
-          //! \param[in] distributions tells us for each proc the list of nodes it requires
-          //! \param[in] cells a container of cells owned and managed by this process
-          //! \param[in] ownership id of the process owning the cell, corresponding to the rank in
-          //! the graph communicator used to build this object.
-          virtual void PostCells(NodeDistributions const &distributions, CellContainer const &cells,
-                                 std::map<boost::uuids::uuid, proc_t> const & ownership);
+          //! \brief Post all packed cells and preps for receiving lent cells
+          //! \details The cells are packed by PostCellMessageLength.
+          virtual void PostCells();
           //! Receives messages, reconstructs cells
           //! \return a 3-tuple with the newly owned cells, the disowned cells, and the lent cells
-          ChangedCells ReceiveCells(
-              std::shared_ptr<TemplateCellContainer const> const &templateCells)
-          {
-            return ReceiveCells(*templateCells);
-          }
-          virtual ChangedCells ReceiveCells(TemplateCellContainer const &templateCells);
+          virtual ChangedCells ReceiveCells();
 
           //! Adds new cells and removes old ones
           static void Update(CellContainer &owned, ChangedCells const & changes);
@@ -102,25 +105,25 @@ namespace hemelb
           static void Update(NodeDistributions &distributions, ChangedCells const & changes,
                              NodeCharacterizer::AssessNodeRange const &assessor);
         protected:
-          //! \brief Sends number of cells
-          //! \details Using int because it meshes better with sending the number of nodes per cell.
-          net::INeighborAllToAll<int> cellCount;
-          //! Sends total number of nodes
-          net::INeighborAllToAll<int> totalNodeCount;
-          //! Send size of message containing template mesh names
-          net::INeighborAllToAll<int> nameLengths;
-          //! Names of the template meshes
-          net::INeighborAllToAllV<char> templateNames;
-          //! ID of owner process
-          net::INeighborAllToAllV<int> ownerIDs;
-          //! Sends number of nodes per cell
-          net::INeighborAllToAllV<size_t> nodeCount;
-          //! Cell uuids
-          net::INeighborAllToAllV<unsigned char> cellUUIDs;
-          //! Sends scales
-          net::INeighborAllToAllV<LatticeDistance> cellScales;
-          //! Sends positions
-          net::INeighborAllToAllV<LatticePosition> nodePositions;
+          //! Positions of a lent cell as known by the borrowing process
+          struct LentPositions
+          {
+            //! Indices of the lent vertices in the owner's cell
+            std::vector<std::size_t> indices;
+            //! Positions as reconstructed by the borrower
+            MeshData::Vertices positions;
+          };
+          //! Lent positions for each cell, for each neighbor
+          typedef std::map<proc_t, std::map<boost::uuids::uuid, LentPositions>> LentPositionCache;
+
+          //! Size in bytes of the message for each neighbor
+          net::INeighborAllToAll<int> messageLengths;
+          //! Packed cells for each neighbor
+          net::INeighborAllToAllV<char> cellMessages;
+          //! Templates from which owned cells are recreated
+          std::shared_ptr<TemplateCellContainer const> templateCells;
+          //! Messages being packed, one per neighbor
+          std::map<proc_t, std::vector<char>> packing;
           //! \brief Cell that are no longuer owned by this process
           //! \details Unlike formelyOwned, this keeps track of the whole cell
           CellContainer disowned;
@@ -128,31 +131,36 @@ namespace hemelb
           //! \details These cells are the same as the disowned cells. However, only part of the
           //! nodes kept: those that affect this process.
           LentCells formelyOwned;
+          //! Lent positions sent to each neighbor during the last exchange
+          LentPositionCache sentPositions;
+          //! Lent positions received from each neighbor during the last exchange
+          LentPositionCache receivedPositions;
+
+          //! Id of a template on the wire
+          std::int32_t GetTemplateId(std::string const &name) const;
+          //! Template corresponding to an id on the wire
+          TemplateCellContainer::const_reference GetTemplate(std::int32_t id) const;
 
-          //! Number of nodes to send to each neighboring process
+          //! Packs the cells for each neighbor
           void SetupLocalSendBuffers(NodeDistributions const &distributions,
                                      CellContainer const &cells,
                                      std::map<boost::uuids::uuid, proc_t> const & ownership);
-          //! Adds data to local buffers for a cell that retains the same ownership
-          void AddOwnedToLocalSendBuffers(
-              int neighbor, int nth, int nVertices, proc_t owner,
-              CellContainer::const_reference cell,
-              NodeCharacterizer::Process2NodesMap::mapped_type const& indices);
-          //! Adds data to local buffer for a cell that changes ownership
-          void AddDisownedToLocalSendBuffers(int neighbor, int nth,
-                                             CellContainer::const_reference cell);
-          //! Adds data to local buffer for a cell that changes ownership
+          //! Adds a cell that changes ownership, with all its vertices
+          void AddDisownedToLocalSendBuffers(int neighbor, CellContainer::const_reference cell);
+          //! Adds a cell that changes ownership, and lends vertices back to this process
           void AddDisownedToLocalSendBuffers(
-              int neighbor, int nth, CellContainer::const_reference cell,
+              int neighbor, CellContainer::const_reference cell,
               NodeCharacterizer::Process2NodesMap::mapped_type const& indices);
-          //! Adds local data exept nodes
-          void AddToLocalSendBuffersAllButNodes(int neighbor, int nth, proc_t ownerID,
-                                                CellContainer::const_reference cell);
-          //! Recreates a given cell from messages
-          CellContainer::value_type RecreateLentCell(size_t i);
-          //! Recreates a given cell from messages
-          CellContainer::value_type RecreateOwnedCell(size_t i,
-                                                      TemplateCellContainer const &templateCells);
+          //! Adds a cell that retains the same ownership, with the vertices affecting the neighbor
+          void AddOwnedToLocalSendBuffers(
+              int neighbor, proc_t owner, CellContainer::const_reference cell,
+              NodeCharacterizer::Process2NodesMap::mapped_type const& indices,
+              LentPositionCache &nextSentPositions);
+          //! Adds everything except the vertices
+          void AddToLocalSendBuffersAllButNodes(int neighbor, proc_t ownerID,
+                                                CellContainer::const_reference cell,
+                                                std::uint32_t nVertices,
+                                                VertexEncoding encoding);
       };
 
       //! Creates a map from uuids to node distributions over MPI domains
@@ -95,7 +95,7 @@ namespace hemelb::redblood::parallel
                         // Points outside the sphere
                         if (delta.GetMagnitudeSquared() > cellsEffectiveSize*cellsEffectiveSize)
                             continue;
-                        auto& site = edge_site.GetGlobalSiteCoords();
+                        auto const site = edge_site.GetGlobalSiteCoords();
 
                         // Sites with a negative or >= box max index will mess up ID calculation
                         auto neigh = site + delta;
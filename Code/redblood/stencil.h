@@ -7,8 +7,11 @@
 #define HEMELB_REDBLOOD_STENCIL_H
 
 #include <cmath>
+#include <string_view>
 #include <type_traits>
+#include <variant>
 #include "build_info.h"
+#include "Exception.h"
 #include "units.h"
 #include "constants.h"
 
@@ -129,6 +132,42 @@ namespace hemelb::redblood::stencil
           }
       }
       using DefaultStencil = decltype(detail::get_default_stencil());
+
+      //! \brief Stencil chosen at runtime
+      //! \details Dispatch with std::visit once per batch of nodes, so that the inner loops still
+      //! work with a concrete stencil type.
+      using Variant = std::variant<FourPoint, CosineApprox, ThreePoint, TwoPoint>;
+
+      //! Stencil from its name, as used in the input file and for HEMELB_STENCIL
+      inline Variant FromName(std::string_view name)
+      {
+        if (name == "FourPoint")
+        {
+          return FourPoint{};
+        }
+        else if (name == "CosineApprox")
+        {
+          return CosineApprox{};
+        }
+        else if (name == "ThreePoint")
+        {
+          return ThreePoint{};
+        }
+        else if (name == "TwoPoint")
+        {
+          return TwoPoint{};
+        }
+        throw Exception() << "Unknown stencil " << name;
+      }
+
+      //! Range of a stencil chosen at runtime
+      inline size_t GetRange(Variant const &stencil)
+      {
+        return std::visit([](auto const &s)
+        {
+          return s.GetRange();
+        }, stencil);
+      }
 }
 
 #endif
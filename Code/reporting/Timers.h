@@ -115,6 +115,7 @@ namespace hemelb::reporting
           colloidUpdateCalculations,
           colloidOutput,
           extractionWriting,
+          extractionWaiting, //!< Time extraction spent waiting for earlier writes to complete
           cellInitialisation,
           cellInsertion,
           computeNodeDistributions,
@@ -262,6 +263,7 @@ namespace hemelb::reporting
       "Colloid calculations for updating",
       "Colloid outputting",
       "Extraction writing",
+      "Extraction waiting for I/O",
       "RBC initialisation",
       "RBC insertion",
       "Compute node distributions",
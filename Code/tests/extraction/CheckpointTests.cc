@@ -0,0 +1,236 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "Exception.h"
+#include "extraction/CheckpointWriter.h"
+#include "extraction/LocalDistributionInput.h"
+#include "io/formats/extraction.h"
+#include "io/formats/formats.h"
+#include "io/formats/offset.h"
+#include "io/writers/XdrVectorWriter.h"
+#include "lb/SimulationState.h"
+#include "lb/lattices/D3Q15.h"
+#include "reporting/Timers.h"
+
+#include "tests/helpers/FourCubeLatticeData.h"
+#include "tests/helpers/HasCommsTestFixture.h"
+
+namespace hemelb::tests
+{
+    namespace
+    {
+      constexpr auto Q = lb::D3Q15::NUMVECTORS;
+
+      // A distinct value for each distribution at each site
+      distribn_t ExpectedF(util::Vector3D<site_t> const& x, Direction i)
+      {
+        return 1.0 + x.x() + 10.0 * x.y() + 100.0 * x.z() + 1000.0 * i;
+      }
+
+      void WriteFile(const std::string& name, std::vector<char> const& contents)
+      {
+        std::ofstream file(name, std::ios::binary | std::ios::trunc);
+        file.write(contents.data(), contents.size());
+      }
+    }
+
+    TEST_CASE_METHOD(helpers::HasCommsTestFixture, "Checkpoint restart") {
+      std::unique_ptr<FourCubeLatticeData> latDat(FourCubeLatticeData::Create(Comms()));
+      auto& dom = latDat->GetDomain();
+      auto const nSites = dom.GetLocalFluidSiteCount();
+
+      auto setF = [&](bool expected) {
+        for (site_t i = 0; i < nSites; ++i) {
+          auto const x = latDat->GetSite(i).GetGlobalSiteCoords();
+          for (Direction d = 0; d < Q; ++d)
+            *latDat->GetFOld(i * Q + d) = *latDat->GetFNew(i * Q + d) = expected ? ExpectedF(x, d) : 0.0;
+        }
+      };
+      // Every site should get back its own distributions
+      auto checkLoaded = [&]() {
+        for (site_t i = 0; i < nSites; ++i) {
+          auto const x = latDat->GetSite(i).GetGlobalSiteCoords();
+          for (Direction d = 0; d < Q; ++d) {
+            INFO("Site " << i << ", direction " << d);
+            REQUIRE(*latDat->GetFOld(i * Q + d) == ExpectedF(x, d));
+            REQUIRE(*latDat->GetFNew(i * Q + d) == ExpectedF(x, d));
+          }
+        }
+      };
+
+      SECTION("Extraction format, written with another decomposition") {
+        char const* const xtrName = "redistribute.xtr";
+        char const* const offName = "redistribute.off";
+        if (Comms().OnIORank()) {
+          // The sites in the reverse of this run's order, as if
+          // written by three ranks with one, a third and the rest of
+          // them.
+          std::vector<site_t> order;
+          for (site_t i = nSites - 1; i >= 0; --i)
+            order.push_back(i);
+          std::vector<std::size_t> const chunks{0, 1, std::size_t(nSites) / 3, std::size_t(nSites)};
+
+          namespace fmt = io::formats;
+          io::XdrVectorWriter xtr;
+          xtr << std::uint32_t(fmt::HemeLbMagicNumber) << std::uint32_t(fmt::extraction::MagicNumber)
+              << std::uint32_t(fmt::extraction::VersionNumber)
+              << 0.01 << 0.0 << 0.0 << 0.0
+              << std::uint64_t(dom.GetTotalFluidSites()) << std::uint32_t(1) << std::uint32_t(32);
+          xtr << std::string("distributions") << std::uint32_t(Q)
+              << std::uint32_t(fmt::extraction::TypeCode::DOUBLE) << std::uint32_t(0);
+          REQUIRE(xtr.GetBuf().size() == fmt::extraction::MainHeaderLength + 32);
+
+          std::vector<std::uint64_t> offsets{xtr.GetBuf().size()};
+          xtr << std::uint64_t(1000);
+          for (std::size_t c = 1; c < chunks.size(); ++c) {
+            for (auto j = chunks[c - 1]; j < chunks[c]; ++j) {
+              auto const x = latDat->GetSite(order[j]).GetGlobalSiteCoords();
+              xtr << std::uint32_t(x.x()) << std::uint32_t(x.y()) << std::uint32_t(x.z());
+              for (Direction d = 0; d < Q; ++d)
+                xtr << ExpectedF(x, d);
+            }
+            offsets.push_back(xtr.GetBuf().size());
+          }
+          WriteFile(xtrName, xtr.GetBuf());
+
+          io::XdrVectorWriter off;
+          off << std::uint32_t(fmt::HemeLbMagicNumber) << std::uint32_t(fmt::offset::MagicNumber)
+              << std::uint32_t(fmt::offset::VersionNumber) << std::uint32_t(chunks.size() - 1);
+          for (auto offset: offsets)
+            off << offset;
+          WriteFile(offName, off.GetBuf());
+        }
+        Comms().Barrier();
+
+        extraction::LocalDistributionInput input(xtrName, std::nullopt, Comms());
+        std::optional<LatticeTimeStep> time;
+        input.LoadDistribution(latDat.get(), time);
+        REQUIRE(time == LatticeTimeStep(1000));
+        checkLoaded();
+
+        Comms().Barrier();
+        if (Comms().OnIORank()) {
+          std::remove(xtrName);
+          std::remove(offName);
+        }
+      }
+
+      SECTION("Native format, with the index the checkpoint names") {
+        lb::SimulationState state(1e-4, 1000);
+        reporting::Timers timers(Comms());
+        std::vector<std::string> written;
+        {
+          extraction::CheckpointWriter writer(*latDat, state, "native_%d.chk", 100, 1, timers, Comms());
+          written = {writer.GetFilename(200).native(), writer.GetIndexFilename().native()};
+          if (Comms().OnIORank())
+            for (auto const& name: written)
+              std::remove(name.c_str());
+          Comms().Barrier();
+
+          setF(true);
+          writer.Write(written[0], 200);
+          // Changes after the write has started are not in the checkpoint
+          setF(false);
+          writer.Flush();
+        }
+        REQUIRE(written[1] == "native_.idx");
+
+        extraction::LocalDistributionInput input(written[0], std::nullopt, Comms());
+        std::optional<LatticeTimeStep> time;
+        input.LoadDistribution(latDat.get(), time);
+        REQUIRE(time == LatticeTimeStep(200));
+        checkLoaded();
+
+        Comms().Barrier();
+        if (Comms().OnIORank())
+          for (auto const& name: written)
+            std::remove(name.c_str());
+      }
+
+      SECTION("Native format, with no blocks") {
+        lb::SimulationState state(1e-4, 1000);
+        reporting::Timers timers(Comms());
+        std::vector<std::string> written;
+        {
+          extraction::CheckpointWriter writer(*latDat, state, "empty_%d.chk", 100, 1, timers, Comms());
+          written = {writer.GetFilename(200).native(), writer.GetIndexFilename().native()};
+          if (Comms().OnIORank())
+            for (auto const& name: written)
+              std::remove(name.c_str());
+          Comms().Barrier();
+          setF(true);
+          writer.Write(written[0], 200);
+          writer.Flush();
+        }
+        // Zero the block counts of the checkpoint and its index, which
+        // then agree but cannot hold any sites
+        if (Comms().OnIORank())
+          for (auto [name, offset]: {std::pair{written[0], 32}, std::pair{written[1], 12}}) {
+            std::fstream file(name, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(offset);
+            std::uint32_t const zero = 0;
+            file.write(reinterpret_cast<char const*>(&zero), sizeof(zero));
+          }
+        Comms().Barrier();
+
+        extraction::LocalDistributionInput input(written[0], std::nullopt, Comms());
+        std::optional<LatticeTimeStep> time;
+        REQUIRE_THROWS_AS(input.LoadDistribution(latDat.get(), time), Exception);
+
+        Comms().Barrier();
+        if (Comms().OnIORank())
+          for (auto const& name: written)
+            std::remove(name.c_str());
+      }
+
+      SECTION("Native format, restarting from a delta") {
+        lb::SimulationState state(1e-4, 1000);
+        reporting::Timers timers(Comms());
+        std::vector<std::string> written;
+        {
+          extraction::CheckpointWriter writer(*latDat, state, "delta_%d.chk", 100, 3, timers, Comms());
+          written = {writer.GetFilename(100).native(), writer.GetFilename(200).native(),
+                     writer.GetIndexFilename().native()};
+          if (Comms().OnIORank())
+            for (auto const& name: written)
+              std::remove(name.c_str());
+          Comms().Barrier();
+
+          // The base differs from the delta at every other site
+          setF(true);
+          for (site_t i = 0; i < nSites; i += 2)
+            for (Direction d = 0; d < Q; ++d)
+              *latDat->GetFOld(i * Q + d) *= 2.0;
+          writer.Write(written[0], 100);
+          setF(true);
+          writer.Write(written[1], 200);
+          setF(false);
+          writer.Flush();
+        }
+
+        extraction::LocalDistributionInput input(written[1], std::nullopt, Comms());
+        std::optional<LatticeTimeStep> time;
+        input.LoadDistribution(latDat.get(), time);
+        REQUIRE(time == LatticeTimeStep(200));
+        checkLoaded();
+
+        Comms().Barrier();
+        if (Comms().OnIORank())
+          for (auto const& name: written)
+            std::remove(name.c_str());
+      }
+    }
+}
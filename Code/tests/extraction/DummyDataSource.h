@@ -60,6 +60,11 @@ namespace hemelb::tests
             location = 0 - 1;
           }
 
+          void SetSite(site_t index) override
+          {
+            location = index;
+          }
+
           bool ReadNext()
           {
             ++location;
@@ -0,0 +1,80 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <array>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "extraction/FieldAccumulator.h"
+
+namespace hemelb::tests
+{
+    using namespace extraction;
+
+    TEST_CASE("FieldAccumulator") {
+      // Two sites, scalar samples
+      std::vector<std::array<double, 2>> const samples{{1.0, -1.0}, {2.0, -3.0}, {6.0, 4.0}};
+      auto accumulate = [&](statistic::Type stat) {
+        FieldAccumulator acc(stat, 2, 1);
+        for (std::size_t t = 0; t < samples.size(); ++t) {
+          acc.StartStep(t);
+          for (std::size_t i = 0; i < 2; ++i)
+            acc.Add(i, std::span<double const>(&samples[t][i], 1));
+        }
+        return acc;
+      };
+      auto get = [](FieldAccumulator const& acc, std::size_t site) {
+        std::vector<double> ans(acc.GetLength());
+        acc.Get(site, ans);
+        return ans;
+      };
+
+      SECTION("Mean, variance, min and max") {
+        REQUIRE(get(accumulate(statistic::Mean{}), 0)[0] == Approx(3.0));
+        REQUIRE(get(accumulate(statistic::Mean{}), 1)[0] == Approx(0.0).margin(1e-12));
+        // Population variance
+        REQUIRE(get(accumulate(statistic::Variance{}), 0)[0] == Approx(14.0 / 3.0));
+        REQUIRE(get(accumulate(statistic::Variance{}), 1)[0] == Approx(26.0 / 3.0));
+        REQUIRE(get(accumulate(statistic::Minimum{}), 1)[0] == -3.0);
+        REQUIRE(get(accumulate(statistic::Maximum{}), 1)[0] == 4.0);
+      }
+
+      SECTION("Reset") {
+        auto acc = accumulate(statistic::Maximum{});
+        acc.Reset();
+        REQUIRE(get(acc, 0)[0] == 0.0);
+        acc.StartStep(3);
+        double const x = -5.0;
+        acc.Add(0, std::span<double const>(&x, 1));
+        REQUIRE(get(acc, 0)[0] == -5.0);
+      }
+
+      SECTION("Phase mean") {
+        // Period 2, so steps 0 and 2 are in the first phase
+        auto acc = accumulate(statistic::PhaseMean{2, 2});
+        REQUIRE(acc.GetLength() == 2);
+        auto const site0 = get(acc, 0);
+        REQUIRE(site0[0] == Approx(3.5));
+        REQUIRE(site0[1] == Approx(2.0));
+      }
+
+      SECTION("Oscillatory shear index") {
+        FieldAccumulator acc(statistic::Osi{}, 2, 3);
+        REQUIRE(acc.GetLength() == 1);
+        std::array<double, 3> const forward{1.0, 0.0, 0.0}, backward{-1.0, 0.0, 0.0};
+        for (int t = 0; t < 4; ++t) {
+          acc.StartStep(t);
+          // Site 0 always goes the same way, site 1 reverses every step
+          acc.Add(0, forward);
+          acc.Add(1, t % 2 ? backward : forward);
+        }
+        REQUIRE(get(acc, 0)[0] == Approx(0.0).margin(1e-12));
+        REQUIRE(get(acc, 1)[0] == Approx(0.5));
+
+        REQUIRE_THROWS(FieldAccumulator(statistic::Osi{}, 2, 1));
+      }
+    }
+}
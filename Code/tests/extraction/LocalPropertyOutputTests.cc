@@ -3,11 +3,17 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 
+#include <array>
+#include <cmath>
 #include <string>
 #include <cstdio>
+#include <filesystem>
+#include <limits>
+#include <vector>
 
 #include <catch2/catch.hpp>
 
+#include "io/Compression.h"
 #include "io/FILE.h"
 #include "io/formats/extraction.h"
 #include "io/readers/XdrMemReader.h"
@@ -96,6 +102,53 @@ namespace hemelb
 	}
 
       }
+
+      // The sites of a DummyDataSource whose coordinates add up to
+      // this rank, modulo the number of ranks, so that with factor 2
+      // every block is split between them
+      class SharedDataSource : public DummyDataSource {
+      public:
+	SharedDataSource(int rank, int size) {
+	  DummyDataSource::Reset();
+	  for (site_t i = 0; DummyDataSource::ReadNext(); ++i) {
+	    auto const x = GetPosition();
+	    if ((x.x() + x.y() + x.z()) % size == rank)
+	      sites.push_back(i);
+	  }
+	}
+
+	void Reset() override {
+	  current = -1;
+	}
+	bool ReadNext() override {
+	  if (++current >= site_t(sites.size()))
+	    return false;
+	  DummyDataSource::SetSite(sites[current]);
+	  return true;
+	}
+	void SetSite(site_t index) override {
+	  current = index;
+	  DummyDataSource::SetSite(sites[index]);
+	}
+
+      private:
+	std::vector<site_t> sites;
+	site_t current = -1;
+      };
+
+      // As a run that has diverged: the pressure is not a number at
+      // the first site and infinite at the last
+      class DivergedDataSource : public DummyDataSource {
+      public:
+	extraction::FloatingType GetPressure() const override {
+	  auto const x = GetPosition();
+	  if (x == LatticeVector::Zero())
+	    return std::numeric_limits<extraction::FloatingType>::quiet_NaN();
+	  if (x == LatticeVector(3, 3, 3))
+	    return std::numeric_limits<extraction::FloatingType>::infinity();
+	  return DummyDataSource::GetPressure();
+	}
+      };
     }
 
     TEST_CASE_METHOD(helpers::HasCommsTestFixture, "LocalPropertyOutput") {
@@ -215,6 +268,8 @@ namespace hemelb
 	simpleDataSource->FillFields();
 	// Write it
 	propertyWriter->Write(0, 9999);
+	// Writing is asynchronous
+	propertyWriter->Flush();
 
 	CheckDataWriting(simpleDataSource.get(), 0, writtenFile);
 
@@ -224,6 +279,7 @@ namespace hemelb
 	propertyWriter->Write(10, 9999);
 	// This SHOULD write
 	propertyWriter->Write(100, 9999);
+	propertyWriter->Flush();
 
 	// The previous call to CheckDataWriting() sets the EOF indicator in writtenFile,
 	// the previous call to Write() ought to unset it but it isn't working properly in
@@ -233,6 +289,297 @@ namespace hemelb
 	CheckDataWriting(simpleDataSource.get(), 100, writtenFile);
       }
 
+      SECTION("Compressed") {
+	auto const tolerance = GENERATE(0.0, 1e-3);
+	if (tolerance > 0.0)
+	  simpleOutFile.compression = extraction::lossy_compression{tolerance};
+	else
+	  simpleOutFile.compression = extraction::lossless_compression{};
+
+	simpleDataSource = std::make_unique<DivergedDataSource>();
+	simpleDataSource->FillFields();
+	{
+	  extraction::LocalPropertyOutput propertyWriter(*simpleDataSource, simpleOutFile, Comms());
+	  propertyWriter.Write(100, 9999);
+	}
+
+	auto writtenFile = io::FILE::open(simpleOutFile.filename, "r");
+	std::vector<char> contents(1 << 16);
+	contents.resize(writtenFile.read(contents.data(), 1, contents.size()));
+	// Compressed chunks are not padded, so track the position by hand
+	std::size_t pos = 0;
+	auto reader = [&](std::size_t length) {
+	  auto result = io::XdrMemReader(contents.data() + pos, length);
+	  pos += length;
+	  return result;
+	};
+	auto inflate = [&](std::uint64_t compressed, std::size_t expected) {
+	  auto const data = io::Inflate(std::span<char const>(contents.data() + pos, compressed), expected);
+	  pos += compressed;
+	  return data;
+	};
+
+	// Headers are unchanged apart from the version
+	uint32_t version;
+	auto mainHeader = reader(io::formats::extraction::MainHeaderLength);
+	mainHeader.read(version);
+	mainHeader.read(version);
+	mainHeader.read(version);
+	REQUIRE(version == io::formats::extraction::CompressedVersionNumber);
+	pos += fieldHeaderLength;
+
+	// Sites
+	uint32_t nChunks, codec;
+	double readTolerance;
+	uint64_t nSites, coordsLength;
+	auto siteHeader = reader(io::formats::extraction::SiteHeaderLength + 16);
+	siteHeader.read(nChunks);
+	siteHeader.read(codec);
+	siteHeader.read(readTolerance);
+	REQUIRE(nChunks == 1);
+	REQUIRE(codec == uint32_t(tolerance > 0.0 ? io::formats::extraction::Codec::LOSSY
+				  : io::formats::extraction::Codec::DEFLATE));
+	REQUIRE(readTolerance == tolerance);
+	siteHeader.read(nSites);
+	siteHeader.read(coordsLength);
+	REQUIRE(nSites == 64);
+
+	auto const coords = inflate(coordsLength, 3 * 4 * nSites);
+	io::XdrMemReader coordsReader(coords.data(), coords.size());
+	std::vector<uint32_t> xs(nSites), ys(nSites), zs(nSites);
+	for (auto* column: {&xs, &ys, &zs})
+	  for (auto& c: *column)
+	    coordsReader.read(c);
+
+	// The record
+	uint64_t timestep, recordLength, chunkLength;
+	auto recordHeader = reader(io::formats::extraction::RecordHeaderLength + 8);
+	recordHeader.read(timestep);
+	recordHeader.read(recordLength);
+	recordHeader.read(chunkLength);
+	REQUIRE(timestep == 100);
+	REQUIRE(recordLength == chunkLength);
+	REQUIRE(pos + chunkLength == contents.size());
+
+	auto const valueLength = tolerance > 0.0 ? 8 : 4;
+	auto const data = inflate(chunkLength, 4 * valueLength * nSites);
+	io::XdrMemReader dataReader(data.data(), data.size());
+	auto readValue = [&]() {
+	  if (tolerance > 0.0) {
+	    int64_t q;
+	    dataReader.read(q);
+	    return q == io::formats::extraction::LossyNotANumber ? std::numeric_limits<double>::quiet_NaN()
+	      : q * 2.0 * tolerance;
+	  }
+	  float v;
+	  dataReader.read(v);
+	  return double(v);
+	};
+	std::vector<std::array<double, 4>> values(nSites);
+	for (int j = 0; j < 4; ++j)
+	  for (auto& v: values)
+	    v[j] = readValue();
+
+	simpleDataSource->Reset();
+	for (uint64_t i = 0; i < nSites; ++i) {
+	  REQUIRE(simpleDataSource->ReadNext());
+	  REQUIRE(simpleDataSource->GetPosition() == LatticeVector{xs[i], ys[i], zs[i]});
+	  auto const margin = std::max(tolerance, 1e-5);
+	  auto const pressure = simpleDataSource->GetPressure();
+	  if (std::isnan(pressure) || (std::isinf(pressure) && tolerance > 0.0))
+	    // Lossy compression cannot quantise an infinity either
+	    REQUIRE(std::isnan(values[i][0]));
+	  else if (std::isinf(pressure))
+	    REQUIRE(values[i][0] == pressure);
+	  else
+	    REQUIRE(values[i][0] + REFERENCE_PRESSURE_mmHg == Approx(pressure).margin(margin));
+	  auto const velocity = simpleDataSource->GetVelocity();
+	  for (int j = 0; j < 3; ++j)
+	    REQUIRE(values[i][j + 1] == Approx(velocity[j]).margin(margin));
+	}
+      }
+
+      SECTION("Coarse grid") {
+	auto const box = GENERATE(false, true);
+	if (box)
+	  simpleOutFile.grid = extraction::box_filtered_grid{2};
+	else
+	  simpleOutFile.grid = extraction::subsampled_grid{2};
+
+	simpleDataSource->FillFields();
+	{
+	  extraction::LocalPropertyOutput propertyWriter(*simpleDataSource, simpleOutFile, Comms());
+	  propertyWriter.Write(100, 9999);
+	}
+
+	// Expected values on the 2x2x2 grid: pressure and velocity
+	std::array<std::array<double, 4>, 8> expected{};
+	simpleDataSource->Reset();
+	while (simpleDataSource->ReadNext()) {
+	  auto const position = simpleDataSource->GetPosition();
+	  if (!box && (position.x() % 2 || position.y() % 2 || position.z() % 2))
+	    continue;
+	  auto const coarse = position / 2;
+	  auto& e = expected[4 * coarse.x() + 2 * coarse.y() + coarse.z()];
+	  auto const velocity = simpleDataSource->GetVelocity();
+	  double const weight = box ? 1.0 / 8 : 1.0;
+	  e[0] += weight * simpleDataSource->GetPressure();
+	  for (int j = 0; j < 3; ++j)
+	    e[j + 1] += weight * velocity[j];
+	}
+
+	auto writtenFile = io::FILE::open(simpleOutFile.filename, "r");
+	std::vector<char> contents(1 << 16);
+	contents.resize(writtenFile.read(contents.data(), 1, contents.size()));
+	REQUIRE(contents.size() == io::formats::extraction::MainHeaderLength + fieldHeaderLength + 8 + 28 * 8);
+
+	// The voxel size and origin are those of the coarse grid
+	io::XdrMemReader header(contents.data(), io::formats::extraction::MainHeaderLength);
+	uint32_t magic;
+	double voxelSize;
+	std::array<double, 3> origin;
+	uint64_t nSites;
+	for (int i = 0; i < 3; ++i)
+	  header.read(magic);
+	header.read(voxelSize);
+	for (auto& o: origin)
+	  header.read(o);
+	header.read(nSites);
+	REQUIRE(nSites == 8);
+	REQUIRE(voxelSize == Approx(2 * simpleDataSource->GetVoxelSize()));
+	double const shift = box ? 0.5 * simpleDataSource->GetVoxelSize() : 0.0;
+	for (int j = 0; j < 3; ++j)
+	  REQUIRE(origin[j] == Approx(simpleDataSource->GetOrigin()[j] + shift));
+
+	io::XdrMemReader reader(contents.data() + io::formats::extraction::MainHeaderLength + fieldHeaderLength,
+				8 + 28 * 8);
+	uint64_t timestep;
+	reader.read(timestep);
+	REQUIRE(timestep == 100);
+	std::array<bool, 8> seen{};
+	for (int i = 0; i < 8; ++i) {
+	  uint32_t x, y, z;
+	  reader.read(x);
+	  reader.read(y);
+	  reader.read(z);
+	  REQUIRE(x < 2);
+	  REQUIRE(y < 2);
+	  REQUIRE(z < 2);
+	  auto const cell = 4 * x + 2 * y + z;
+	  REQUIRE(!seen[cell]);
+	  seen[cell] = true;
+	  float p, vx, vy, vz;
+	  reader.read(p);
+	  reader.read(vx);
+	  reader.read(vy);
+	  reader.read(vz);
+	  REQUIRE(apprx(expected[cell][0]) == REFERENCE_PRESSURE_mmHg + double{p});
+	  REQUIRE(apprx(expected[cell][1]) == vx);
+	  REQUIRE(apprx(expected[cell][2]) == vy);
+	  REQUIRE(apprx(expected[cell][3]) == vz);
+	}
+      }
+      SECTION("Box filtered grid, split between ranks") {
+	simpleOutFile.grid = extraction::box_filtered_grid{2};
+
+	// Same seed, so the same values as the whole data source
+	SharedDataSource sharedDataSource(Comms().Rank(), Comms().Size());
+	sharedDataSource.FillFields();
+	simpleDataSource->FillFields();
+	{
+	  extraction::LocalPropertyOutput propertyWriter(sharedDataSource, simpleOutFile, Comms());
+	  propertyWriter.Write(100, 9999);
+	}
+
+	// The means over all the sites of each block
+	std::array<std::array<double, 4>, 8> expected{};
+	simpleDataSource->Reset();
+	while (simpleDataSource->ReadNext()) {
+	  auto const coarse = simpleDataSource->GetPosition() / 2;
+	  auto& e = expected[4 * coarse.x() + 2 * coarse.y() + coarse.z()];
+	  auto const velocity = simpleDataSource->GetVelocity();
+	  e[0] += simpleDataSource->GetPressure() / 8;
+	  for (int j = 0; j < 3; ++j)
+	    e[j + 1] += velocity[j] / 8;
+	}
+
+	// Each block is written once
+	auto writtenFile = io::FILE::open(simpleOutFile.filename, "r");
+	std::vector<char> contents(1 << 16);
+	contents.resize(writtenFile.read(contents.data(), 1, contents.size()));
+	REQUIRE(contents.size() == io::formats::extraction::MainHeaderLength + fieldHeaderLength + 8 + 28 * 8);
+	io::XdrMemReader reader(contents.data() + io::formats::extraction::MainHeaderLength + fieldHeaderLength,
+				8 + 28 * 8);
+	uint64_t timestep;
+	reader.read(timestep);
+	REQUIRE(timestep == 100);
+	std::array<bool, 8> seen{};
+	for (int i = 0; i < 8; ++i) {
+	  uint32_t x, y, z;
+	  reader.read(x);
+	  reader.read(y);
+	  reader.read(z);
+	  auto const cell = 4 * x + 2 * y + z;
+	  REQUIRE(cell < 8);
+	  REQUIRE(!seen[cell]);
+	  seen[cell] = true;
+	  float p, vx, vy, vz;
+	  reader.read(p);
+	  reader.read(vx);
+	  reader.read(vy);
+	  reader.read(vz);
+	  REQUIRE(apprx(expected[cell][0]) == REFERENCE_PRESSURE_mmHg + double{p});
+	  REQUIRE(apprx(expected[cell][1]) == vx);
+	  REQUIRE(apprx(expected[cell][2]) == vy);
+	  REQUIRE(apprx(expected[cell][3]) == vz);
+	}
+	// Everyone has read the file before the next section removes it
+	Comms().Barrier();
+      }
+
+#ifdef HEMELB_USE_HDF5
+      SECTION("HDF5") {
+	simpleOutFile.format = extraction::hdf5_format{16, 4};
+	simpleDataSource->FillFields();
+	{
+	  extraction::LocalPropertyOutput propertyWriter(*simpleDataSource, simpleOutFile, Comms());
+	  // No offset file
+	  REQUIRE(!std::filesystem::exists(tempOffFileName));
+	  propertyWriter.Write(100, 9999);
+	}
+
+	auto const file = H5Fopen(tempXtrFileName, H5F_ACC_RDONLY, H5P_DEFAULT);
+	REQUIRE(file >= 0);
+	auto read = [&](char const* name, hid_t type, void* data) {
+	  auto const dataset = H5Dopen2(file, name, H5P_DEFAULT);
+	  REQUIRE(dataset >= 0);
+	  REQUIRE(H5Dread(dataset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, data) >= 0);
+	  H5Dclose(dataset);
+	};
+
+	std::uint64_t timestep;
+	read("time", H5T_NATIVE_UINT64, &timestep);
+	REQUIRE(timestep == 100);
+	std::vector<std::uint32_t> grid(3 * 64);
+	read("grid", H5T_NATIVE_UINT32, grid.data());
+	std::vector<double> pressures(64), velocities(3 * 64);
+	read("fields/Pressure", H5T_NATIVE_DOUBLE, pressures.data());
+	read("fields/Velocity", H5T_NATIVE_DOUBLE, velocities.data());
+	H5Fclose(file);
+
+	simpleDataSource->Reset();
+	for (int i = 0; i < 64; ++i) {
+	  REQUIRE(simpleDataSource->ReadNext());
+	  auto const position = simpleDataSource->GetPosition();
+	  for (int j = 0; j < 3; ++j)
+	    REQUIRE(grid[3 * i + j] == position[j]);
+	  REQUIRE(apprx(pressures[i] + REFERENCE_PRESSURE_mmHg) == simpleDataSource->GetPressure());
+	  auto const velocity = simpleDataSource->GetVelocity();
+	  for (int j = 0; j < 3; ++j)
+	    REQUIRE(apprx(velocities[3 * i + j]) == velocity[j]);
+	}
+      }
+#endif
 
       // tearDown
 
@@ -0,0 +1,109 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "extraction/PlaneGeometrySelector.h"
+#include "extraction/ProbeActor.h"
+#include "extraction/WholeGeometrySelector.h"
+#include "reporting/Timers.h"
+
+#include "tests/helpers/HasCommsTestFixture.h"
+#include "tests/extraction/DummyDataSource.h"
+
+namespace hemelb::tests
+{
+    using namespace extraction;
+
+    TEST_CASE_METHOD(helpers::HasCommsTestFixture, "ProbeActor") {
+      char const* const fileName = "probe.csv";
+      DummyDataSource data;
+      data.FillFields();
+      lb::SimulationState state(1e-4, 100);
+      reporting::Timers timers(Comms());
+
+      auto const dx = data.GetVoxelSize();
+      auto const origin = data.GetOrigin().as<float>();
+      // Planes normal to x through the sites with x index i
+      auto plane = [&](unsigned i) {
+        return util::clone_ptr<GeometrySelector>(
+            new PlaneGeometrySelector(origin + util::Vector3D<float>(i * dx, 0, 0), {1, 0, 0}));
+      };
+
+      ProbeFile spec;
+      spec.filename = fileName;
+      spec.frequency = 10;
+      auto add = [&](std::string name, source::Type src, util::clone_ptr<GeometrySelector> geometry,
+                     reduction::Type red) {
+        spec.quantities.push_back({name, src, std::move(geometry), std::move(red)});
+      };
+      add("count", source::Pressure{}, plane(1), reduction::Sum{});
+      add("mean", source::Pressure{}, util::clone_ptr<GeometrySelector>(new WholeGeometrySelector), reduction::Mean{});
+      add("velocity", source::Velocity{}, plane(1), reduction::Mean{});
+      add("flow", source::Velocity{}, plane(1), reduction::Flux{});
+      add("drop", source::Pressure{}, plane(0), reduction::Difference{plane(3)});
+
+      // Expected values, from sites in the order of the data source
+      double sumPlane = 0.0, sumWhole = 0.0, sum0 = 0.0, sum3 = 0.0;
+      util::Vector3D<double> velocity = util::Vector3D<double>::Zero();
+      data.Reset();
+      while (data.ReadNext()) {
+        auto const p = data.GetPressure();
+        sumWhole += p;
+        switch (data.GetPosition().x()) {
+        case 0:
+          sum0 += p;
+          break;
+        case 1:
+          sumPlane += p;
+          velocity += data.GetVelocity().as<double>();
+          break;
+        case 3:
+          sum3 += p;
+          break;
+        }
+      }
+
+      {
+        ProbeActor probes(state, {spec}, data, timers, Comms());
+        // Not an output step
+        probes.EndIteration();
+        while (state.GetTimeStep() < 10)
+          state.Increment();
+        probes.EndIteration();
+        probes.Flush();
+      }
+
+      std::ifstream file(fileName);
+      std::string header, row;
+      std::getline(file, header);
+      REQUIRE(header == "step,time,count,mean,velocity_x,velocity_y,velocity_z,flow,drop");
+      std::getline(file, row);
+      std::string extra;
+      REQUIRE(!std::getline(file, extra));
+
+      std::vector<double> values;
+      std::istringstream cells(row);
+      for (std::string cell; std::getline(cells, cell, ',');)
+        values.push_back(std::stod(cell));
+      REQUIRE(values.size() == 9);
+      REQUIRE(values[0] == 10);
+      REQUIRE(values[1] == Approx(state.GetTime()));
+      REQUIRE(values[2] == Approx(sumPlane));
+      REQUIRE(values[3] == Approx(sumWhole / 64));
+      for (int j = 0; j < 3; ++j)
+        REQUIRE(values[4 + j] == Approx(velocity[j] / 16));
+      REQUIRE(values[7] == Approx(velocity.x() * dx * dx));
+      REQUIRE(values[8] == Approx(sum0 / 16 - sum3 / 16));
+
+      std::remove(fileName);
+    }
+}
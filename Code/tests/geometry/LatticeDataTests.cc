@@ -3,11 +3,18 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 
+#include <algorithm>
+
 #include <catch2/catch.hpp>
 
 #include "geometry/Domain.h"
+#include "geometry/GmyReadResult.h"
+#include "geometry/LookupTree.h"
+#include "geometry/Site.h"
+#include "lb/lattices/D3Q15.h"
 
 #include "tests/helpers/FourCubeBasedTestFixture.h"
+#include "tests/helpers/HasCommsTestFixture.h"
 
 namespace hemelb
 {
@@ -34,7 +41,56 @@ namespace hemelb
 	// situation to test this properly.
 	REQUIRE(dom->ProcProvidingSiteByGlobalNoncontiguousId(43) == 0);
       }
+
+      SECTION("TestGlobalSiteCoords") {
+	// Coordinates are stored packed as block and offset in block
+	for (site_t i = 0; i < dom->GetLocalFluidSiteCount(); ++i) {
+	  auto const coords = dom->GetSite(i).GetGlobalSiteCoords();
+	  REQUIRE(dom->GetContiguousSiteId(coords) == i);
+	}
+      }
+    }
+
+    TEST_CASE_METHOD(helpers::HasCommsTestFixture, "DirectBlocks") {
+      // A fluid cube of 3^3 blocks, so the centre block is direct
+      using Lattice = lb::D3Q15;
+      U16 const blockSize = 4;
+      Vec16 const dims(3, 3, 3);
+      GmyReadResult readResult(dims, blockSize);
+      for (auto& block: readResult.Blocks) {
+	block.Sites.resize(readResult.GetSitesPerBlock(), GeometrySite(true));
+	for (auto& site: block.Sites) {
+	  site.targetProcessor = 0;
+	  site.links.resize(Lattice::NUMVECTORS - 1);
+	}
+      }
+      readResult.block_store = std::make_unique<octree::DistributedStore>(
+          readResult.GetSitesPerBlock(),
+          octree::build_block_tree(dims, std::vector<site_t>(27, readResult.GetSitesPerBlock())),
+          std::vector<int>(27, 0),
+          Comms()
+      );
+      Domain dom(Lattice::GetLatticeInfo(), readResult, Comms());
+
+      REQUIRE(dom.GetDirectSiteCount() == dom.GetSitesPerBlockVolumeUnit());
+      for (site_t i = 0; i < dom.GetDirectSiteCount(); ++i)
+	REQUIRE(dom.GetSite(i).GetGlobalSiteCoords() / site_t(blockSize) == LatticeVector::Ones());
+
+      // Every site, whether its neighbours are computed from its
+      // coordinates or looked up in the table, streams to the site one
+      // lattice vector away, or to the rubbish site outside the cube
+      auto const size = 3 * site_t(blockSize);
+      for (site_t i = 0; i < dom.GetLocalFluidSiteCount(); ++i) {
+	auto const site = dom.GetSite(i);
+	for (Direction d = 0; d < Lattice::NUMVECTORS; ++d) {
+	  auto const coords = site.GetGlobalSiteCoords() + Lattice::VECTORS[d].as<site_t>();
+	  auto const inside = std::all_of(coords.begin(), coords.end(),
+					  [&](site_t x) { return x >= 0 && x < size; });
+	  auto const expected = inside ? dom.GetContiguousSiteId(coords) * Lattice::NUMVECTORS + d
+	    : dom.GetLocalFluidSiteCount() * Lattice::NUMVECTORS;
+	  REQUIRE(site.GetStreamedIndex<Lattice>(d) == expected);
+	}
+      }
     }
   }
 }
-
@@ -192,12 +192,12 @@ namespace hemelb::tests
 
     void FourCubeDomain::SetBoundaryDistance(site_t site, Direction direction, distribn_t distance)
     {
-      distanceToWall[ (lb::D3Q15::NUMVECTORS - 1) * site + direction - 1] = distance;
+      wallDistances[(lb::D3Q15::NUMVECTORS - 1) * AddWallData(site) + direction - 1] = distance;
     }
 
     void FourCubeDomain::SetBoundaryNormal(site_t site, util::Vector3D<distribn_t> boundaryNormal)
     {
-      wallNormalAtSite[site] = boundaryNormal;
+      wallNormals[AddWallData(site)] = boundaryNormal;
     }
 
     FourCubeLatticeData* FourCubeLatticeData::Create(const net::IOCommunicator& comm, site_t sitesPerBlockUnit, proc_t rankCount) {
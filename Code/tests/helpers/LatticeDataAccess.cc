@@ -20,7 +20,7 @@ namespace hemelb::tests::helpers
 
     void LatticeDataAccess::SetMinWallDistance(PhysicalDistance _mindist)
     {
-        for (auto& dist: domain->distanceToWall) {
+        for (auto& dist: domain->wallDistances) {
             if (dist > 0e0)
                 dist = _mindist;
         }
@@ -28,7 +28,7 @@ namespace hemelb::tests::helpers
 
     void LatticeDataAccess::SetWallDistance(PhysicalDistance _mindist)
     {
-        for (auto& dist: domain->distanceToWall) {
+        for (auto& dist: domain->wallDistances) {
             if (dist > 0e0)
                 dist = _mindist;
         }
@@ -0,0 +1,75 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "io/formats/checkpoint.h"
+
+namespace hemelb::tests
+{
+    namespace cp = io::formats::checkpoint;
+
+    TEST_CASE("Checkpoint format") {
+      SECTION("Checksum") {
+        std::array<std::uint32_t, 2> const words{1, 2};
+        std::array<std::uint32_t, 2> const swapped{2, 1};
+        REQUIRE(cp::Checksum(std::span<std::uint32_t const>(words)) == ((std::uint64_t(4) << 32) | 3));
+        // Fletcher checksums depend on the order
+        REQUIRE(cp::Checksum(std::span<std::uint32_t const>(words))
+                != cp::Checksum(std::span<std::uint32_t const>(swapped)));
+        REQUIRE(cp::Checksum(std::span<std::uint32_t const>()) == 0);
+
+        // Values are checksummed as their 32-bit words
+        std::array<double, 3> const values{1.0, -2.5, 1e-300};
+        std::array<std::uint32_t, 2 * values.size()> asWords;
+        std::memcpy(asWords.data(), values.data(), sizeof(values));
+        REQUIRE(cp::Checksum(std::span<double const>(values))
+                == cp::Checksum(std::span<std::uint32_t const>(asWords)));
+      }
+
+      SECTION("Delta") {
+        std::vector<double> base(1000), values(1000);
+        for (std::size_t i = 0; i < base.size(); ++i) {
+          base[i] = 0.1 + 1e-3 * std::sin(0.01 * i);
+          values[i] = base[i] * (1.0 + 1e-6 * std::cos(0.3 * i));
+        }
+        values[7] = -values[7];
+        values[8] = 0.0;
+
+        auto const encoded = cp::EncodeDelta(values, base);
+        // Small changes compress well
+        REQUIRE(encoded.size() < 6 * values.size());
+
+        // Exact, including in place
+        std::vector<double> decoded(values.size());
+        cp::DecodeDelta(encoded, base, decoded);
+        REQUIRE(decoded == values);
+        cp::DecodeDelta(encoded, base, base);
+        REQUIRE(base == values);
+
+        // No change
+        auto const same = cp::EncodeDelta(values, values);
+        REQUIRE(same.size() < values.size() / 10);
+        cp::DecodeDelta(same, values, decoded);
+        REQUIRE(decoded == values);
+
+        REQUIRE_THROWS(cp::EncodeDelta(values, std::span<double const>(base).first(10)));
+        REQUIRE(cp::PaddedNameLength(0) == 0);
+        REQUIRE(cp::PaddedNameLength(1) == 8);
+        REQUIRE(cp::PaddedNameLength(16) == 16);
+      }
+
+      SECTION("Index file name") {
+        REQUIRE(cp::PatternToIndex("results/checkpoint_%d.chk") == "results/checkpoint_.idx");
+        REQUIRE_THROWS(cp::PatternToIndex("checkpoint_%d"));
+      }
+    }
+}
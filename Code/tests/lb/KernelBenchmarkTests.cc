@@ -0,0 +1,193 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "geometry/Domain.h"
+#include "geometry/GmyReadResult.h"
+#include "geometry/LookupTree.h"
+#include "lb/HFunction.h"
+#include "lb/Kernels.h"
+#include "lb/kernels/DHumieresD3Q15MRTBasis.h"
+#include "lb/kernels/DHumieresD3Q19MRTBasis.h"
+
+#include "tests/helpers/HasCommsTestFixture.h"
+#include "tests/lb/LbTestsHelper.h"
+
+namespace hemelb::tests
+{
+    // Time the kernel's hydrodynamic variables and collision at each
+    // of a block of sites, in nanoseconds per site.
+    template <typename Kernel>
+    double KernelNanosecondsPerSite()
+    {
+        using Lattice = typename Kernel::LatticeType;
+        constexpr auto Q = Lattice::NUMVECTORS;
+        constexpr site_t sites = 1 << 14;
+        constexpr int repeats = 50;
+
+        lb::LbmParameters params(1e-4, 1e-4, 1000, 0.004);
+        lb::InitParams init;
+        init.lbmParams = &params;
+        Kernel kernel(init);
+
+        std::vector<distribn_t> f(sites * Q);
+        for (site_t site = 0; site < sites; ++site)
+            LbTestsHelper::InitialiseAnisotropicTestData<Lattice>(site % 64, &f[site * Q]);
+
+        distribn_t checksum = 0;
+        auto const start = std::chrono::steady_clock::now();
+        for (int repeat = 0; repeat < repeats; ++repeat)
+            for (site_t site = 0; site < sites; ++site)
+            {
+                lb::HydroVars<Kernel> hydroVars(&f[site * Q]);
+                kernel.CalculateDensityMomentumFeq(hydroVars, site);
+                kernel.Collide(&params, hydroVars);
+                checksum += hydroVars.GetFPostCollision()[site % Q];
+            }
+        std::chrono::duration<double, std::nano> const elapsed = std::chrono::steady_clock::now() - start;
+        // Keep the work from being optimised away
+        REQUIRE(std::isfinite(checksum));
+        return elapsed.count() / (sites * repeats);
+    }
+
+    TEST_CASE("Kernel cost per site", "[lb][.long]") {
+        auto report = [](char const* name, double ns) {
+            std::cerr << name << ": " << ns << " ns/site" << std::endl;
+        };
+        report("LBGK D3Q15", KernelNanosecondsPerSite<lb::LBGK<lb::D3Q15>>());
+        report("MRT D3Q15", KernelNanosecondsPerSite<lb::MRT<lb::DHumieresD3Q15MRTBasis>>());
+        report("LBGK D3Q19", KernelNanosecondsPerSite<lb::LBGK<lb::D3Q19>>());
+        report("MRT D3Q19", KernelNanosecondsPerSite<lb::MRT<lb::DHumieresD3Q19MRTBasis>>());
+        report("TRT D3Q19", KernelNanosecondsPerSite<lb::TRT<lb::D3Q19>>());
+        report("Regularised D3Q19", KernelNanosecondsPerSite<lb::Regularised<lb::D3Q19>>());
+    }
+
+    // Time finding the entropic alpha at each of a block of sites, by
+    // Newton-Raphson on the H function (as EntropicBase, to the same
+    // accuracy) and by EntropicSeries' estimate, and report how far
+    // apart they are.
+    template <typename Lattice>
+    void CompareEntropicAlpha(distribn_t deviation)
+    {
+        using Series = lb::EntropicSeries<Lattice>;
+        constexpr auto Q = Lattice::NUMVECTORS;
+        constexpr site_t sites = 1 << 12;
+        constexpr int repeats = 20;
+
+        std::vector<distribn_t> f(sites * Q), f_eq(sites * Q), density(sites);
+        std::vector<LatticeMomentum> momentum(sites);
+        for (site_t site = 0; site < sites; ++site)
+        {
+            LbTestsHelper::InitialiseNearEquilibriumTestData<Lattice>(site, deviation, &f[site * Q]);
+            typename Lattice::const_span fs(&f[site * Q], Q);
+            Lattice::CalculateDensityAndMomentum(fs, density[site], momentum[site]);
+            Lattice::CalculateEntropicFeqAnsumali(density[site], momentum[site],
+                                                  typename Lattice::mut_span(&f_eq[site * Q], Q));
+        }
+        auto f_at = [&](std::vector<distribn_t> const& v, site_t site) {
+            return typename Lattice::const_span(&v[site * Q], Q);
+        };
+
+        std::vector<distribn_t> newton(sites), series(sites);
+        auto const start = std::chrono::steady_clock::now();
+        for (int repeat = 0; repeat < repeats; ++repeat)
+            for (site_t site = 0; site < sites; ++site)
+            {
+                lb::HFunction<Lattice> HFunc(f_at(f, site), f_at(f_eq, site));
+                newton[site] = util::NumericalMethods::NewtonRaphson(&HFunc, 2.0, 1.0E-6);
+            }
+        auto const middle = std::chrono::steady_clock::now();
+        for (int repeat = 0; repeat < repeats; ++repeat)
+            for (site_t site = 0; site < sites; ++site)
+                series[site] = Series::EstimateAlpha(f_at(f, site), f_at(f_eq, site), density[site], momentum[site]);
+        auto const end = std::chrono::steady_clock::now();
+
+        // Ignore sites where H has no positive root other than zero
+        distribn_t worst = 0, total = 0;
+        site_t compared = 0;
+        for (site_t site = 0; site < sites; ++site)
+            if (newton[site] > 1e-3)
+            {
+                auto const difference = std::abs(series[site] - newton[site]);
+                worst = std::max(worst, difference);
+                total += difference;
+                ++compared;
+            }
+        REQUIRE(compared > 0);
+
+        std::chrono::duration<double, std::nano> const newtonTime = middle - start, seriesTime = end - middle;
+        std::cerr << "D3Q" << Q << ", deviation " << deviation
+                  << ": Newton " << newtonTime.count() / (sites * repeats) << " ns/site"
+                  << ", series " << seriesTime.count() / (sites * repeats) << " ns/site"
+                  << ", |alpha difference| max " << worst << " mean " << total / compared << std::endl;
+    }
+
+    TEST_CASE("Entropic alpha cost and accuracy", "[lb][.long]") {
+        for (distribn_t deviation: {0.01, 0.03, 0.1})
+        {
+            CompareEntropicAlpha<lb::D3Q15>(deviation);
+            CompareEntropicAlpha<lb::D3Q19>(deviation);
+        }
+    }
+
+    // Time finding the streamed index of every direction at the sites
+    // of a fluid cube: those in direct blocks, found from their
+    // coordinates, and the others, from the neighbour index table as
+    // all sites were before.
+    TEST_CASE_METHOD(helpers::HasCommsTestFixture, "Streamed index cost per site", "[lb][.long]") {
+        using Lattice = lb::D3Q15;
+        constexpr auto Q = Lattice::NUMVECTORS;
+        constexpr int repeats = 20;
+        U16 const blockSize = 8;
+        Vec16 const dims(6, 6, 6);
+        site_t const blocks = 216;
+        geometry::GmyReadResult readResult(dims, blockSize);
+        for (auto& block: readResult.Blocks) {
+            block.Sites.resize(readResult.GetSitesPerBlock(), geometry::GeometrySite(true));
+            for (auto& site: block.Sites) {
+                site.targetProcessor = 0;
+                site.links.resize(Q - 1);
+            }
+        }
+        readResult.block_store = std::make_unique<geometry::octree::DistributedStore>(
+                readResult.GetSitesPerBlock(),
+                geometry::octree::build_block_tree(dims, std::vector<site_t>(blocks, readResult.GetSitesPerBlock())),
+                std::vector<int>(blocks, 0),
+                Comms()
+        );
+        geometry::Domain dom(Lattice::GetLatticeInfo(), readResult, Comms());
+        auto const direct = dom.GetDirectSiteCount();
+        auto const local = dom.GetLocalFluidSiteCount();
+        REQUIRE(direct == 64 * dom.GetSitesPerBlockVolumeUnit());
+
+        auto time = [&](site_t begin, site_t end) {
+            site_t checksum = 0;
+            auto const start = std::chrono::steady_clock::now();
+            for (int repeat = 0; repeat < repeats; ++repeat)
+                for (site_t site = begin; site < end; ++site)
+                {
+                    auto const s = dom.GetSite(site);
+                    for (Direction d = 0; d < Q; ++d)
+                        checksum += s.GetStreamedIndex<Lattice>(d);
+                }
+            std::chrono::duration<double, std::nano> const elapsed = std::chrono::steady_clock::now() - start;
+            // Keep the work from being optimised away
+            REQUIRE(checksum > 0);
+            return elapsed.count() / ((end - begin) * repeats);
+        };
+        auto const table = time(direct, local);
+        auto const coordinates = time(0, direct);
+        std::cerr << "D3Q" << Q << " streamed indices: table " << table << " ns/site"
+                  << ", direct blocks " << coordinates << " ns/site" << std::endl;
+    }
+}
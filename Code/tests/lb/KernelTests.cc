@@ -10,6 +10,7 @@
 #include "lb/kernels/DHumieresD3Q15MRTBasis.h"
 #include "lb/kernels/DHumieresD3Q19MRTBasis.h"
 
+#include "tests/helpers/ApproxVector.h"
 #include "tests/lb/LbTestsHelper.h"
 
 #include "tests/helpers/FourCubeBasedTestFixture.h"
@@ -369,5 +370,96 @@ namespace hemelb::tests
         REQUIRE(std::equal(actual.begin(), actual.end(), expected.begin()));
     }
 
-}
+    TEMPLATE_TEST_CASE("EntropicSeries alpha matches the converged root of the H function", "[lb][kernels]",
+                       lb::D3Q15, lb::D3Q19) {
+        using LATTICE = TestType;
+        using KERNEL = lb::EntropicSeries<LATTICE>;
+        constexpr auto NV = LATTICE::NUMVECTORS;
+
+        // Tolerance on alpha for each relative deviation from equilibrium
+        auto [deviation, tolerance] = GENERATE(table<distribn_t, distribn_t>({
+            {0.01, 1e-7}, {0.03, 1e-5}, {0.1, 1e-2}
+        }));
+
+        for (site_t site = 0; site < 100; ++site) {
+            std::array<distribn_t, NV> f, f_eq;
+            LbTestsHelper::InitialiseNearEquilibriumTestData<LATTICE>(site, deviation, f.data());
+            distribn_t density;
+            LatticeMomentum momentum;
+            LATTICE::CalculateDensityAndMomentum(f, density, momentum);
+            LATTICE::CalculateEntropicFeqAnsumali(density, momentum, f_eq);
+
+            lb::HFunction<LATTICE> HFunc(f, f_eq);
+            distribn_t expected = util::NumericalMethods::NewtonRaphson(&HFunc, 2.0, 1e-12);
+            INFO("Site " << site << ", deviation " << deviation);
+            REQUIRE(Approx(expected).margin(tolerance) == KERNEL::EstimateAlpha(f, f_eq, density, momentum));
+        }
+    }
 
+    TEMPLATE_TEST_CASE("Regularised kernels conserve mass and momentum and match LBGK on Hermite moments", "[lb][kernels]",
+                       lb::D3Q15, lb::D3Q19) {
+        using LATTICE = TestType;
+        constexpr auto NV = LATTICE::NUMVECTORS;
+        lb::LbmParameters params(0.001, 0.001, 1000.0, 0.004);
+        lb::InitParams init;
+        init.lbmParams = &params;
+        constexpr distribn_t allowedError = 1e-12;
+
+        for (site_t site = 0; site < 20; ++site) {
+            INFO("Site " << site);
+            std::array<distribn_t, NV> f;
+            LbTestsHelper::InitialiseNearEquilibriumTestData<LATTICE>(site, 0.1, f.data());
+
+            // Regularising twice changes nothing
+            std::array<distribn_t, NV> f_eq, once, twice;
+            distribn_t density;
+            LatticeMomentum momentum;
+            LATTICE::CalculateDensityAndMomentum(f, density, momentum);
+            LATTICE::CalculateFeq(density, momentum, f_eq);
+            std::array<distribn_t, NV> f_neq;
+            for (unsigned i = 0; i < NV; ++i)
+                f_neq[i] = f[i] - f_eq[i];
+            lb::Regularised<LATTICE>::Regularise(f_neq, once);
+            lb::Regularised<LATTICE>::Regularise(once, twice);
+            for (unsigned i = 0; i < NV; ++i)
+                REQUIRE(Approx(once[i]).margin(allowedError) == twice[i]);
+
+            // Collision conserves mass and momentum
+            lb::Regularised<LATTICE> regularised(init);
+            lb::HydroVars<lb::Regularised<LATTICE>> hv(f);
+            regularised.CalculateDensityMomentumFeq(hv, 0);
+            regularised.Collide(&params, hv);
+            distribn_t postDensity;
+            LatticeMomentum postMomentum;
+            LATTICE::CalculateDensityAndMomentum(hv.GetFPostCollision(), postDensity, postMomentum);
+            REQUIRE(Approx(density).margin(allowedError) == postDensity);
+            REQUIRE(ApproxVector<LatticeMomentum>(momentum).Margin(allowedError) == postMomentum);
+
+            // Where f_neq is already in the Hermite subspace it is the
+            // same as LBGK
+            std::array<distribn_t, NV> fHermite;
+            for (unsigned i = 0; i < NV; ++i)
+                fHermite[i] = f_eq[i] + once[i];
+            lb::LBGK<LATTICE> lbgk(init);
+            lb::HydroVars<lb::LBGK<LATTICE>> hvLbgk(fHermite);
+            lbgk.CalculateDensityMomentumFeq(hvLbgk, 0);
+            lbgk.Collide(&params, hvLbgk);
+            lb::HydroVars<lb::Regularised<LATTICE>> hvHermite(fHermite);
+            regularised.CalculateDensityMomentumFeq(hvHermite, 0);
+            regularised.Collide(&params, hvHermite);
+            for (unsigned i = 0; i < NV; ++i)
+                REQUIRE(Approx(hvLbgk.GetFPostCollision()[i]).margin(allowedError)
+                        == hvHermite.GetFPostCollision()[i]);
+
+            // With Guo forcing, the momentum gained is the force
+            LatticeForceVector const force(1e-4, -2e-4, 3e-4);
+            lb::GuoForcingRegularised<LATTICE> forced(init);
+            lb::HydroVars<lb::GuoForcingRegularised<LATTICE>> hvForced(f, force);
+            forced.CalculateDensityMomentumFeq(hvForced, 0);
+            forced.Collide(&params, hvForced);
+            LATTICE::CalculateDensityAndMomentum(hvForced.GetFPostCollision(), postDensity, postMomentum);
+            REQUIRE(Approx(density).margin(allowedError) == postDensity);
+            REQUIRE(ApproxVector<LatticeMomentum>(momentum + force).Margin(allowedError) == postMomentum);
+        }
+    }
+}
@@ -7,6 +7,7 @@
 #define HEMELB_TESTS_LB_LBTESTSHELPER_H
 
 #include <cmath>
+#include <random>
 #include <string>
 
 #include <catch2/catch.hpp>
@@ -170,6 +171,24 @@ namespace hemelb::tests::LbTestsHelper
         }
     }
 
+    // Initialise the distribution to an entropic equilibrium, each
+    // component perturbed by up to a relative deviation, differently
+    // for each site.
+    template<lb::lattice_type LatticeType>
+    void InitialiseNearEquilibriumTestData(site_t site, distribn_t deviation, distribn_t* distribution)
+    {
+        std::minstd_rand rng(site + 1);
+        std::uniform_real_distribution<distribn_t> uniform(-1.0, 1.0);
+        Vec momentum;
+        for (int i = 0; i < 3; ++i)
+            momentum[i] = 0.05 * uniform(rng);
+        LatticeType::CalculateEntropicFeqAnsumali(1.0, momentum, mut_span<LatticeType>(distribution, LatticeType::NUMVECTORS));
+        for (unsigned int direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+        {
+            distribution[direction] *= 1.0 + deviation * uniform(rng);
+        }
+    }
+
     template<lb::lattice_type LatticeType>
     void InitialiseAnisotropicTestData(FourCubeLatticeData& latticeData)
     {
@@ -4,8 +4,10 @@
 // license in the file LICENSE.
 
 
+#include <cmath>
 #include <catch2/catch.hpp>
 #include "lb/kernels/RheologyModels.h"
+#include "lb/kernels/ViscosityTable.h"
 #include "lb/LbmParameters.h"
 
 namespace hemelb
@@ -79,6 +81,57 @@ namespace hemelb
 					  "TruncatedPowerLaw");
       }
     }
+
+    // Check the tabulated tau against the model's at shear rates
+    // spread over (and beyond) the table's range. Only a few segments,
+    // at kinks, may be left to the model.
+    template<class RHEO>
+    void CompareTableAgainstModel(RHEO&& rheo, const LbmParameters& lbp, double tolerance) {
+      auto tau = [&](PhysicalRate rate) {
+	return rheo.CalculateTauForShearRate(rate, 1.0, lbp);
+      };
+      const ViscosityTable table(tau, tolerance);
+
+      int untabulated = 0;
+      for (int i = 0; i <= 10000; ++i) {
+	PhysicalRate rate = std::exp2(-30.0 + 60.0 * i / 10000);
+	auto tabulated = table.Lookup(rate);
+	if (rate < ViscosityTable::MIN_RATE || rate >= ViscosityTable::MAX_RATE) {
+	  REQUIRE(!tabulated);
+	} else if (!tabulated) {
+	  ++untabulated;
+	} else {
+	  INFO("Shear rate " << rate);
+	  CHECK(Approx(tau(rate)).epsilon(tolerance) == *tabulated);
+	}
+      }
+      CHECK(untabulated < 100);
+    }
+
+    TEST_CASE("ViscosityTableTests") {
+      const lb::LbmParameters lbp{1e-4, 1e-4, DEFAULT_FLUID_DENSITY_Kg_per_m3, 0.004};
+      lb::InitParams ip;
+      ip.lbmParams = &lbp;
+      double tolerance = GENERATE(1e-4, 1e-7);
+
+      SECTION("CarreauYasuda") {
+	CompareTableAgainstModel(CarreauYasudaRheologyModelHumanFit{ip}, lbp, tolerance);
+	CompareTableAgainstModel(CarreauYasudaRheologyModelMouseFit{ip}, lbp, tolerance);
+      }
+
+      SECTION("Casson") {
+	CompareTableAgainstModel(CassonRheologyModel{ip}, lbp, tolerance);
+      }
+
+      SECTION("TruncatedPowerLaw") {
+	CompareTableAgainstModel(TruncatedPowerLawRheologyModel{ip}, lbp, tolerance);
+      }
+
+      SECTION("Unattainable") {
+	REQUIRE_THROWS_AS(ViscosityTable([](PhysicalRate rate) { return 1.0 + long(rate * 1e3) % 2; }, 1e-3),
+			  Exception);
+      }
+    }
   }
 }
 
@@ -9,8 +9,10 @@
 
 #include "lb/Kernels.h"
 #include "lb/Streamers.h"
+#include "lb/streamers/IoletVelocityProfiles.h"
 #include "geometry/SiteData.h"
 
+#include "tests/helpers/ApproxVector.h"
 #include "tests/helpers/FourCubeBasedTestFixture.h"
 #include "tests/lb/LbTestsHelper.h"
 
@@ -832,5 +834,47 @@ namespace hemelb::tests
 	  }
 	}
       }
+
+      SECTION("IoletVelocityProfiles") {
+	// A Womersley inlet, whose profile needs Bessel functions
+	configuration::WomersleyVelocityIoletConfig womersley;
+	womersley.position = PhysicalPosition(0.025, 0.025, 0.0);
+	womersley.normal = util::Vector3D<Dimensionless>(0, 0, 1);
+	womersley.radius_m = 0.05;
+	womersley.pgrad_amp_mmHgm = 1.0;
+	womersley.period_s = 60.0 / 70.0;
+	womersley.womersley = 2.0;
+	auto inletBoundary = BuildIolets(geometry::INLET_TYPE, {womersley});
+	auto iolet = dynamic_cast<InOutLetVelocity const*>(inletBoundary.GetLocalIolet(0));
+	REQUIRE(iolet != nullptr);
+
+	// Sites 4 and 5 are not the streamer's, so have no profiles
+	// found in advance
+	const std::vector<Direction> ioletDirections = {1, 8};
+	for (site_t siteIndex = 0; siteIndex < 6; ++siteIndex) {
+	  for (auto i: ioletDirections)
+	    dom->SetHasIolet(siteIndex, i);
+	  dom->SetIoletId(siteIndex, 0);
+	}
+	initParams.boundaryObject = &inletBoundary;
+	initParams.siteRanges = {{0, 4}};
+	IoletVelocityProfiles<LATTICE> halfWay(initParams, 0.5);
+
+	for (int check = 0; check < 4; ++check) {
+	  for (site_t siteIndex = 0; siteIndex < 6; ++siteIndex) {
+	    auto site = latDat->GetSite(siteIndex);
+	    for (auto i: ioletDirections) {
+	      INFO("Site " << siteIndex << ", direction " << i << ", time step " << simState->GetTimeStep());
+	      auto const point = LatticePosition(site.GetGlobalSiteCoords()) + LATTICE::CD[i] * 0.5;
+	      auto const expected = iolet->GetVelocity(point, simState->GetTimeStep());
+	      REQUIRE(expected.GetMagnitude() > 0.0);
+	      REQUIRE(ApproxVector<LatticeVelocity>(expected) == halfWay.GetVelocity(site, i));
+	    }
+	  }
+	  // A quarter of a period
+	  for (int step = 0; step < 250; ++step)
+	    simState->Increment();
+	}
+      }
     }
 }
@@ -0,0 +1,171 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "Traits.h"
+#include "geometry/Domain.h"
+#include "geometry/FieldData.h"
+#include "geometry/GmyReadResult.h"
+#include "geometry/LookupTree.h"
+#include "lb/lattices/D3Q15.h"
+#include "lb/lb.hpp"
+#include "lb/SimulationState.h"
+#include "lb/TemporalBlocking.h"
+#include "net/net.h"
+#include "reporting/Timers.h"
+#include "util/UnitConverter.h"
+
+#include "tests/helpers/HasCommsTestFixture.h"
+
+namespace hemelb::tests
+{
+    using namespace geometry;
+
+    TEST_CASE_METHOD(helpers::HasCommsTestFixture, "TemporalBlocking") {
+      // A fluid cube of 5^3 blocks, so the middle 3^3 are direct
+      using Lattice = lb::D3Q15;
+      U16 const blockSize = 4;
+      Vec16 const dims(5, 5, 5);
+      site_t const blocks = 125;
+      auto buildDomain = [&]() {
+        GmyReadResult readResult(dims, blockSize);
+        for (auto& block: readResult.Blocks) {
+          block.Sites.resize(readResult.GetSitesPerBlock(), GeometrySite(true));
+          for (auto& site: block.Sites) {
+            site.targetProcessor = 0;
+            site.links.resize(Lattice::NUMVECTORS - 1);
+          }
+        }
+        readResult.block_store = std::make_unique<octree::DistributedStore>(
+            readResult.GetSitesPerBlock(),
+            octree::build_block_tree(dims, std::vector<site_t>(blocks, readResult.GetSitesPerBlock())),
+            std::vector<int>(blocks, 0),
+            Comms()
+        );
+        return std::make_shared<Domain>(Lattice::GetLatticeInfo(), readResult, Comms());
+      };
+      auto const domain = buildDomain();
+      auto& dom = *domain;
+      REQUIRE(dom.GetDirectSiteCount() == 27 * dom.GetSitesPerBlockVolumeUnit());
+
+      unsigned const depth = 4;
+      auto const blocking = lb::TemporalBlocking::Build<Lattice>(dom, depth);
+
+      SECTION("Cycles") {
+        REQUIRE(blocking.StartsCycle(1, 100));
+        REQUIRE(!blocking.StartsCycle(2, 100));
+        REQUIRE(blocking.StartsCycle(97, 100));
+        REQUIRE(!blocking.StartsCycle(97, 99));
+        REQUIRE(blocking.GetNextSyncStep(1) == 4);
+        REQUIRE(blocking.GetNextSyncStep(4) == 4);
+        REQUIRE(blocking.GetNextSyncStep(5) == 8);
+      }
+
+      SECTION("Schedule") {
+        // Run a cycle counting the steps each site has taken. A site
+        // may take a step when its neighbours have taken the step
+        // before (so it can read what they streamed to it) and not the
+        // step after (which would overwrite that).
+        auto const local = dom.GetLocalFluidSiteCount();
+        auto const direct = dom.GetDirectSiteCount();
+        std::vector<unsigned> steps(local, 0);
+        auto take_step = [&](site_t site) {
+          for (Direction d = 1; d < Lattice::NUMVECTORS; ++d) {
+            auto const n = dom.GetSite(site).GetStreamedIndex<Lattice>(d) / Lattice::NUMVECTORS;
+            if (n >= local)
+              continue;
+            REQUIRE(steps[n] >= steps[site]);
+            REQUIRE(steps[n] <= steps[site] + 1);
+          }
+          ++steps[site];
+        };
+
+        for (unsigned phase = 0; phase < depth; ++phase) {
+          for (site_t site = direct; site < local; ++site)
+            take_step(site);
+          auto advance = [&](lb::TemporalBlocking::Range const& range, unsigned ahead) {
+            for (site_t site = range.first; site < range.first + range.count; ++site) {
+              REQUIRE(site < direct);
+              REQUIRE(steps[site] == phase + ahead);
+              take_step(site);
+            }
+          };
+          if (phase == 0)
+            blocking.ForEachFirstStepRange(advance);
+          else
+            blocking.ForEachLaterStepRange(phase, advance);
+        }
+        REQUIRE(std::all_of(steps.begin(), steps.end(), [&](unsigned s) { return s == depth; }));
+      }
+
+      SECTION("Same distributions as without blocking") {
+        constexpr auto Q = Lattice::NUMVECTORS;
+        auto const local = dom.GetLocalFluidSiteCount();
+        // Ten steps: five cycles for depth 2, and one or two steps
+        // after the last cycle for depths 3 and 4
+        LatticeTimeStep const totalSteps = 10;
+
+        // Run with the given depth, returning f after each step
+        auto run = [&](unsigned blockingDepth) {
+          FieldData fieldData(buildDomain());
+          auto const& runDom = fieldData.GetDomain();
+          // Near equilibrium, with a different perturbation at each site
+          for (site_t i = 0; i < local; ++i) {
+            auto const x = runDom.GetSite(i).GetGlobalSiteCoords();
+            for (Direction d = 0; d < Q; ++d)
+              *fieldData.GetFOld(i * Q + d) = *fieldData.GetFNew(i * Q + d) = Lattice::EQMWEIGHTS[d]
+                  * (1.0 + 0.001 * ((7 * x.x() + 13 * x.y() + 17 * x.z() + d) % 11));
+          }
+
+          lb::SimulationState state(1e-4, totalSteps);
+          util::UnitConverter units(1e-4, 1e-3, PhysicalPosition::Zero(), 1000.0, 0.0);
+          lb::BoundaryValues inlet(INLET_TYPE, runDom, {}, &state, Comms(), units);
+          lb::BoundaryValues outlet(OUTLET_TYPE, runDom, {}, &state, Comms(), units);
+          net::Net net(Comms());
+          reporting::Timers timers(Comms());
+          lb::LBM<Traits<Lattice>> lbm(lb::LbmParameters(1e-4, 1e-3), &net, &fieldData, &state, timers, nullptr);
+          lbm.Initialise(&inlet, &outlet);
+          lbm.SetTemporalBlocking(blockingDepth);
+
+          std::vector<std::vector<distribn_t>> fAfter;
+          for (LatticeTimeStep step = 1; step <= totalSteps; ++step) {
+            REQUIRE(state.GetTimeStep() == step);
+            lbm.RequestComms();
+            lbm.PreSend();
+            net.Send();
+            lbm.PreReceive();
+            net.Receive();
+            net.Wait();
+            lbm.PostReceive();
+            lbm.EndIteration();
+            fieldData.SwapOldAndNew();
+            fAfter.emplace_back(fieldData.GetFOld(0), fieldData.GetFOld(local * Q));
+            state.Increment();
+          }
+          return fAfter;
+        };
+
+        auto const expected = run(1);
+        for (unsigned blockingDepth: {2u, 3u, 4u}) {
+          auto const actual = run(blockingDepth);
+          for (LatticeTimeStep step = 1; step <= totalSteps; ++step) {
+            INFO("Depth " << blockingDepth << ", step " << step);
+            // The direct sites may be ahead within a cycle, but the
+            // others never are, and all catch up by its end. Steps
+            // after the last whole cycle are not blocked.
+            auto const synced = step % blockingDepth == 0 || step > totalSteps / blockingDepth * blockingDepth;
+            auto const first = synced ? 0 : dom.GetDirectSiteCount() * Q;
+            REQUIRE(std::equal(actual[step - 1].begin() + first, actual[step - 1].end(),
+                               expected[step - 1].begin() + first));
+          }
+        }
+      }
+    }
+}
@@ -3,11 +3,14 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 
+#include <fstream>
+
 #include <catch2/catch.hpp>
 
 #include "lb/iolets/InOutLets.h"
 #include "configuration/SimConfig.h"
 #include "configuration/SimBuilder.h"
+#include "net/MpiCommunicator.h"
 #include "resources/Resource.h"
 
 #include "tests/helpers/ApproxVector.h"
@@ -320,5 +323,44 @@ namespace hemelb::tests
 
     }
 
+    TEST_CASE_METHOD(helpers::FolderTestFixture, "IoletTimeSeriesTests") {
+
+        SECTION("TestInterpolate") {
+            lb::IoletTimeSeries series({0.0, 1.0, 3.0}, {2.0, 4.0, 0.0});
+            REQUIRE(Approx(2.0) == series.Interpolate(0.0));
+            REQUIRE(Approx(3.0) == series.Interpolate(0.5));
+            REQUIRE(Approx(4.0) == series.Interpolate(1.0));
+            REQUIRE(Approx(2.0) == series.Interpolate(2.0));
+            // Held constant outside the samples
+            REQUIRE(Approx(2.0) == series.Interpolate(-1.0));
+            REQUIRE(Approx(0.0) == series.Interpolate(5.0));
+
+            REQUIRE_THROWS_AS(lb::IoletTimeSeries({0.0}, {1.0}), Exception);
+            REQUIRE_THROWS_AS(lb::IoletTimeSeries({0.0, 0.0}, {1.0, 2.0}), Exception);
+            REQUIRE_THROWS_AS(lb::IoletTimeSeries({0.0, 1.0}, {1.0}), Exception);
+        }
+
+        SECTION("TestRead") {
+            MoveToTempdir();
+            {
+                // Unsorted, with a repeated time and a trailing newline
+                std::ofstream file("series.txt");
+                file << "2.0 5.0\n0.0 1.0\n1.0 2.0\n1.0 3.0\n";
+            }
+
+            auto check = [](lb::IoletTimeSeries const& series) {
+                REQUIRE(series.GetTimes() == std::vector<double>{0.0, 1.0, 2.0});
+                REQUIRE(series.GetValues() == std::vector<double>{1.0, 3.0, 5.0});
+            };
+            check(lb::IoletTimeSeries::Read("series.txt"));
+
+            auto const world = net::MpiCommunicator::World();
+            check(lb::IoletTimeSeries::Read("series.txt", world, 0));
+
+            REQUIRE_THROWS_AS(lb::IoletTimeSeries::Read("missing.txt"), Exception);
+            REQUIRE_THROWS_AS(lb::IoletTimeSeries::Read("missing.txt", world, 0), Exception);
+        }
+    }
+
 }
 
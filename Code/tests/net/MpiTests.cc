@@ -44,6 +44,24 @@ namespace hemelb
 	// Same ranks, but different context.
 	REQUIRE(commWorld2 != commWorld);
       }
+
+      SECTION("All to all with variable sizes") {
+	// Rank r sends r + 1 copies of 100 * r + destination to each process
+	auto const rank = commWorld.Rank();
+	auto const size = commWorld.Size();
+	displaced_data<int> send{std::vector<int>(size, rank + 1)};
+	for (int dest = 0; dest < size; ++dest)
+	  for (auto& value: send[dest])
+	    value = 100 * rank + dest;
+
+	auto received = commWorld.AllToAllV(send);
+	REQUIRE(received.size() == std::size_t(size));
+	for (int source = 0; source < size; ++source) {
+	  REQUIRE(received[source].size() == std::size_t(source + 1));
+	  for (auto const value: received[source])
+	    REQUIRE(value == 100 * source + rank);
+	}
+      }
     }
   }
 }
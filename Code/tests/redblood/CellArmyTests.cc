@@ -3,6 +3,8 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 
+#include <cmath>
+
 #include <catch2/catch.hpp>
 
 #include "redblood/CellArmy.h"
@@ -34,6 +36,21 @@ namespace hemelb::tests
         }
     };
 
+    //! Mock cell with a different force on each node
+    class PushedCell : public FakeCell
+    {
+    public:
+        using FakeCell::FakeCell;
+        LatticeEnergy operator()(std::vector<LatticeForceVector> &forces) const override
+        {
+            for (size_t i(0); i < forces.size(); ++i)
+            {
+                forces[i] = LatticeForceVector(1e-3 * (i + 1), -2e-3, 3e-3 * i);
+            }
+            return 0;
+        }
+    };
+
     TEST_CASE_METHOD(helpers::FourCubeBasedTestFixture<32>, "CellArmyTests", "[redblood]") {
       using namespace redblood;
 
@@ -155,6 +172,84 @@ namespace hemelb::tests
         }
       }
 
+      SECTION("testFarStencil") {
+        // One cell within wall interaction range of the x = 0 wall, the other in the middle of
+        // the cube, away from the walls and the first cell
+        LatticePosition const nearShift(2, 16, 16), farShift(16, 16, 16);
+        auto makeCell = [](LatticePosition const &shift)
+        {
+          auto cell = std::make_shared<PushedCell>(pancakeSamosa());
+          *cell += shift;
+          return cell;
+        };
+
+        // Runs an interpolation then a spreading step on a velocity field that is not linear,
+        // so that the stencils give different results. Returns the forces on the lattice.
+        auto step = [&](CellArmy<Traits> &army)
+        {
+          helpers::ZeroOutFOld(latDat.get());
+          helpers::ZeroOutForces(latDat.get());
+          helpers::setUpDistribution<lb::D3Q15>(latDat.get(), 0, [](PhysicalVelocity const &)
+          {
+            return 1.0;
+          });
+          helpers::setUpDistribution<lb::D3Q15>(latDat.get(), 1, [](PhysicalVelocity const &x)
+          {
+            return 0.1 + 0.05 * std::sin(0.7 * x[0]) * std::cos(0.5 * x[1] + 0.3 * x[2]);
+          });
+          army.SetCell2Cell(/* intensity */1e0, /* cutoff */0.5);
+          army.SetCell2Wall(/* intensity */1e0, /* cutoff */2.5);
+          army.Fluid2CellInteractions();
+          army.Cell2FluidInteractions();
+
+          std::vector<LatticeForceVector> forces;
+          for (site_t i(0); i < latDat->GetDomain().GetLocalFluidSiteCount(); ++i)
+          {
+            forces.push_back(latDat->GetSite(i).GetForce());
+          }
+          return forces;
+        };
+        auto run = [&](CellContainer cells, stencil::Variant const &stencil)
+        {
+          CellArmy<Traits> army(*latDat, cells, BuildTemplateContainer(cells), *timers, cutoff);
+          army.SetStencils(stencil);
+          return step(army);
+        };
+
+        auto const nearCell = makeCell(nearShift);
+        auto const farCell = makeCell(farShift);
+        CellContainer cells{nearCell, farCell};
+        CellArmy<Traits> army(*latDat, cells, BuildTemplateContainer(cells), *timers, cutoff);
+        army.SetCell2Cell(/* intensity */1e0, /* cutoff */0.5);
+        army.SetCell2Wall(/* intensity */1e0, /* cutoff */2.5);
+        army.SetStencils(stencil::FourPoint{}, stencil::TwoPoint{});
+        REQUIRE(army.GetFarCells().size() == 1);
+        REQUIRE(army.GetFarCells().count(farCell) == 1);
+        auto const forces = step(army);
+        REQUIRE(army.GetFarCells().size() == 1);
+        REQUIRE(army.GetFarCells().count(farCell) == 1);
+
+        // Each cell on its own, with the stencil it should have used
+        auto const nearAlone = makeCell(nearShift);
+        auto const farAlone = makeCell(farShift);
+        auto const nearForces = run({nearAlone}, stencil::FourPoint{});
+        auto const farForces = run({farAlone}, stencil::TwoPoint{});
+        for (size_t i(0); i < nearCell->GetNumberOfNodes(); ++i)
+        {
+          REQUIRE(nearCell->GetVertices()[i] == ApproxV(nearAlone->GetVertices()[i]));
+          REQUIRE(farCell->GetVertices()[i] == ApproxV(farAlone->GetVertices()[i]));
+        }
+        for (size_t i(0); i < forces.size(); ++i)
+        {
+          REQUIRE(forces[i] == ApproxV(nearForces[i] + farForces[i]));
+        }
+
+        // Otherwise the far cell would not have moved the same way
+        auto const farFourPoint = makeCell(farShift);
+        run({farFourPoint}, stencil::FourPoint{});
+        REQUIRE(farCell->GetVertices().front() != ApproxV(farFourPoint->GetVertices().front()));
+      }
+
       SECTION("testCellOutput") {
         auto cell = std::make_shared<FakeCell>(tetrahedron());
         // Shift cell to be contained in flow domain
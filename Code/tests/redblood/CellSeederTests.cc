@@ -0,0 +1,82 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <algorithm>
+#include <numbers>
+
+#include <catch2/catch.hpp>
+
+#include "redblood/Cell.h"
+#include "redblood/CellSeeder.h"
+
+namespace hemelb::tests
+{
+    using namespace redblood;
+
+    TEST_CASE("CellSeederTests", "[redblood]") {
+      // Sphere of radius 3 with edges of about one lattice unit
+      Cell templateCell(icoSphere(3));
+      templateCell *= 3e0;
+      Cylinder const cylinder{ LatticePosition(0, 0, 1), LatticePosition(1, 2, 3), 12e0, 40e0 };
+      auto const region = SeedingRegion::FromCylinder(cylinder);
+      SeedingParameters parameters;
+      parameters.haematocrit = 0.1;
+      parameters.separation = 1e0;
+      parameters.seed = 42;
+
+      SECTION("Region from cylinder") {
+        REQUIRE(region.volume == Approx(std::numbers::pi * 12e0 * 12e0 * 40e0));
+        REQUIRE(region.lower.z() == Approx(3e0));
+        REQUIRE(region.upper.z() == Approx(43e0));
+        REQUIRE(region.lower.x() == Approx(1e0 - 12e0));
+        REQUIRE(region.upper.y() == Approx(2e0 + 12e0));
+        REQUIRE(region.contains(LatticePosition(1, 2, 20)));
+        REQUIRE(not region.contains(LatticePosition(1, 20, 20)));
+      }
+
+      SECTION("Reaches target without overlaps") {
+        auto const cells = SeedCells(templateCell, region, parameters);
+        auto const target = std::round(0.1 * region.volume / templateCell.GetVolume());
+        REQUIRE(double(cells.size()) == target);
+
+        for (auto const& cell: cells) {
+          REQUIRE(cell->GetVolume() == Approx(templateCell.GetVolume()));
+          for (auto const& vertex: cell->GetVertices())
+            REQUIRE(contains(cylinder, vertex));
+          for (auto const& other: cells) {
+            if (other == cell)
+              continue;
+            // Spheres are disjoint if their centres are further apart than their diameter
+            REQUIRE((cell->GetBarycenter() - other->GetBarycenter()).GetMagnitude() > 6e0);
+          }
+        }
+      }
+
+      SECTION("Same positions for the same seed") {
+        auto const barycenters = [&]() {
+          std::vector<LatticePosition> result;
+          for (auto const& cell: SeedCells(templateCell, region, parameters))
+            result.push_back(cell->GetBarycenter());
+          std::sort(result.begin(), result.end(), [](auto const& a, auto const& b) {
+            return a.x() < b.x();
+          });
+          return result;
+        };
+        auto const first = barycenters();
+        auto const second = barycenters();
+        REQUIRE(first.size() == second.size());
+        for (std::size_t i = 0; i < first.size(); ++i)
+          REQUIRE((first[i] - second[i]).GetMagnitude() == Approx(0e0).margin(1e-12));
+      }
+
+      SECTION("Gives up when the region is full") {
+        parameters.haematocrit = 0.9;
+        parameters.maxAttemptsPerCell = 50;
+        auto const cells = SeedCells(templateCell, region, parameters);
+        REQUIRE(cells.size() > 0);
+        REQUIRE(double(cells.size()) < std::round(0.9 * region.volume / templateCell.GetVolume()));
+      }
+    }
+}
@@ -133,6 +133,30 @@ namespace hemelb
 	REQUIRE(cell0.GetTag() != cell1->GetTag());
       }
 
+      SECTION("testTemplateSharing") {
+	Mesh const templateMesh(original);
+	Cell cell0(templateMesh.GetVertices(), templateMesh, 1e0, "joe");
+	Cell cell1(templateMesh.GetVertices(), templateMesh, 1.2, "joe");
+	auto cell2 = cell0.clone();
+	REQUIRE(cell0.GetTemplate() == cell1.GetTemplate());
+	REQUIRE(cell0.GetTemplate() == cell2->GetTemplate());
+	REQUIRE(cell0.GetTemplateName() == "joe");
+
+	// Different names or different meshes are different templates
+	Cell cell3(templateMesh.GetVertices(), templateMesh, 1e0, "bob");
+	Cell cell4(templateMesh.GetVertices(), templateMesh.clone(), 1e0, "joe");
+	REQUIRE(cell0.GetTemplate() != cell3.GetTemplate());
+	REQUIRE(cell0.GetTemplate() != cell4.GetTemplate());
+	cell3.SetTemplateName("joe");
+	REQUIRE(cell0.GetTemplate() == cell3.GetTemplate());
+
+	// A cell owns its vertices, but not its template
+	auto const nVertices = cell0.GetNumberOfNodes();
+	REQUIRE(cell0.MemoryFootprint() >= nVertices * sizeof(LatticePosition));
+	REQUIRE(cell0.MemoryFootprint() < cell0.GetTemplate()->MemoryFootprint()
+		+ nVertices * sizeof(LatticePosition));
+      }
+
       SECTION("testGetAverageEdgeLength") {
 	// MeshData original is a tetrahedron with 3 edges of length 1 and 3 edges of length sqrt(2)
 	Cell cell(original);
@@ -0,0 +1,76 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <catch2/catch.hpp>
+#include <boost/uuid/uuid_io.hpp>
+
+#include "io/formats/cells.h"
+#include "io/readers/XdrFileReader.h"
+#include "redblood/Cell.h"
+#include "redblood/CollectiveCellWriter.h"
+#include "redblood/types.h"
+#include "tests/helpers/ApproxVector.h"
+#include "tests/helpers/FolderTestFixture.h"
+
+namespace hemelb::tests
+{
+    using namespace redblood;
+
+    static PhysicalPosition ReadPosition(io::XdrReader& reader) {
+      auto const x = reader.read<double>();
+      auto const y = reader.read<double>();
+      auto const z = reader.read<double>();
+      return {x, y, z};
+    }
+
+    TEST_CASE_METHOD(helpers::FolderTestFixture, "CollectiveCellWriterTests", "[redblood]") {
+      auto const& comms = Comms();
+      auto const converter = std::make_shared<util::UnitConverter>(
+              1e-4, 2e-6, PhysicalPosition(1e-3, 0, 0), 1000.0, 0.0);
+
+      auto cell = std::make_shared<Cell>(icoSphere());
+      *cell += LatticePosition(comms.Rank(), 2, 3);
+      cell->SetScale(1.5);
+      cell->SetTemplateName("icosahedron");
+      CellContainer const cells{ cell };
+
+      SECTION("Serialised record size") {
+        // tag, template name, scale, barycentre, number of vertices, vertices
+        auto const expected = (4 + 36) + (4 + 12) + 8 + 3 * 8 + 4 + cell->GetNumberOfNodes() * 3 * 8;
+        REQUIRE(std::size_t(expected) == CollectiveCellWriter::Serialise(cells, *converter).size());
+        REQUIRE(CollectiveCellWriter::Serialise({}, *converter).empty());
+      }
+
+      SECTION("Single file holds the cells of every process") {
+        auto const filename = GetTempdir() / "cells.xdr";
+        {
+          CollectiveCellWriter writer(comms, converter);
+          writer.Write(filename, 42, cells);
+        }
+        if (comms.Rank() != 0)
+          return;
+
+        io::XdrFileReader reader(filename);
+        REQUIRE(reader.read<std::uint32_t>() == io::formats::HemeLbMagicNumber);
+        REQUIRE(reader.read<std::uint32_t>() == io::formats::cells::MagicNumber);
+        REQUIRE(reader.read<std::uint32_t>() == io::formats::cells::VersionNumber);
+        REQUIRE(reader.read<std::uint32_t>() == io::formats::cells::HeaderLength);
+        REQUIRE(reader.read<std::uint64_t>() == 42);
+        REQUIRE(reader.read<std::uint64_t>() == std::uint64_t(comms.Size()));
+        REQUIRE(reader.read<std::uint64_t>()
+                == std::uint64_t(comms.Size() * cell->GetNumberOfNodes()));
+
+        // First record comes from this process
+        REQUIRE(reader.read<std::string>() == boost::uuids::to_string(cell->GetTag()));
+        REQUIRE(reader.read<std::string>() == "icosahedron");
+        REQUIRE(reader.read<double>() == Approx(1.5));
+        REQUIRE(ReadPosition(reader) == ApproxV(converter->ConvertPositionToPhysicalUnits(cell->GetBarycenter())));
+        REQUIRE(reader.read<std::uint32_t>() == std::uint32_t(cell->GetNumberOfNodes()));
+        for (auto const& vertex: cell->GetVertices()) {
+          REQUIRE(ReadPosition(reader) == ApproxV(converter->ConvertPositionToPhysicalUnits(vertex)));
+        }
+      }
+    }
+}
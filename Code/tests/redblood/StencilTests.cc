@@ -98,6 +98,24 @@ namespace hemelb
 	  REQUIRE(actual == approx(expected[i]));
 	}
       }
+
+      SECTION("Runtime choice") {
+	using namespace redblood::stencil;
+	REQUIRE(std::holds_alternative<FourPoint>(FromName("FourPoint")));
+	REQUIRE(std::holds_alternative<CosineApprox>(FromName("CosineApprox")));
+	REQUIRE(std::holds_alternative<ThreePoint>(FromName("ThreePoint")));
+	REQUIRE(std::holds_alternative<TwoPoint>(FromName("TwoPoint")));
+	REQUIRE_THROWS_AS(FromName("FivePoint"), Exception);
+
+	REQUIRE(GetRange(FromName("FourPoint")) == 4);
+	REQUIRE(GetRange(FromName("ThreePoint")) == 3);
+	REQUIRE(GetRange(FromName("TwoPoint")) == 2);
+
+	auto const weight = std::visit([](auto const& s) {
+	  return s.stencil(LatticePosition(0.5, 0, 0));
+	}, FromName("TwoPoint"));
+	REQUIRE(weight == approx(0.5));
+      }
     }
   }
 }
@@ -4,6 +4,7 @@
 // license in the file LICENSE.
 
 #include <algorithm>
+#include <cstdint>
 #include <functional>
 
 #include <catch2/catch.hpp>
@@ -21,26 +22,27 @@ namespace hemelb::tests
     class ExchangeCells : public redblood::parallel::ExchangeCells
     {
     public:
-        ExchangeCells(net::MpiCommunicator const &graphComm) :
-                redblood::parallel::ExchangeCells(graphComm)
+        ExchangeCells(net::MpiCommunicator const &graphComm,
+                      std::shared_ptr<redblood::TemplateCellContainer const> templates) :
+                redblood::parallel::ExchangeCells(graphComm, std::move(templates))
         {
         }
-#define HEMELB_MACRO(Name, name, TYPE)	  \
-      net::TYPE & Get ## Name()			  \
-      {						  \
-	return name;				  \
+      net::INeighborAllToAll<int> & GetMessageLengths()
+      {
+	return messageLengths;
+      }
+      net::INeighborAllToAllV<char> & GetCellMessages()
+      {
+	return cellMessages;
+      }
+      //! Size of the packed message for the given cells and number of vertices
+      static size_t MessageSize(size_t nCells, size_t nVertices, size_t bytesPerVertex = 24)
+      {
+	return sizeof(std::uint32_t)
+	  + nCells * (sizeof(boost::uuids::uuid) + 2 * sizeof(std::int32_t) + sizeof(LatticeDistance)
+		      + sizeof(std::uint32_t) + sizeof(VertexEncoding))
+	  + nVertices * bytesPerVertex;
       }
-
-      HEMELB_MACRO(CellCount, cellCount, INeighborAllToAll<int>);
-      HEMELB_MACRO(TotalNodeCount, totalNodeCount, INeighborAllToAll<int>);
-      HEMELB_MACRO(NameLengths, nameLengths, INeighborAllToAll<int>);
-      HEMELB_MACRO(NodeCount, nodeCount, INeighborAllToAllV<size_t>);
-      HEMELB_MACRO(CellScales, cellScales, INeighborAllToAllV<LatticeDistance>);
-      HEMELB_MACRO(OwnerIDs, ownerIDs, INeighborAllToAllV<int>);
-      HEMELB_MACRO(CellUUIDs, cellUUIDs, INeighborAllToAllV<unsigned char>);
-      HEMELB_MACRO(NodePositions, nodePositions, INeighborAllToAllV<LatticePosition>);
-      HEMELB_MACRO(TemplateNames, templateNames, INeighborAllToAllV<char>);
-#undef HEMELB_MACRO
     };
 
     using namespace hemelb::redblood;
@@ -67,6 +69,8 @@ namespace hemelb::tests
       void testLendCells();
       //! Several cells to and from several processors
       void testMotherOfAll();
+      //! Lent cells are sent as displacements once the receiver knows them
+      void testLentCellDeltas();
 
       //! Set of nodes affected by given proc
       std::set<proc_t> nodeLocation(LatticePosition const &node) const;
@@ -96,6 +100,13 @@ namespace hemelb::tests
 		       scale, depth);
       }
 
+      //! Templates used by cells from GetCell
+      std::shared_ptr<TemplateCellContainer const> DefaultTemplates() const
+      {
+	return std::make_shared<TemplateCellContainer const>(
+	  TemplateCellContainer { { "default", GetCell() } });
+      }
+
       //! Id of owning cell
       int Ownership(CellContainer::const_reference cell) const;
       //! Checks that two cells are identical
@@ -242,21 +253,19 @@ namespace hemelb::tests
       }
       auto const dist = GetNodeDistribution(cells);
 
-      ExchangeCells xc(graph);
-      REQUIRE(xc.GetCellCount().GetCommunicator());
-      REQUIRE(xc.GetTotalNodeCount().GetCommunicator());
+      ExchangeCells xc(graph, DefaultTemplates());
+      REQUIRE(xc.GetMessageLengths().GetCommunicator());
+      REQUIRE(xc.GetCellMessages().GetCommunicator());
       auto keepOwnership = [this](CellContainer::const_reference) {
 	return graph.Rank();
       };
       xc.PostCellMessageLength(dist, cells, keepOwnership);
 
       // Checks message is correct
-      auto const &sendCellCount = xc.GetCellCount().GetSendBuffer();
-      auto const &sendTotalNodeCount = xc.GetTotalNodeCount().GetSendBuffer();
+      auto const &sendLengths = xc.GetMessageLengths().GetSendBuffer();
       auto const neighbors = graph.GetNeighbors();
-      REQUIRE(neighbors.size() == sendCellCount.size());
-      REQUIRE(neighbors.size() == sendTotalNodeCount.size());
-      for (auto const item : util::zip(neighbors, sendCellCount, sendTotalNodeCount)) {
+      REQUIRE(neighbors.size() == sendLengths.size());
+      for (auto const item : util::zip(neighbors, sendLengths)) {
 	auto const sending = std::get<0>(item) == static_cast<int>(sendto);
 	size_t const nCells = sending ?
 	  1 :
@@ -264,14 +273,11 @@ namespace hemelb::tests
 	size_t const nVertices = sending ?
 	  (*cells.begin())->GetNumberOfNodes() :
 	  0;
-	REQUIRE(int(nCells) == std::get<1>(item));
-	REQUIRE(int(nVertices) == int(std::get<2>(item)));
+	REQUIRE(ExchangeCells::MessageSize(nCells, nVertices) == size_t(std::get<1>(item)));
       }
 
       // Wait for end of request and check received lengths
-      xc.GetCellCount().receive();
-      xc.GetTotalNodeCount().receive();
-      xc.GetNameLengths().receive();
+      xc.GetMessageLengths().receive();
       auto const recvfrom = graph.Rank() == 0 ?
 	1 :
 	graph.Rank() == 1 ?
@@ -280,11 +286,9 @@ namespace hemelb::tests
 	3 :
 	std::numeric_limits<size_t>::max();
 
-      auto const &receiveCellCount = xc.GetCellCount().GetReceiveBuffer();
-      auto const &receiveTotalNodeCount = xc.GetTotalNodeCount().GetReceiveBuffer();
-      REQUIRE(neighbors.size() == receiveCellCount.size());
-      REQUIRE(neighbors.size() == receiveTotalNodeCount.size());
-      for (auto const item : util::zip(neighbors, receiveCellCount, receiveTotalNodeCount)) {
+      auto const &receiveLengths = xc.GetMessageLengths().GetReceiveBuffer();
+      REQUIRE(neighbors.size() == receiveLengths.size());
+      for (auto const item : util::zip(neighbors, receiveLengths)) {
 	auto const receiving = std::get<0>(item) == static_cast<int>(recvfrom);
 	size_t const nCells = receiving ?
 	  1 :
@@ -292,8 +296,7 @@ namespace hemelb::tests
 	size_t const nVerts = receiving ?
 	  GetCell(center, 1e0, recvfrom)->GetNumberOfNodes() :
 	  0;
-	REQUIRE(int(nCells) == std::get<1>(item));
-	REQUIRE(int(nVerts) == int(std::get<2>(item)));
+	REQUIRE(ExchangeCells::MessageSize(nCells, nVerts) == size_t(std::get<1>(item)));
       }
     }
 
@@ -321,12 +324,12 @@ namespace hemelb::tests
       }
       auto const dist = GetNodeDistribution(cells);
 
-      ExchangeCells xc(graph);
+      ExchangeCells xc(graph, DefaultTemplates());
       auto keepOwnership = [this](CellContainer::const_reference) {
 	return graph.Rank();
       };
       xc.PostCellMessageLength(dist, cells, keepOwnership);
-      xc.PostCells(dist, cells, keepOwnership);
+      xc.PostCells();
 
       // check message sizes
       auto const neighbors = graph.GetNeighbors();
@@ -336,37 +339,34 @@ namespace hemelb::tests
       unsigned long const Nreceive = graph.Rank() < 3 ?
 						    1 :
 	0;
-      unsigned long const uuid_size = sizeof(boost::uuids::uuid);
-      REQUIRE(Nsend == xc.GetCellScales().GetSendBuffer().size());
-      REQUIRE(Nreceive == xc.GetCellScales().GetReceiveBuffer().size());
-      REQUIRE(Nsend == xc.GetNodeCount().GetSendBuffer().size());
-      REQUIRE(Nreceive == xc.GetNodeCount().GetReceiveBuffer().size());
-      REQUIRE(Nsend * uuid_size == xc.GetCellUUIDs().GetSendBuffer().size());
-      REQUIRE(Nreceive * uuid_size == xc.GetCellUUIDs().GetReceiveBuffer().size());
-
-      if (cells.size() > 0 and graph.Rank() < 4) {
-	auto const cell = *cells.begin();
-	auto const xcScale = xc.GetCellScales().GetSendBuffer()[0];
-	auto const xcTag = xc.GetCellUUIDs().GetSendBuffer()[0];
-	auto const xcNodes = xc.GetNodeCount().GetSendBuffer()[0];
-	REQUIRE(approx(cell->GetScale()) == xcScale);
-	REQUIRE(*cell->GetTag().begin() == xcTag);
-	REQUIRE(cell->GetNumberOfNodes() == site_t(xcNodes));
-      }
+      size_t const nSendNodes = Nsend ?
+	GetCell(center, getScale(graph.Rank()), graph.Rank())->GetNumberOfNodes() :
+	0;
+      size_t const nReceiveNodes = Nreceive ?
+	GetCell(center, getScale(graph.Rank() + 1), graph.Rank() + 1)->GetNumberOfNodes() :
+	0;
+      // one header per neighbor, with or without cells
+      auto const expectedSize = [&neighbors](size_t nCells, size_t nVertices) {
+	return neighbors.empty() ?
+	  size_t(0) :
+	  ExchangeCells::MessageSize(nCells, nVertices)
+	  + (neighbors.size() - 1) * ExchangeCells::MessageSize(0, 0);
+      };
+      REQUIRE(expectedSize(Nsend, nSendNodes) == xc.GetCellMessages().GetSendBuffer().size());
+      REQUIRE(expectedSize(Nreceive, nReceiveNodes)
+	      == xc.GetCellMessages().GetReceiveBuffer().size());
 
       // receive messages
-      xc.GetNodeCount().receive();
-      xc.GetCellScales().receive();
-      xc.GetOwnerIDs().receive();
-      xc.GetCellUUIDs().receive();
-      xc.GetNodePositions().receive();
-      xc.GetTemplateNames().receive();
+      auto const result = xc.ReceiveCells();
 
       if (graph.Rank() < 3) {
 	auto const scale = getScale(graph.Rank() + 1);
 	auto const nNodes = GetCell(center, scale, graph.Rank() + 1)->GetNumberOfNodes();
-	REQUIRE(approx(scale) == xc.GetCellScales().GetReceiveBuffer()[0]);
-	REQUIRE(approx(nNodes) == xc.GetNodeCount().GetReceiveBuffer()[0]);
+	auto const & lent = std::get<2>(result);
+	REQUIRE(size_t(1) == lent.size());
+	auto const cell = *lent.begin()->second.begin();
+	REQUIRE(approx(scale) == cell->GetScale());
+	REQUIRE(nNodes == cell->GetNumberOfNodes());
       }
     }
 
@@ -378,7 +378,7 @@ namespace hemelb::tests
         }
 
       auto templates =
-	std::make_shared<TemplateCellContainer>(TemplateCellContainer { { "1", GivenCell(1) },
+	std::make_shared<TemplateCellContainer const>(TemplateCellContainer { { "1", GivenCell(1) },
 	      { "2", GivenCell(2) },
 		{ "3", GivenCell(3) } });
 
@@ -386,14 +386,14 @@ namespace hemelb::tests
       std::map<proc_t, CellContainer> lent;
       auto const dist = GetNodeDistribution(owned);
 
-      ExchangeCells xc(graph);
+      ExchangeCells xc(graph, templates);
       auto keepOwnership = [this](CellContainer::const_reference)
         {
           return graph.Rank();
         };
       xc.PostCellMessageLength(dist, owned, keepOwnership);
-      xc.PostCells(dist, owned, keepOwnership);
-      auto const result = xc.ReceiveCells(templates);
+      xc.PostCells();
+      auto const result = xc.ReceiveCells();
 
       if (graph.Rank() < 3)
         {
@@ -421,7 +421,7 @@ namespace hemelb::tests
         }
 
       auto templates =
-	std::make_shared<TemplateCellContainer>(TemplateCellContainer { { "1", GivenCell(1) },
+	std::make_shared<TemplateCellContainer const>(TemplateCellContainer { { "1", GivenCell(1) },
 	      { "2", GivenCell(2) },
 		{ "3", GivenCell(3) } });
 
@@ -429,13 +429,13 @@ namespace hemelb::tests
       std::map<proc_t, CellContainer> lent;
       auto const dist = GetNodeDistribution(owned);
 
-      ExchangeCells xc(graph);
+      ExchangeCells xc(graph, templates);
       auto ownership = [this](CellContainer::const_reference cell) {
 	return this->Ownership(cell);
       };
       xc.PostCellMessageLength(dist, owned, ownership);
-      xc.PostCells(dist, owned, ownership);
-      auto const result = xc.ReceiveCells(templates);
+      xc.PostCells();
+      auto const result = xc.ReceiveCells();
 
       REQUIRE(size_t(0) == std::get<2>(result).size());
       if (graph.Rank() < 3)
@@ -515,7 +515,8 @@ namespace hemelb::tests
         }
 
       auto const templateCell = GivenCell(0);
-      TemplateCellContainer const templates { { templateCell->GetTemplateName(), templateCell } };
+      auto const templates = std::make_shared<TemplateCellContainer const>(
+	TemplateCellContainer { { templateCell->GetTemplateName(), templateCell } });
 
       std::vector<int> const sendto = { 0, 0, 1, 2, 3 };
       std::vector<CellContainer::value_type> cells;
@@ -534,13 +535,13 @@ namespace hemelb::tests
       CellContainer { };
       auto const dist = GetNodeDistribution(owned);
 
-      ExchangeCells xc(graph);
+      ExchangeCells xc(graph, templates);
       auto ownership = [this](CellContainer::const_reference cell) {
 	return this->Ownership(cell);
       };
       xc.PostCellMessageLength(dist, owned, ownership);
-      xc.PostCells(dist, owned, ownership);
-      auto const result = xc.ReceiveCells(templates);
+      xc.PostCells();
+      auto const result = xc.ReceiveCells();
       xc.Update(owned, result);
 
       REQUIRE(size_t(0) == std::get<2>(result).size());
@@ -578,7 +579,8 @@ namespace hemelb::tests
         }
 
       auto const templateCell = GivenCell(0);
-      TemplateCellContainer const templates { { templateCell->GetTemplateName(), templateCell } };
+      auto const templates = std::make_shared<TemplateCellContainer const>(
+	TemplateCellContainer { { templateCell->GetTemplateName(), templateCell } });
 
       std::vector<int> const sendto = { 0, 1 };
       std::vector<CellContainer::value_type> cells;
@@ -601,13 +603,13 @@ namespace hemelb::tests
       CellContainer { };
       auto const dist = GetNodeDistribution(owned);
 
-      ExchangeCells xc(graph);
+      ExchangeCells xc(graph, templates);
       auto const ownership = std::bind(&CellParallelizationTests::Ownership,
 				       *this,
 				       std::placeholders::_1);
       xc.PostCellMessageLength(dist, owned, ownership);
-      xc.PostCells(dist, owned, ownership);
-      auto const result = xc.ReceiveCells(templates);
+      xc.PostCells();
+      auto const result = xc.ReceiveCells();
       xc.Update(owned, result);
 
       switch (graph.Rank())
@@ -640,14 +642,11 @@ namespace hemelb::tests
 								     GivenCell(1),
 								     GivenCell(2),
 								     GivenCell(3) };
-      TemplateCellContainer const templates = { { templateCells[0]->GetTemplateName(),
-						  templateCells[0] },
-						{ templateCells[1]->GetTemplateName(),
-						  templateCells[1] },
-						{ templateCells[2]->GetTemplateName(),
-						  templateCells[2] },
-						{ templateCells[3]->GetTemplateName(),
-						  templateCells[3] } };
+      auto const templates = std::make_shared<TemplateCellContainer const>(
+	TemplateCellContainer { { templateCells[0]->GetTemplateName(), templateCells[0] },
+				{ templateCells[1]->GetTemplateName(), templateCells[1] },
+				{ templateCells[2]->GetTemplateName(), templateCells[2] },
+				{ templateCells[3]->GetTemplateName(), templateCells[3] } });
 
       auto const centerOnLine = [=](proc_t i, proc_t j, double alpha) {
 	auto const a = GetCenter(i), b = GetCenter(j);
@@ -691,13 +690,13 @@ namespace hemelb::tests
       }
       auto const dist = GetNodeDistribution(owned);
 
-      ExchangeCells xc(graph);
+      ExchangeCells xc(graph, templates);
       auto const ownership = std::bind(&CellParallelizationTests::Ownership,
 				       *this,
 				       std::placeholders::_1);
       xc.PostCellMessageLength(dist, owned, ownership);
-      xc.PostCells(dist, owned, ownership);
-      auto const result = xc.ReceiveCells(templates);
+      xc.PostCells();
+      auto const result = xc.ReceiveCells();
       xc.Update(owned, result);
 
       switch (graph.Rank())
@@ -728,6 +727,66 @@ namespace hemelb::tests
         }
     }
 
+    void CellParallelizationTests::testLentCellDeltas()
+    {
+      if (not graph)
+        {
+          return;
+        }
+
+      auto const templateCell = GivenCell(0);
+      auto const templates = std::make_shared<TemplateCellContainer const>(
+	TemplateCellContainer { { templateCell->GetTemplateName(), templateCell } });
+
+      // cell owned by 1, with some of its nodes lent to 0
+      std::shared_ptr<CellBase> const cell = templateCell->clone();
+      *cell += (GetCenter(0) + GetCenter(1)) * 0.5 - cell->GetBarycenter();
+      boost::uuids::uuid tag;
+      std::fill(tag.begin(), tag.end(), static_cast<unsigned char>(1));
+      cell->SetTag(tag);
+
+      auto owned = graph.Rank() == 1 ?
+	CellContainer { cell } :
+      CellContainer { };
+      ExchangeCells xc(graph, templates);
+      auto keepOwnership = [this](CellContainer::const_reference) {
+	return graph.Rank();
+      };
+      auto const neighbors = graph.GetNeighbors();
+      auto const toZero = std::find(neighbors.begin(), neighbors.end(), 0) - neighbors.begin();
+
+      // First exchange sends full positions, second one sends displacements only
+      std::vector<size_t> lengths;
+      for (int step(0); step < 2; ++step)
+        {
+          if (step == 1)
+            {
+              *cell += LatticePosition(1e-4, -2e-4, 3e-4);
+            }
+          auto const dist = GetNodeDistribution(owned);
+          xc.PostCellMessageLength(dist, owned, keepOwnership);
+          if (graph.Rank() == 1)
+            {
+              lengths.push_back(xc.GetMessageLengths().GetSendBuffer()[toZero]);
+            }
+          xc.PostCells();
+          auto const result = xc.ReceiveCells();
+          if (graph.Rank() == 0)
+            {
+              REQUIRE(size_t(1) == std::get<2>(result).size());
+              CompareDistributions(cell, *std::get<2>(result).find(1)->second.begin());
+            }
+        }
+
+      if (graph.Rank() == 1)
+        {
+          auto const nLent = GetNodeDistribution(owned).find(tag)->second.CountNodes(0);
+          REQUIRE(nLent > 0);
+          REQUIRE(ExchangeCells::MessageSize(1, nLent) == lengths[0]);
+          REQUIRE(ExchangeCells::MessageSize(1, nLent, 12) == lengths[1]);
+        }
+    }
+
     void CellParallelizationTests::CompareCells(CellContainer::value_type expected,
 						CellContainer::value_type actual) const
     {
@@ -813,5 +872,8 @@ namespace hemelb::tests
     METHOD_AS_TEST_CASE(CellParallelizationTests::testMotherOfAll,
 			"[redblood]" "Several cells to and from several processors",
 			"[redblood]");
+    METHOD_AS_TEST_CASE(CellParallelizationTests::testLentCellDeltas,
+			"Lent cells are sent as displacements once the receiver knows them",
+			"[redblood]");
 
 }
@@ -130,8 +130,8 @@ namespace hemelb::tests
 
       // Goes through "ExchangeCells" to figure out who owns/lends what.
       // Ownership is pre-determined here: first nCells got to 0, second nCells to 2, etc...
-      TemplateCellContainer const templates =
-	{ { cells[0]->GetTemplateName(), cells[0]->clone() } };
+      auto const templates = std::make_shared<TemplateCellContainer const>(
+	TemplateCellContainer { { cells[0]->GetTemplateName(), cells[0]->clone() } });
       auto ownership = [&cells, nCells](CellContainer::const_reference cell) {
 	size_t i(0);
 	for(auto const& c: cells) {
@@ -143,10 +143,10 @@ namespace hemelb::tests
 	proc_t result = i / nCells;
 	return result;
       };
-      hemelb::redblood::parallel::ExchangeCells xchange(graphComm);
+      hemelb::redblood::parallel::ExchangeCells xchange(graphComm, templates);
       xchange.PostCellMessageLength(distributions, owned, ownership);
-      xchange.PostCells(distributions, owned, ownership);
-      auto const distCells = xchange.ReceiveCells(templates);
+      xchange.PostCells();
+      auto const distCells = xchange.ReceiveCells();
       auto const &lentCells = std::get<2>(distCells);
 
       // Actually perform velocity integration
@@ -5,6 +5,7 @@
 
 import os.path
 import xdrlib
+import zlib
 import numpy as np
 
 from . import HemeLbMagicNumber
@@ -12,6 +13,13 @@ from . import HemeLbMagicNumber
 ExtractionMagicNumber = 0x78747204
 MainHeaderLength = 60
 TimeStepDataLength = 8
+CompressedVersionNumber = 6
+SiteHeaderLength = 16
+RecordHeaderLength = 16
+CodecDeflate = 1
+CodecLossy = 2
+# Stored by the lossy codec for values it cannot quantise
+LossyNotANumber = -(2**63)
 
 
 class FieldSpec:
@@ -188,7 +196,7 @@ class ExtractedPropertyV5Parser:
 class ExtractedProperty:
     """Represent the contents of a HemeLB property extraction file."""
 
-    HandledVersions = {4, 5}
+    HandledVersions = {4, 5, CompressedVersionNumber}
 
     def __init__(self, filename):
         """Read the file's headers and determine how many times and which times
@@ -200,7 +208,11 @@ class ExtractedProperty:
 
         self._ReadMainHeader()
         self._ReadFieldHeader()
-        self._DetermineTimes()
+        if self.compressed:
+            self._ReadSites()
+            self._DetermineCompressedTimes()
+        else:
+            self._DetermineTimes()
 
         # At this point, we can close the file. All external access uses memory maps.
         self._file.close()
@@ -237,9 +249,11 @@ class ExtractedProperty:
         self.fieldCount = decoder.unpack_uint()
         self._fieldHeaderLength = decoder.unpack_uint()
 
+        self.compressed = version == CompressedVersionNumber
         if version == 4:
             self.parser = ExtractedPropertyV4Parser(self.fieldCount, self.siteCount)
-        elif version == 5:
+        else:
+            # Compressed files have the same field headers as version 5
             self.parser = ExtractedPropertyV5Parser(self.fieldCount, self.siteCount)
         return
 
@@ -296,6 +310,103 @@ class ExtractedProperty:
 
         return
 
+    def _ReadSites(self):
+        """Read the site section of a compressed file, which holds the
+        coordinates of the sites in every chunk.
+        """
+        self._totalHeaderLength = MainHeaderLength + self._fieldHeaderLength
+        self._file.seek(self._totalHeaderLength)
+        decoder = xdrlib.Unpacker(self._file.read(SiteHeaderLength))
+        self._chunkCount = decoder.unpack_uint()
+        self.codec = decoder.unpack_uint()
+        assert self.codec in (
+            CodecDeflate,
+            CodecLossy,
+        ), "Unknown codec in extraction file '{}'".format(self.filename)
+        self.tolerance = decoder.unpack_double()
+
+        decoder = xdrlib.Unpacker(self._file.read(16 * self._chunkCount))
+        self._chunkSiteCounts = [
+            decoder.unpack_uhyper() for i in range(self._chunkCount)
+        ]
+        coordLengths = [decoder.unpack_uhyper() for i in range(self._chunkCount)]
+        assert (
+            sum(self._chunkSiteCounts) == self.siteCount
+        ), "Site counts of chunks do not add up in extraction file '{}'".format(
+            self.filename
+        )
+
+        grids = []
+        for n, length in zip(self._chunkSiteCounts, coordLengths):
+            coords = np.frombuffer(
+                zlib.decompress(self._file.read(length)), dtype=">u4"
+            )
+            grids.append(coords.reshape(3, n).T)
+        self._grid = np.concatenate(grids) if grids else np.empty((0, 3))
+        self._firstRecord = self._file.tell()
+        return
+
+    def _DetermineCompressedTimes(self):
+        """Walk the variable length records of a compressed file to find
+        their times and positions.
+        """
+        filesize = os.path.getsize(self.filename)
+        prefixLength = RecordHeaderLength + 8 * self._chunkCount
+        times = []
+        self._recordStarts = []
+        pos = self._firstRecord
+        while pos < filesize:
+            self._file.seek(pos)
+            decoder = xdrlib.Unpacker(self._file.read(RecordHeaderLength))
+            times.append(decoder.unpack_uhyper())
+            self._recordStarts.append(pos)
+            pos += prefixLength + decoder.unpack_uhyper()
+            continue
+        assert (
+            pos == filesize
+        ), "Extraction file appears to have a partial record at the end"
+
+        times = np.array(times, dtype=int)
+        assert np.all(
+            np.argsort(times) == np.arange(len(times))
+        ), "Times in extraction file are not monotonically increasing!"
+        self.times = times
+        return
+
+    def _LoadCompressed(self, idx):
+        """Decompress a single timestep of data from every chunk."""
+        with open(self.filename, "rb") as f:
+            f.seek(self._recordStarts[idx] + RecordHeaderLength)
+            decoder = xdrlib.Unpacker(f.read(8 * self._chunkCount))
+            lengths = [decoder.unpack_uhyper() for i in range(self._chunkCount)]
+            chunks = [zlib.decompress(f.read(length)) for length in lengths]
+
+        answer = np.recarray(self.siteCount, dtype=self._fieldSpec.GetMem())
+        answer.grid = self._grid
+        # Skip the grid, which is not stored with the fields
+        fields = list(zip(self._fieldSpec, self.parser._dataOffset))[1:]
+        siteStart = 0
+        for chunk, n in zip(chunks, self._chunkSiteCounts):
+            # Each chunk stores one column per element of each field
+            pos = 0
+            for (name, xdrType, memType, length, offset), dataOffset in fields:
+                nElem = int(np.prod(length))
+                lossy = self.codec == CodecLossy and np.dtype(xdrType).kind == "f"
+                fileType = np.dtype(">i8" if lossy else xdrType)
+                data = np.frombuffer(chunk, dtype=fileType, count=n * nElem, offset=pos)
+                pos += fileType.itemsize * n * nElem
+                data = data.reshape(nElem, n).T.reshape((n,) + length)
+                if lossy:
+                    data = np.where(
+                        data == LossyNotANumber, np.nan, data * (2.0 * self.tolerance)
+                    )
+                memdata = getattr(answer, name)[siteStart : siteStart + n]
+                memdata[:] = data
+                if dataOffset is not None:
+                    memdata += dataOffset
+            siteStart += n
+        return answer
+
     def GetByIndex(self, idx):
         """Get the fields by time index."""
         # Attempt to look up the index in the times array to catch any
@@ -339,9 +450,10 @@ class ExtractedProperty:
 
         Fields are as specified in the file with the addition of
         """
-        mapped = self._MemMap(idx)
-
-        answer = self.parser.parse(mapped)
+        if self.compressed:
+            answer = self._LoadCompressed(idx)
+        else:
+            answer = self.parser.parse(self._MemMap(idx))
 
         answer.id = np.arange(self.siteCount)
         answer.position = self.voxelSizeMetres * answer.grid + self.originMetres
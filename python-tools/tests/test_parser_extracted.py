@@ -47,3 +47,106 @@ def test_load_xtr(diffTestDir):
     # shearstress is scalar C float
     assert data.shearstress.dtype == np.float32
     assert data.shearstress.shape == (N,)
+
+
+def _write_compressed(path, tolerance, grid, pressure, velocity, times):
+    """Write a compressed (version 6) extraction file with a single
+    float pressure field, offset by 8, and a float velocity field, as
+    two chunks.
+    """
+    import xdrlib
+    import zlib
+
+    from hlb.parsers import HemeLbMagicNumber
+    from hlb.parsers.extraction import (
+        CodecDeflate,
+        CodecLossy,
+        CompressedVersionNumber,
+        ExtractionMagicNumber,
+        LossyNotANumber,
+    )
+
+    fields = xdrlib.Packer()
+    for name, length, n_offsets in (("pressure", 1, 1), ("velocity", 3, 0)):
+        fields.pack_string(name.encode("ascii"))
+        fields.pack_uint(length)
+        fields.pack_uint(0)
+        fields.pack_uint(n_offsets)
+        if n_offsets:
+            fields.pack_float(8.0)
+    fields = fields.get_buffer()
+
+    N = len(grid)
+    header = xdrlib.Packer()
+    header.pack_uint(HemeLbMagicNumber)
+    header.pack_uint(ExtractionMagicNumber)
+    header.pack_uint(CompressedVersionNumber)
+    header.pack_double(1e-4)
+    for x in (0.0, 0.0, 0.0):
+        header.pack_double(x)
+    header.pack_uhyper(N)
+    header.pack_uint(2)
+    header.pack_uint(len(fields))
+
+    chunks = [slice(0, N // 2), slice(N // 2, N)]
+    coords = [zlib.compress(grid[c].T.astype(">u4").tobytes()) for c in chunks]
+    header.pack_uint(len(chunks))
+    header.pack_uint(CodecLossy if tolerance else CodecDeflate)
+    header.pack_double(tolerance)
+    for c in chunks:
+        header.pack_uhyper(c.stop - c.start)
+    for c in coords:
+        header.pack_uhyper(len(c))
+
+    with open(path, "wb") as f:
+        f.write(header.get_buffer()[:60])
+        f.write(fields)
+        f.write(header.get_buffer()[60:])
+        for c in coords:
+            f.write(c)
+        for t in times:
+            columns = np.concatenate(
+                [(pressure[t] - 8.0)[:, np.newaxis], velocity[t]], axis=1
+            )
+            if tolerance:
+                q = np.round(columns / (2 * tolerance))
+                columns = np.where(np.isfinite(q), q, 0).astype(">i8")
+                columns[~np.isfinite(q)] = LossyNotANumber
+            else:
+                columns = columns.astype(">f4")
+            data = [zlib.compress(columns[c].T.tobytes()) for c in chunks]
+            record = xdrlib.Packer()
+            record.pack_uhyper(t)
+            record.pack_uhyper(sum(len(d) for d in data))
+            for d in data:
+                record.pack_uhyper(len(d))
+            f.write(record.get_buffer())
+            for d in data:
+                f.write(d)
+
+
+def test_load_compressed_xtr(tmp_path):
+    N = 10
+    rng = np.random.default_rng(42)
+    grid = rng.integers(0, 100, size=(N, 3))
+    times = [0, 100]
+    pressure = {t: rng.uniform(0, 16, N) for t in times}
+    velocity = {t: rng.uniform(-1, 1, (N, 3)) for t in times}
+    # As from a diverged run
+    pressure[100][3] = np.nan
+
+    for tolerance in (0.0, 1e-3):
+        path = str(tmp_path / "compressed.xtr")
+        _write_compressed(path, tolerance, grid, pressure, velocity, times)
+
+        exp = ExtractedProperty(path)
+        assert exp.siteCount == N
+        assert np.all(exp.times == times)
+        margin = max(tolerance, 1e-5)
+        for t in times:
+            data = exp.GetByTimeStep(t)
+            assert np.all(data.grid == grid)
+            assert np.all(data.id == np.arange(N))
+            assert np.allclose(data.position, 1e-4 * grid)
+            assert np.allclose(data.pressure, pressure[t], atol=margin, equal_nan=True)
+            assert np.allclose(data.velocity, velocity[t], atol=margin)